@@ -0,0 +1,32 @@
+#include "BenchData.h"
+#include "PointTargetFixture.h"
+#include <random>
+
+namespace opensaft {
+
+UltrasoundSignals CreatePointTarget(const std::size_t nX, const std::size_t nY,
+                                    const std::size_t nT,
+                                    const ReconSettings& sett,
+                                    const Transducer& trans) {
+  PointTargetFixture fixture;
+  fixture.nX = nX;
+  fixture.nY = nY;
+  fixture.nT = nT;
+  fixture.settings = sett;
+  fixture.transducer = trans;
+  // small noise so that preprocessing and kernels see realistic values
+  fixture.noise = 0.05f;
+  fixture.AddTarget({nX / 2, nY / 2, nT * 3 / 5});
+  return fixture.Simulate();
+}
+
+Volume CreateNoiseVolume(const Size3& dims) {
+  std::mt19937 gen(2);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  Volume vol(dims);
+  for (float& voxel : vol)
+    voxel = dist(gen);
+  return vol;
+}
+
+} // namespace opensaft
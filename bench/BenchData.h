@@ -0,0 +1,22 @@
+#include "Memory/UltrasoundSignals.h"
+#include "Memory/Volume.h"
+#include "ReconSettings.h"
+#include "Transducer.h"
+#include <cstddef>
+
+#pragma once
+
+namespace opensaft {
+
+/// \returns a raster of nX * nY A-scans holding the hyperbola of a single
+/// point absorber below its center, sampled like a typical acquisition
+[[nodiscard]] UltrasoundSignals CreatePointTarget(const std::size_t nX,
+                                                  const std::size_t nY,
+                                                  const std::size_t nT,
+                                                  const ReconSettings& sett,
+                                                  const Transducer& trans);
+
+/// \returns a volume filled with reproducible noise in [-1, 1]
+[[nodiscard]] Volume CreateNoiseVolume(const Size3& dims);
+
+} // namespace opensaft
@@ -0,0 +1,23 @@
+#include "Recon/SimdKernel.h"
+#include "Util/Logger.h"
+#include <benchmark/benchmark.h>
+#include <thread>
+
+// JSON output for comparisons across releases:
+//   opensaft_bench --benchmark_out=bench.json --benchmark_out_format=json
+int main(int argc, char** argv) {
+  // the reconstruction reports its progress, which would flood the tables
+  opensaft::Logger::SetLevel(opensaft::LogLevel::Warning);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  benchmark::AddCustomContext("opensaft_version", OPENSAFT_VERSION);
+  benchmark::AddCustomContext("simd_level",
+                              ToString(opensaft::DetectSimdLevel()));
+  benchmark::AddCustomContext(
+      "hardware_threads", std::to_string(std::thread::hardware_concurrency()));
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,275 @@
+#include "BenchData.h"
+#include "Processing/Envelope.h"
+#include "Processing/Preprocessor.h"
+#include "Recon/Accuracy.h"
+#include "Recon/DelayTable.h"
+#include "Recon/SaftGeometry.h"
+#include "Recon/SimdKernel.h"
+#include "Saft.h"
+#include <benchmark/benchmark.h>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+using namespace opensaft;
+
+namespace {
+
+constexpr std::size_t nT = 256;
+
+/// removes the DC offset of every A-scan in place, memory bound
+void BM_RemoveDC(benchmark::State& state) {
+  const auto nXY = static_cast<std::size_t>(state.range(0));
+  UltrasoundSignals sigs =
+      CreatePointTarget(nXY, nXY, 2048, ReconSettings(), Transducer());
+  for (auto _ : state) {
+    for (auto sig : sigs)
+      sig.RemoveDC();
+    benchmark::ClobberMemory();
+  }
+  // every sample is read twice (mean, subtraction) and written once
+  const auto nSamples = static_cast<int64_t>(nXY * nXY * sigs.get_nT());
+  state.SetBytesProcessed(state.iterations() * nSamples * 3 *
+                          static_cast<int64_t>(sizeof(float)));
+  state.counters["samples"] =
+      benchmark::Counter(static_cast<double>(nSamples),
+                         benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_RemoveDC)->Arg(32)->Arg(128);
+
+/// fused crop, DC removal and optional bandpass on all processor units
+void BM_Preprocess(benchmark::State& state) {
+  const auto nXY = static_cast<std::size_t>(state.range(0));
+  ReconSettings sett;
+  const UltrasoundSignals sigs =
+      CreatePointTarget(nXY, nXY, 2048, sett, Transducer());
+  // keep the central half of the A-scans
+  const float tStartMs = sigs.get_properties().t0 * 1e3f;
+  const float durationMs = 2048.0f / sigs.get_properties().sampleRate * 1e3f;
+  sett.set_cropT(tStartMs + 0.25f * durationMs, tStartMs + 0.75f * durationMs);
+  sett.set_flagBandpass(state.range(1) != 0);
+  sett.set_bandpass(5e6f, 40e6f);
+
+  Preprocessor preprocessor;
+  preprocessor.SetSettings(sett);
+  std::size_t nTOut = 0;
+  for (auto _ : state) {
+    const UltrasoundSignals output = preprocessor.Process(sigs);
+    nTOut = output.get_nT();
+    benchmark::DoNotOptimize(output.data());
+  }
+  // cropped samples are read once and written once
+  const auto nSamples = static_cast<int64_t>(nXY * nXY * nTOut);
+  state.SetBytesProcessed(state.iterations() * nSamples * 2 *
+                          static_cast<int64_t>(sizeof(float)));
+  state.counters["samples"] =
+      benchmark::Counter(static_cast<double>(nSamples),
+                         benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_Preprocess)
+    ->ArgNames({"nXY", "bandpass"})
+    ->ArgsProduct({{128}, {0, 1}})
+    ->UseRealTime();
+
+/// delay-and-sum of one full A-scan column through the selected instruction
+/// set, the central column has the largest aperture
+void BM_VoxelKernel(benchmark::State& state) {
+  const auto level = static_cast<SimdLevel>(state.range(0));
+  if (level > DetectSimdLevel()) {
+    state.SkipWithError("instruction set not supported by this cpu");
+    return;
+  }
+  const ReconSettings sett;
+  const Transducer trans;
+  const std::size_t nXY = 64;
+  const UltrasoundSignals sigs = CreatePointTarget(nXY, nXY, nT, sett, trans);
+  const SaftGeometry geom = SaftGeometry::Create(sigs, sett, trans);
+  const auto table = DelayTable::Get(geom);
+
+  std::vector<float> column(table->get_nBlocks() * DelayBlockWidth);
+  for (auto _ : state) {
+    for (int iBlock = 0; iBlock < table->get_nBlocks(); iBlock++)
+      CalculateVoxelBlock(level, geom, *table, sigs, nXY / 2, nXY / 2, iBlock,
+                          &column[iBlock * DelayBlockWidth]);
+    benchmark::DoNotOptimize(column.data());
+  }
+  state.SetLabel(ToString(level));
+  state.counters["voxels"] = benchmark::Counter(
+      static_cast<double>(nT), benchmark::Counter::kIsIterationInvariantRate);
+  state.counters["samples"] = benchmark::Counter(
+      static_cast<double>(table->get_nEntries()),
+      benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_VoxelKernel)
+    ->Arg(static_cast<int>(SimdLevel::Scalar))
+    ->Arg(static_cast<int>(SimdLevel::Avx2))
+    ->Arg(static_cast<int>(SimdLevel::Avx512));
+
+/// voxels per second of the single threaded run of each size, reference for
+/// the scaling efficiency of the multi threaded runs
+std::map<int64_t, double> singleThreadRate;
+std::mutex singleThreadMutex;
+
+/// full reconstruction including preprocessing, timed by the reconstruction
+/// itself so that neither the copy of the input nor the wait is measured
+void BM_SaftRecon(benchmark::State& state) {
+  const auto nXY = static_cast<std::size_t>(state.range(0));
+  const auto threadCount = static_cast<unsigned int>(state.range(1));
+  const ReconSettings sett;
+  const Transducer trans;
+  const UltrasoundSignals sigs = CreatePointTarget(nXY, nXY, nT, sett, trans);
+
+  double reconTime = 0.0;
+  for (auto _ : state) {
+    Saft saft;
+    saft.SetSettings(sett);
+    saft.SetTransducer(trans);
+    saft.SetThreadCount(threadCount);
+    saft.SetInput(UltrasoundSignals(sigs));
+    saft.Launch();
+    saft.Wait();
+    state.SetIterationTime(saft.get_reconTime());
+    reconTime += saft.get_reconTime();
+  }
+
+  const double nVoxels = static_cast<double>(nXY * nXY * nT);
+  state.counters["voxels"] = benchmark::Counter(
+      nVoxels, benchmark::Counter::kIsIterationInvariantRate);
+  state.counters["threads"] = threadCount;
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(nVoxels * sizeof(float)));
+
+  const double rate = nVoxels * state.iterations() / reconTime;
+  std::scoped_lock lock(singleThreadMutex);
+  if (threadCount == 1)
+    singleThreadRate[state.range(0)] = rate;
+  if (singleThreadRate.contains(state.range(0)))
+    state.counters["efficiency"] =
+        rate / (singleThreadRate[state.range(0)] * threadCount);
+}
+BENCHMARK(BM_SaftRecon)
+    ->ArgNames({"nXY", "threads"})
+    ->ArgsProduct({{32, 64, 96}, {1, 2, 4, 8}})
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+/// time until the first preview of the progressive mode is published
+/// compared to the full reconstruction
+void BM_ProgressivePreview(benchmark::State& state) {
+  const auto nXY = static_cast<std::size_t>(state.range(0));
+  const auto stride = static_cast<unsigned int>(state.range(1));
+  const ReconSettings sett;
+  const Transducer trans;
+  const UltrasoundSignals sigs = CreatePointTarget(nXY, nXY, nT, sett, trans);
+
+  double previewTime = 0.0;
+  double reconTime = 0.0;
+  for (auto _ : state) {
+    Saft saft;
+    saft.SetSettings(sett);
+    saft.SetTransducer(trans);
+    saft.SetPreviewStride(stride);
+    saft.SetInput(UltrasoundSignals(sigs));
+    saft.Launch();
+    // the first preview is replaced by the next one after a few seconds
+    double tPreview = 0.0;
+    while (saft.get_isRunning() && tPreview == 0.0) {
+      const ReconSnapshot snapshot = saft.GetSnapshot();
+      if (snapshot.stride == stride)
+        tPreview = snapshot.time;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    saft.Wait();
+    state.SetIterationTime(saft.get_reconTime());
+    previewTime += tPreview;
+    reconTime += saft.get_reconTime();
+  }
+
+  state.counters["preview"] = previewTime / state.iterations();
+  state.counters["previewFraction"] = previewTime / reconTime;
+}
+BENCHMARK(BM_ProgressivePreview)
+    ->ArgNames({"nXY", "stride"})
+    ->ArgsProduct({{64, 96}, {4, 8}})
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+/// exact reconstruction and its time per size, reference for the accuracy
+/// and speedup of the separable mode
+std::map<int64_t, std::pair<Volume, double>> exactResults;
+std::mutex exactMutex;
+
+/// exact against approximate engines on all processor units, the
+/// approximations report their deviation from the exact volume
+void BM_SaftMode(benchmark::State& state) {
+  const auto nXY = static_cast<std::size_t>(state.range(0));
+  const auto mode = static_cast<ReconMode>(state.range(1));
+  ReconSettings sett;
+  sett.set_mode(mode);
+  const Transducer trans;
+  const UltrasoundSignals sigs = CreatePointTarget(nXY, nXY, nT, sett, trans);
+
+  double reconTime = 0.0;
+  std::optional<Volume> vol;
+  for (auto _ : state) {
+    Saft saft;
+    saft.SetSettings(sett);
+    saft.SetTransducer(trans);
+    saft.SetInput(UltrasoundSignals(sigs));
+    saft.Launch();
+    saft.Wait();
+    state.SetIterationTime(saft.get_reconTime());
+    reconTime += saft.get_reconTime();
+    vol.emplace(saft.TakeVolume().value());
+  }
+  reconTime /= static_cast<double>(state.iterations());
+
+  constexpr const char* modeNames[] = {"exact", "separable", "f-k"};
+  state.SetLabel(modeNames[state.range(1)]);
+  state.counters["voxels"] =
+      benchmark::Counter(static_cast<double>(nXY * nXY * nT),
+                         benchmark::Counter::kIsIterationInvariantRate);
+
+  std::scoped_lock lock(exactMutex);
+  if (mode == ReconMode::Exact) {
+    exactResults.erase(state.range(0));
+    exactResults.emplace(state.range(0), std::make_pair(*vol, reconTime));
+  } else if (exactResults.contains(state.range(0))) {
+    const auto& [exact, exactTime] = exactResults.at(state.range(0));
+    AccuracyReport report;
+    if (mode == ReconMode::FrequencyDomain) {
+      // f-k migration applies no coherence factor and shapes the pulse
+      // differently, so its envelope is compared to the envelope of an exact
+      // reconstruction without coherence factor
+      ReconSettings exactSett;
+      exactSett.set_flagCoherenceW(false);
+      Saft saft;
+      saft.SetSettings(exactSett);
+      saft.SetTransducer(trans);
+      saft.SetInput(UltrasoundSignals(sigs));
+      saft.Run();
+      Volume envExact = saft.TakeVolume().value();
+      CalculateEnvelope(envExact);
+      CalculateEnvelope(*vol);
+      report = CompareVolumes(envExact, *vol);
+    } else {
+      report = CompareVolumes(exact, *vol);
+    }
+    state.counters["speedup"] = exactTime / reconTime;
+    state.counters["correlation"] = report.correlation;
+    state.counters["rmsError"] = report.rmsError;
+    state.counters["peakRatio"] = report.peakRatio;
+    state.counters["peakShift"] = report.peakShift;
+  }
+}
+BENCHMARK(BM_SaftMode)
+    ->ArgNames({"nXY", "mode"})
+    ->ArgsProduct({{64, 128},
+                   {static_cast<int>(ReconMode::Exact),
+                    static_cast<int>(ReconMode::Separable),
+                    static_cast<int>(ReconMode::FrequencyDomain)}})
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
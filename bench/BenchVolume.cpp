@@ -0,0 +1,151 @@
+#include "BenchData.h"
+#include "Processing/Envelope.h"
+#include "Slicer/ColorMapper.h"
+#include "Slicer/Slicer.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace opensaft;
+
+namespace {
+
+/// serial min_element and max_element passes, the baseline of BM_VolumeStats
+void BM_VolumeMinMax(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  const Volume vol = CreateNoiseVolume({n, n, n});
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(*std::min_element(vol.begin(), vol.end()));
+    benchmark::DoNotOptimize(*std::max_element(vol.begin(), vol.end()));
+  }
+  // both passes read the full volume
+  state.SetBytesProcessed(state.iterations() * 2 *
+                          static_cast<int64_t>(vol.size() * sizeof(float)));
+  state.counters["voxels"] =
+      benchmark::Counter(static_cast<double>(vol.size()),
+                         benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_VolumeMinMax)->Arg(64)->Arg(256);
+
+/// uncached statistics of an n^3 volume, second argument: histogram bins
+void BM_VolumeStats(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  const auto nBins = static_cast<std::size_t>(state.range(1));
+  const Volume vol = CreateNoiseVolume({n, n, n});
+  for (auto _ : state)
+    benchmark::DoNotOptimize(CalculateStats(vol, nBins));
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(vol.size() * sizeof(float)));
+  state.counters["voxels"] =
+      benchmark::Counter(static_cast<double>(vol.size()),
+                         benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_VolumeStats)->ArgsProduct({{64, 256}, {0, 256}})->UseRealTime();
+
+/// moves the z crop range of an n^3 volume by one voxel per iteration like a
+/// crop slider, argument 1 selects the incremental update, 0 a rescan of the
+/// voxels within the crop range
+void BM_CroppedMips(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  const bool isIncremental = state.range(1) != 0;
+  Volume vol = CreateNoiseVolume({n, n, n});
+  vol.calcMips();
+  // the rescan only projects along z, like the incremental update after a
+  // change of the z range, and leaves the full projections alone
+  VolumeMips mips(vol.get_dims());
+  std::vector<float> image;
+  std::size_t zStart = 0;
+  for (auto _ : state) {
+    zStart = (zStart + 1) % (n / 2);
+    const Size3 start{0ul, 0ul, zStart};
+    const Size3 stop{n, n, zStart + n / 2};
+    if (isIncremental) {
+      vol.set_cropRange(start, stop);
+      vol.calcCroppedMips();
+      benchmark::DoNotOptimize(vol.get_croppedMipZ().data());
+    } else {
+      mips.SetCropRange(start, stop);
+      mips.ScanCropped(std::as_const(vol), 2, image);
+      benchmark::DoNotOptimize(image.data());
+    }
+  }
+  state.SetLabel(isIncremental ? "incremental" : "rescan");
+}
+BENCHMARK(BM_CroppedMips)->ArgsProduct({{128, 256}, {0, 1}})->UseRealTime();
+
+/// scrolls through all slices of a 256^3 volume normal to the dimension of
+/// the first argument, the second selects the Slicer (1) or a plain strided
+/// copy into a new image per slice (0)
+void BM_SliceScroll(benchmark::State& state) {
+  const auto dim = static_cast<Dimension>(state.range(0));
+  const bool isSlicer = state.range(1) != 0;
+  const Volume vol = CreateNoiseVolume({256ul, 256ul, 256ul});
+  Slicer slicer(vol);
+  for (auto _ : state) {
+    for (std::size_t index = 0; index < 256; index++) {
+      if (isSlicer) {
+        benchmark::DoNotOptimize(slicer.GetSlice(dim, index).data);
+        continue;
+      }
+      const SliceView view = slicer.GetStridedSlice(dim, index);
+      std::vector<float> image(view.size());
+      for (std::size_t iRow = 0; iRow < view.nRows; iRow++)
+        for (std::size_t iCol = 0; iCol < view.nCols; iCol++)
+          image[iCol + view.nCols * iRow] = view(iCol, iRow);
+      benchmark::DoNotOptimize(image.data());
+    }
+    slicer.Invalidate();
+  }
+  state.SetLabel(isSlicer ? "slicer" : "strided copy");
+  state.counters["slices"] = benchmark::Counter(
+      256.0, benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_SliceScroll)
+    ->ArgsProduct({{0, 1, 2}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+/// hilbert envelope along z of an n x n x 512 volume on all processor units
+void BM_Envelope(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  const Volume source = CreateNoiseVolume({n, n, 512ul});
+  Volume vol = source;
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::copy(source.begin(), source.end(), vol.begin());
+    state.ResumeTiming();
+    CalculateEnvelope(vol);
+    benchmark::DoNotOptimize(vol.data());
+  }
+  state.SetBytesProcessed(state.iterations() * 2 *
+                          static_cast<int64_t>(vol.size() * sizeof(float)));
+  state.counters["voxels"] =
+      benchmark::Counter(static_cast<double>(vol.size()),
+                         benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_Envelope)->Arg(64)->Arg(128)->UseRealTime();
+
+/// RGBA conversion of a 1024^2 slice, argument: ColorMapType
+void BM_ColorMapper(benchmark::State& state) {
+  const Volume slice = CreateNoiseVolume({1024ul, 1024ul, 1ul});
+  ColorMapper mapper;
+  const auto mapType = static_cast<ColorMapType>(state.range(0));
+  mapper.set_mapType(mapType);
+  std::vector<unsigned char> rgba(slice.size() * 4);
+  for (auto _ : state) {
+    mapper.convert_to_map(slice.data(), slice.size(), rgba.data());
+    benchmark::DoNotOptimize(rgba.data());
+  }
+  const char* labels[] = {"linear", "diverging", "viridis"};
+  state.SetLabel(labels[state.range(0)]);
+  state.SetBytesProcessed(
+      state.iterations() *
+      static_cast<int64_t>(slice.size() * (sizeof(float) + 4)));
+  state.counters["voxels"] =
+      benchmark::Counter(static_cast<double>(slice.size()),
+                         benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_ColorMapper)->Arg(0)->Arg(1)->Arg(2);
+
+} // namespace
@@ -0,0 +1,169 @@
+#include "CliOptions.h"
+#include "Memory/BrickVolumeFile.h"
+#include "Memory/UltrasoundSignals.h"
+#include "Processing/Preprocessor.h"
+#include "Saft.h"
+#include "StreamingSaft.h"
+#include "Util/Logger.h"
+#include "Util/Profiler.h"
+#include "Util/Timer.h"
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace opensaft;
+
+namespace {
+
+struct CliStats {
+  double loadTime = 0.0;  //!< [s]
+  double reconTime = 0.0; //!< [s]
+  double writeTime = 0.0; //!< [s]
+  std::size_t nSamples = 0;
+  std::size_t nVoxels = 0;
+};
+
+void WriteVolume(const CliOptions& options, const Volume& vol) {
+  if (options.format == VolumeFileFormat::Raw) {
+    vol.WriteToFile(options.outputPath);
+    return;
+  }
+  BrickVolumeWriter writer(options.outputPath, vol.get_dims(), vol.get_res(),
+                           vol.get_center(), options.brickSize);
+  writer.WriteSlab(vol, 0, options.threadCount);
+  writer.Finalize();
+}
+
+/// reconstructs in memory, the write time is measured separately
+void RunInMemory(const CliOptions& options, UltrasoundSignals&& signals,
+                 CliStats& stats) {
+  // a single run needs no raw copy next to the preprocessed input
+  Timer reconTimer;
+  Preprocessor preprocessor;
+  preprocessor.SetSettings(options.settings);
+  preprocessor.SetThreadCount(options.threadCount);
+  preprocessor.Process(signals);
+
+  Saft saft;
+  saft.SetPreprocessedInput(std::move(signals));
+  saft.SetSettings(options.settings);
+  saft.SetTransducer(options.transducer);
+  saft.SetThreadCount(options.threadCount);
+  if (options.simdLevel)
+    saft.SetSimdLevel(*options.simdLevel);
+  if (options.region)
+    saft.SetRegion(options.region->first, options.region->second);
+  saft.Run();
+  reconTimer.Stop();
+  stats.reconTime = reconTimer.GetElapsedTime();
+
+  auto vol = saft.TakeVolume();
+  if (!vol)
+    throw std::runtime_error("reconstruction did not produce a volume");
+  stats.nVoxels = vol->size();
+
+  Timer writeTimer;
+  WriteVolume(options, *vol);
+  writeTimer.Stop();
+  stats.writeTime = writeTimer.GetElapsedTime();
+}
+
+/// reconstructs slab by slab, writing is interleaved with the reconstruction
+void RunStreaming(const CliOptions& options, const UltrasoundSignals& signals,
+                  CliStats& stats) {
+  if (options.region)
+    throw std::invalid_argument("--region is not supported with a memory "
+                                "budget");
+  StreamingSaft saft;
+  saft.SetSettings(options.settings);
+  saft.SetTransducer(options.transducer);
+  saft.SetThreadCount(options.threadCount);
+  if (options.simdLevel)
+    saft.SetSimdLevel(*options.simdLevel);
+  saft.SetMemoryBudget(options.memoryBudget);
+  saft.SetOutputFormat(options.format, options.brickSize);
+
+  Timer runTimer;
+  saft.Run(signals, options.outputPath);
+  runTimer.Stop();
+  stats.reconTime = saft.get_reconTime();
+  stats.writeTime = std::max(runTimer.GetElapsedTime() - stats.reconTime, 0.0);
+  const Size3 dims = saft.get_outputDims();
+  stats.nVoxels = dims[0] * dims[1] * dims[2];
+}
+
+void PrintStats(const CliStats& stats) {
+  const double totalTime = stats.loadTime + stats.reconTime + stats.writeTime;
+  std::printf("load   %9.3f s\n", stats.loadTime);
+  std::printf("recon  %9.3f s  %8.2f Mvoxel/s  %8.3f GB/s input\n",
+              stats.reconTime, stats.nVoxels / stats.reconTime * 1e-6,
+              stats.nSamples * sizeof(float) / stats.reconTime * 1e-9);
+  std::printf("write  %9.3f s\n", stats.writeTime);
+  std::printf("total  %9.3f s  %zu voxels from %zu samples\n", totalTime,
+              stats.nVoxels, stats.nSamples);
+}
+
+/// the spread between the threads reveals load imbalance
+void PrintZoneStats() {
+  std::printf("\n%-16s %9s %11s %9s %9s\n", "zone", "count", "total [s]",
+              "min [s]", "max [s]");
+  for (const ProfileZoneStats& zone : Profiler::GetZoneStats())
+    std::printf("%-16s %9zu %11.3f %9.3f %9.3f  (%zu threads)\n",
+                zone.name.c_str(), zone.count, zone.totalTime,
+                zone.minThreadTime, zone.maxThreadTime, zone.nThreads);
+  if (const std::size_t nDropped = Profiler::get_nDropped(); nDropped > 0)
+    std::printf("%zu events did not fit into the trace\n", nDropped);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  CliOptions options;
+  try {
+    options = ParseCliOptions(std::vector<std::string>(argv + 1, argv + argc));
+  } catch (const std::exception& error) {
+    std::fprintf(stderr, "opensaft-cli: %s\n\n%s", error.what(),
+                 GetCliUsage().c_str());
+    return 2;
+  }
+  if (options.showHelp) {
+    std::printf("opensaft-cli %s\n\n%s", OPENSAFT_VERSION,
+                GetCliUsage().c_str());
+    return 0;
+  }
+  if (options.isQuiet)
+    Logger::SetLevel(LogLevel::Warning);
+  // worker threads must not wait for the console
+  Logger::SetAsync(true);
+
+  if (!options.tracePath.empty())
+    Profiler::Enable(true);
+
+  try {
+    CliStats stats;
+    Timer loadTimer;
+    auto signals = UltrasoundSignals::ReadFromFile(options.inputPath);
+    loadTimer.Stop();
+    stats.loadTime = loadTimer.GetElapsedTime();
+    stats.nSamples = signals.get_nX() * signals.get_nY() * signals.get_nT();
+
+    if (options.memoryBudget > 0)
+      RunStreaming(options, signals, stats);
+    else
+      RunInMemory(options, std::move(signals), stats);
+    Logger::Flush();
+    PrintStats(stats);
+    if (!options.tracePath.empty()) {
+      PrintZoneStats();
+      Profiler::WriteChromeTrace(options.tracePath);
+    }
+  } catch (const std::exception& error) {
+    Logger::Flush();
+    std::fprintf(stderr, "opensaft-cli: %s\n", error.what());
+    return 1;
+  }
+  return 0;
+}
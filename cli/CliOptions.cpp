@@ -0,0 +1,261 @@
+#include "CliOptions.h"
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+namespace opensaft {
+
+namespace {
+
+/// flags which do not take a value and the value they stand for
+constexpr std::pair<const char*, const char*> switches[] = {
+    {"no-coherence", "coherence=false"},
+    {"pulse-echo", "pulse-echo=true"},
+    {"quiet", "quiet=true"},
+    {"help", "help=true"},
+};
+
+std::string Trim(const std::string& text) {
+  const auto first = text.find_first_not_of(" \t\r");
+  if (first == std::string::npos)
+    return "";
+  const auto last = text.find_last_not_of(" \t\r");
+  return text.substr(first, last - first + 1);
+}
+
+[[noreturn]] void ThrowInvalidValue(const std::string& key,
+                                    const std::string& value) {
+  throw std::invalid_argument(
+      std::format("invalid value '{}' for {}", value, key));
+}
+
+double ParseNumber(const std::string& key, const std::string& value) {
+  std::size_t nParsed = 0;
+  double number = 0.0;
+  try {
+    number = std::stod(value, &nParsed);
+  } catch (const std::exception&) {
+    ThrowInvalidValue(key, value);
+  }
+  if (nParsed != value.size())
+    ThrowInvalidValue(key, value);
+  return number;
+}
+
+std::size_t ParseCount(const std::string& key, const std::string& value) {
+  const double number = ParseNumber(key, value);
+  if (number < 0.0 || number != static_cast<double>(
+                                    static_cast<std::size_t>(number)))
+    ThrowInvalidValue(key, value);
+  return static_cast<std::size_t>(number);
+}
+
+bool ParseBool(const std::string& key, const std::string& value) {
+  if (value == "true" || value == "1" || value == "on")
+    return true;
+  if (value == "false" || value == "0" || value == "off")
+    return false;
+  ThrowInvalidValue(key, value);
+}
+
+/// parses a comma separated list of exactly n numbers
+std::vector<double> ParseList(const std::string& key, const std::string& value,
+                              const std::size_t n) {
+  std::vector<double> numbers;
+  std::size_t first = 0;
+  while (first <= value.size()) {
+    const std::size_t last = std::min(value.find(',', first), value.size());
+    const std::string item = Trim(value.substr(first, last - first));
+    numbers.push_back(ParseNumber(key, item));
+    first = last + 1;
+  }
+  if (numbers.size() != n)
+    ThrowInvalidValue(key, value);
+  return numbers;
+}
+
+} // namespace
+
+void ApplyCliOption(CliOptions& options, const std::string& key,
+                    const std::string& value) {
+  ReconSettings& sett = options.settings;
+  if (key == "input") {
+    options.inputPath = value;
+  } else if (key == "output") {
+    options.outputPath = value;
+  } else if (key == "trace") {
+    options.tracePath = value;
+  } else if (key == "threads") {
+    options.threadCount = static_cast<unsigned int>(ParseCount(key, value));
+  } else if (key == "mode") {
+    if (value == "exact")
+      sett.set_mode(ReconMode::Exact);
+    else if (value == "separable")
+      sett.set_mode(ReconMode::Separable);
+    else if (value == "fk")
+      sett.set_mode(ReconMode::FrequencyDomain);
+    else
+      ThrowInvalidValue(key, value);
+  } else if (key == "simd") {
+    if (value == "scalar")
+      options.simdLevel = SimdLevel::Scalar;
+    else if (value == "avx2")
+      options.simdLevel = SimdLevel::Avx2;
+    else if (value == "avx512")
+      options.simdLevel = SimdLevel::Avx512;
+    else
+      ThrowInvalidValue(key, value);
+  } else if (key == "format") {
+    if (value == "raw")
+      options.format = VolumeFileFormat::Raw;
+    else if (value == "bricked")
+      options.format = VolumeFileFormat::Bricked;
+    else
+      ThrowInvalidValue(key, value);
+  } else if (key == "brick-size") {
+    options.brickSize = ParseCount(key, value);
+  } else if (key == "memory-budget") {
+    options.memoryBudget =
+        static_cast<std::size_t>(ParseNumber(key, value) * 1024.0 * 1024.0);
+  } else if (key == "region") {
+    const auto numbers = ParseList(key, value, 6);
+    std::pair<Size3, Size3> region;
+    for (uint8_t iDim = 0; iDim < 3; iDim++) {
+      region.first[iDim] = ParseCount(key, std::format("{}", numbers[iDim]));
+      region.second[iDim] =
+          ParseCount(key, std::format("{}", numbers[iDim + 3]));
+      if (region.first[iDim] >= region.second[iDim])
+        ThrowInvalidValue(key, value);
+    }
+    options.region = region;
+  } else if (key == "sos") {
+    sett.set_sos(static_cast<float>(ParseNumber(key, value)));
+  } else if (key == "coherence") {
+    sett.set_flagCoherenceW(ParseBool(key, value));
+  } else if (key == "pulse-echo") {
+    sett.set_flagUs(ParseBool(key, value));
+  } else if (key == "r-min") {
+    sett.set_rMin(static_cast<float>(ParseNumber(key, value)));
+  } else if (key == "crop-t") {
+    const auto numbers = ParseList(key, value, 2);
+    sett.set_cropT(static_cast<float>(numbers[0]),
+                   static_cast<float>(numbers[1]));
+  } else if (key == "bandpass") {
+    const auto numbers = ParseList(key, value, 2);
+    sett.set_flagBandpass(true);
+    sett.set_bandpass(static_cast<float>(numbers[0]),
+                      static_cast<float>(numbers[1]));
+  } else if (key == "focal-distance") {
+    options.transducer.set_focalDistance(
+        static_cast<float>(ParseNumber(key, value)));
+  } else if (key == "aperture") {
+    options.transducer.set_rAperture(
+        static_cast<float>(ParseNumber(key, value)));
+  } else if (key == "hole") {
+    options.transducer.set_rHole(static_cast<float>(ParseNumber(key, value)));
+  } else if (key == "quiet") {
+    options.isQuiet = ParseBool(key, value);
+  } else if (key == "help") {
+    options.showHelp = ParseBool(key, value);
+  } else {
+    throw std::invalid_argument(std::format("unknown option '{}'", key));
+  }
+}
+
+void ApplyCliConfigFile(CliOptions& options, const std::string& filePath) {
+  std::ifstream file(filePath);
+  if (!file)
+    throw std::invalid_argument(
+        std::format("cannot open config file '{}'", filePath));
+
+  std::string line;
+  for (std::size_t iLine = 1; std::getline(file, line); iLine++) {
+    line = Trim(line);
+    if (line.empty() || line.front() == '#')
+      continue;
+    const auto separator = line.find('=');
+    if (separator == std::string::npos)
+      throw std::invalid_argument(std::format(
+          "{}:{}: expected 'key = value'", filePath, iLine));
+    ApplyCliOption(options, Trim(line.substr(0, separator)),
+                   Trim(line.substr(separator + 1)));
+  }
+}
+
+CliOptions ParseCliOptions(const std::vector<std::string>& args) {
+  // --key value and --key=value, switches expand to their key and value
+  std::vector<std::pair<std::string, std::string>> flags;
+  for (std::size_t iArg = 0; iArg < args.size(); iArg++) {
+    const std::string& arg = args[iArg];
+    if (!arg.starts_with("--"))
+      throw std::invalid_argument(std::format("unexpected argument '{}'", arg));
+
+    std::string key = arg.substr(2);
+    const auto isSwitch = [&key](const auto& entry) {
+      return key == entry.first;
+    };
+    if (const auto it = std::find_if(std::begin(switches), std::end(switches),
+                                     isSwitch);
+        it != std::end(switches)) {
+      const std::string expanded = it->second;
+      const auto separator = expanded.find('=');
+      flags.emplace_back(expanded.substr(0, separator),
+                         expanded.substr(separator + 1));
+    } else if (const auto separator = key.find('=');
+               separator != std::string::npos) {
+      flags.emplace_back(key.substr(0, separator), key.substr(separator + 1));
+    } else if (iArg + 1 < args.size()) {
+      flags.emplace_back(key, args[++iArg]);
+    } else {
+      throw std::invalid_argument(std::format("missing value for --{}", key));
+    }
+  }
+
+  CliOptions options;
+  for (const auto& [key, value] : flags) {
+    if (key == "config")
+      ApplyCliConfigFile(options, value);
+  }
+  for (const auto& [key, value] : flags) {
+    if (key != "config")
+      ApplyCliOption(options, key, value);
+  }
+
+  if (!options.showHelp &&
+      (options.inputPath.empty() || options.outputPath.empty()))
+    throw std::invalid_argument("--input and --output are required");
+  return options;
+}
+
+std::string GetCliUsage() {
+  return R"(usage: opensaft-cli --input FILE --output FILE [options]
+
+  --input FILE           A-scans (raw, or HDF5 if supported)
+  --output FILE          reconstructed volume
+  --config FILE          "key = value" lines using the flag names below,
+                         flags on the command line take precedence
+  --trace FILE           profiles the stages and writes a Chrome trace
+  --threads N            worker threads, 0 uses all processor units (0)
+  --mode MODE            exact, separable or fk (exact)
+  --simd LEVEL           scalar, avx2 or avx512 (best supported)
+  --format FORMAT        raw or bricked output (raw)
+  --brick-size N         edge length of the bricks (64)
+  --memory-budget MB     streams the reconstruction in slabs within MB
+  --region X0,Y0,Z0,X1,Y1,Z1
+                         reconstructs only the voxels [X0, X1) x ...
+  --sos V                speed of sound [m/s] (1495)
+  --no-coherence         disables the coherence factor weighting
+  --pulse-echo           pulse echo instead of optoacoustic delays
+  --r-min V              lateral radius always considered [m] (50e-6)
+  --crop-t MIN,MAX       time window after the excitation [ms]
+  --bandpass MIN,MAX     enables a bandpass with cutoffs [Hz]
+  --focal-distance V     focal distance of the transducer [mm] (7)
+  --aperture V           aperture radius of the transducer [mm] (3.2)
+  --hole V               radius of the central hole [mm] (0.5)
+  --quiet                only reports warnings and errors
+  --help                 shows this text
+)";
+}
+
+} // namespace opensaft
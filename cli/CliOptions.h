@@ -0,0 +1,49 @@
+#include "Recon/SimdKernel.h"
+#include "ReconSettings.h"
+#include "StreamingSaft.h"
+#include "Transducer.h"
+#include "VectorN.h"
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#pragma once
+
+namespace opensaft {
+
+/// everything opensaft-cli needs to run a reconstruction
+struct CliOptions {
+  std::string inputPath;  //!< any format of UltrasoundSignals::ReadFromFile
+  std::string outputPath; //!< reconstructed volume
+  std::string tracePath;  //!< Chrome trace of the stages if not empty
+  ReconSettings settings;
+  Transducer transducer;
+  unsigned int threadCount = 0;         //!< 0 uses all processor units
+  std::optional<SimdLevel> simdLevel;   //!< best supported one if empty
+  std::optional<std::pair<Size3, Size3>> region; //!< voxels [first, second)
+  VolumeFileFormat format = VolumeFileFormat::Raw;
+  std::size_t brickSize = 64;   //!< edge length of bricks of bricked output
+  std::size_t memoryBudget = 0; //!< streams if > 0 [bytes]
+  bool isQuiet = false;         //!< only log warnings and errors
+  bool showHelp = false;
+};
+
+/// sets a single option, key is the long flag without the dashes. Throws
+/// std::invalid_argument for unknown keys and malformed values.
+void ApplyCliOption(CliOptions& options, const std::string& key,
+                    const std::string& value);
+
+/// applies all "key = value" lines of a config file, lines starting with #
+/// are comments
+void ApplyCliConfigFile(CliOptions& options, const std::string& filePath);
+
+/// parses the arguments following the program name. A config file given by
+/// --config is applied first, the other flags override its values.
+[[nodiscard]] CliOptions ParseCliOptions(const std::vector<std::string>& args);
+
+/// \returns the help text listing all flags
+[[nodiscard]] std::string GetCliUsage();
+
+} // namespace opensaft
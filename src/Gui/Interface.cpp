@@ -165,14 +165,14 @@ void Interface::TransducerWindow() {
 void Interface::SettingsWindow() {
   ImGui::Begin("Reconstruction settings", &show_settings_window);
 
-  // cropping applied along x y and t
+  // cropping applied along t
   float tCropMicro[2];
   tCropMicro[0] = sett->get_cropTMin() * 1e3; // stored as ms, sett as micros
   tCropMicro[1] = sett->get_cropTMax() * 1e3; // stored as ms, sett as micros
   ImGui::InputFloat2("t cropping [micros]", &tCropMicro[0]);
   sett->set_crop(0, tCropMicro[0] * 1e-3, tCropMicro[1] * 1e-3); // store as ms
-  ImGui::InputFloat2("x cropping [mm]", sett->get_pcropX());
-  ImGui::InputFloat2("y cropping [mm]", sett->get_pcropY());
+  // the lateral region is set with Saft::SetRegion, the reconstruction does
+  // not apply the x and y crop of the settings
   float rMinMm = sett->get_rMin() * 1e3;
   ImGui::InputFloat("min. r_recon [mm]", &rMinMm);
   sett->set_rMin(rMinMm * 1e-3);
@@ -192,6 +192,18 @@ void Interface::SettingsWindow() {
   HelpMarker(
       "While this program was originally developed to be used for OA image "
       "reconstruction it can also be applied to US pulse echo measurements");
+  // same order as ReconMode
+  const char* modeNames[] = {"exact", "separable approximation",
+                             "f-k migration"};
+  int mode = static_cast<int>(sett->get_mode());
+  if (ImGui::Combo("reconstruction mode", &mode, modeNames,
+                   IM_ARRAYSIZE(modeNames)))
+    sett->set_mode(static_cast<ReconMode>(mode));
+  ImGui::SameLine();
+  HelpMarker("The separable approximation reconstructs along x and then "
+             "along y instead of summing over the full aperture, the f-k "
+             "migration works in the frequency domain. Both are much faster "
+             "but approximate, meant for quick looks (CPU only)");
   ImGui::Checkbox("GPU", sett->get_pflagGpu());
   ImGui::SameLine();
   HelpMarker("Defines if we want to run the code on CPU or GPU");
@@ -0,0 +1,38 @@
+#include <cstddef>
+#include <new>
+
+#pragma once
+
+namespace opensaft {
+
+/// allocator handing out memory aligned to Alignment bytes, used for buffers
+/// which are streamed through the vectorized kernels
+template <typename T, std::size_t Alignment = 64> class AlignedAllocator {
+public:
+  using value_type = T;
+
+  template <typename U> struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() noexcept = default;
+
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+  [[nodiscard]] T* allocate(const std::size_t n) {
+    return static_cast<T*>(
+        ::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+  }
+
+  void deallocate(T* ptr, const std::size_t) noexcept {
+    ::operator delete(ptr, std::align_val_t{Alignment});
+  }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept {
+    return true;
+  }
+};
+
+} // namespace opensaft
@@ -0,0 +1,145 @@
+#include "Memory/BrickCodec.h"
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+namespace opensaft {
+
+namespace {
+
+/// zero runs shorter than this are cheaper to keep as literals
+constexpr std::size_t MinZeroRun = 4;
+
+void PutVarint(std::vector<uint8_t>& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<uint8_t>(value) | 0x80);
+    value >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t GetVarint(std::span<const uint8_t> data, std::size_t& pos) {
+  uint64_t value = 0;
+  for (unsigned int shift = 0; shift < 64; shift += 7) {
+    if (pos >= data.size())
+      throw std::runtime_error("truncated brick data");
+    const uint8_t byte = data[pos++];
+    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0)
+      return value;
+  }
+  throw std::runtime_error("invalid varint in brick data");
+}
+
+/// tokens are varints holding 2 * length for literals (followed by the bytes)
+/// and 2 * length + 1 for zero runs
+void EncodeZeroRuns(std::span<const uint8_t> in, std::vector<uint8_t>& out) {
+  std::size_t literalStart = 0;
+  std::size_t pos = 0;
+  while (pos < in.size()) {
+    if (in[pos] != 0) {
+      pos++;
+      continue;
+    }
+    std::size_t runEnd = pos;
+    while (runEnd < in.size() && in[runEnd] == 0)
+      runEnd++;
+    if (runEnd - pos < MinZeroRun && runEnd < in.size()) {
+      pos = runEnd;
+      continue;
+    }
+    if (pos > literalStart) {
+      PutVarint(out, 2 * (pos - literalStart));
+      out.insert(out.end(), in.begin() + literalStart, in.begin() + pos);
+    }
+    PutVarint(out, 2 * (runEnd - pos) + 1);
+    pos = runEnd;
+    literalStart = runEnd;
+  }
+  if (pos > literalStart) {
+    PutVarint(out, 2 * (pos - literalStart));
+    out.insert(out.end(), in.begin() + literalStart, in.begin() + pos);
+  }
+}
+
+void DecodeZeroRuns(std::span<const uint8_t> in, std::span<uint8_t> out) {
+  std::size_t inPos = 0;
+  std::size_t outPos = 0;
+  while (inPos < in.size()) {
+    const uint64_t token = GetVarint(in, inPos);
+    const uint64_t length = token / 2;
+    if (length > out.size() - outPos)
+      throw std::runtime_error("brick data exceeds brick size");
+    if (token & 1) {
+      std::memset(out.data() + outPos, 0, length);
+    } else {
+      if (length > in.size() - inPos)
+        throw std::runtime_error("truncated brick data");
+      std::memcpy(out.data() + outPos, in.data() + inPos, length);
+      inPos += length;
+    }
+    outPos += length;
+  }
+  if (outPos != out.size())
+    throw std::runtime_error("brick data is shorter than brick size");
+}
+
+} // namespace
+
+std::vector<uint8_t> CompressBrick(std::span<const float> voxels,
+                                   BrickCodec& codec) {
+  const std::size_t n = voxels.size();
+
+  // byte plane k holds byte k of every xor-ed word
+  std::vector<uint8_t> planes(n * sizeof(float));
+  uint32_t previous = 0;
+  for (std::size_t i = 0; i < n; i++) {
+    const uint32_t bits = std::bit_cast<uint32_t>(voxels[i]);
+    const uint32_t delta = bits ^ previous;
+    previous = bits;
+    for (std::size_t k = 0; k < sizeof(float); k++)
+      planes[k * n + i] = static_cast<uint8_t>(delta >> (8 * (3 - k)));
+  }
+
+  std::vector<uint8_t> encoded;
+  encoded.reserve(planes.size() / 2);
+  EncodeZeroRuns(planes, encoded);
+  if (encoded.size() < planes.size()) {
+    codec = BrickCodec::XorRle;
+    return encoded;
+  }
+
+  codec = BrickCodec::Raw;
+  std::vector<uint8_t> raw(n * sizeof(float));
+  std::memcpy(raw.data(), voxels.data(), raw.size());
+  return raw;
+}
+
+void DecompressBrick(std::span<const uint8_t> data, const BrickCodec codec,
+                     std::span<float> voxels) {
+  const std::size_t n = voxels.size();
+  switch (codec) {
+  case BrickCodec::Raw:
+    if (data.size() != n * sizeof(float))
+      throw std::runtime_error("raw brick has wrong size");
+    std::memcpy(voxels.data(), data.data(), data.size());
+    break;
+  case BrickCodec::XorRle: {
+    std::vector<uint8_t> planes(n * sizeof(float));
+    DecodeZeroRuns(data, planes);
+    uint32_t previous = 0;
+    for (std::size_t i = 0; i < n; i++) {
+      uint32_t delta = 0;
+      for (std::size_t k = 0; k < sizeof(float); k++)
+        delta = (delta << 8) | planes[k * n + i];
+      previous ^= delta;
+      voxels[i] = std::bit_cast<float>(previous);
+    }
+    break;
+  }
+  default:
+    throw std::runtime_error("unknown brick codec");
+  }
+}
+
+} // namespace opensaft
@@ -0,0 +1,28 @@
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#pragma once
+
+namespace opensaft {
+
+/// lossless compression of the voxels of one brick
+enum class BrickCodec : uint32_t {
+  Raw = 0,    //!< plain little endian floats
+  XorRle = 1, //!< xor with the previous voxel, byte shuffle, zero run length
+};
+
+/// compresses voxels: each float is xor-ed with its predecessor along the fast
+/// axis, so that sign, exponent and leading mantissa bits of smooth data
+/// become zero, then the bytes are grouped by significance and runs of zero
+/// bytes are run length encoded. Falls back to Raw if that is smaller.
+/// \returns the encoded bytes, codec receives the codec used
+[[nodiscard]] std::vector<uint8_t> CompressBrick(std::span<const float> voxels,
+                                                 BrickCodec& codec);
+
+/// decodes data written by CompressBrick into voxels, throws if data is
+/// corrupt or does not hold exactly voxels.size() values
+void DecompressBrick(std::span<const uint8_t> data, const BrickCodec codec,
+                     std::span<float> voxels);
+
+} // namespace opensaft
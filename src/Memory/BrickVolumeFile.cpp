@@ -0,0 +1,335 @@
+#include "Memory/BrickVolumeFile.h"
+#include "Util/ParallelFor.h"
+#include "Util/Profiler.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+namespace opensaft {
+
+namespace {
+
+/// header at the beginning of a bricked volume file, all values little endian
+struct BrickHeader {
+  char magic[8];        //!< always "OSAFTBRK"
+  uint32_t version;     //!< format version, currently 1
+  uint32_t headerSize;  //!< sizeof(BrickHeader)
+  uint64_t dims[3];     //!< number of voxels along x, y and z
+  uint64_t brickSize;   //!< edge length of a brick in voxels
+  uint64_t indexOffset; //!< byte offset of the brick index, 0 if unfinished
+  float res[3];         //!< resolution along x, y and z [m]
+  float center[3];      //!< center of the volume [m]
+};
+static_assert(sizeof(BrickHeader) == 80, "brick header must not be padded");
+static_assert(sizeof(BrickIndexEntry) == 16, "brick index must not be padded");
+
+constexpr char BrickMagic[8] = {'O', 'S', 'A', 'F', 'T', 'B', 'R', 'K'};
+constexpr uint32_t BrickVersion = 1;
+
+} // namespace
+
+BrickLayout::BrickLayout(const Size3& dims, const std::size_t brickSize)
+    : m_dims(dims), m_brickSize(brickSize) {
+  if (brickSize == 0)
+    throw std::invalid_argument("brick size must be positive");
+  for (std::size_t iDim = 0; iDim < 3; iDim++)
+    m_nBricks[iDim] = (dims[iDim] + brickSize - 1) / brickSize;
+}
+
+std::size_t BrickLayout::GetLinearIndex(const Size3& iBrick) const {
+  for (std::size_t iDim = 0; iDim < 3; iDim++) {
+    if (iBrick[iDim] >= m_nBricks[iDim])
+      throw std::out_of_range("brick index outside of volume");
+  }
+  return iBrick[0] + m_nBricks[0] * (iBrick[1] + m_nBricks[1] * iBrick[2]);
+}
+
+Size3 BrickLayout::GetBrickStart(const Size3& iBrick) const {
+  Size3 start;
+  for (std::size_t iDim = 0; iDim < 3; iDim++)
+    start[iDim] = iBrick[iDim] * m_brickSize;
+  return start;
+}
+
+Size3 BrickLayout::GetBrickDims(const Size3& iBrick) const {
+  Size3 dims;
+  for (std::size_t iDim = 0; iDim < 3; iDim++) {
+    const std::size_t start = iBrick[iDim] * m_brickSize;
+    dims[iDim] = std::min(m_brickSize, m_dims[iDim] - start);
+  }
+  return dims;
+}
+
+BrickVolumeWriter::BrickVolumeWriter(const std::string& filePath,
+                                     const Size3& dims, const Float3& res,
+                                     const Float3& center,
+                                     const std::size_t brickSize)
+    : m_layout(dims, brickSize),
+      m_index(m_layout.get_nBricks().InnerProduct()),
+      m_nextOffset(sizeof(BrickHeader)) {
+  BrickHeader header{};
+  std::memcpy(header.magic, BrickMagic, sizeof(BrickMagic));
+  header.version = BrickVersion;
+  header.headerSize = sizeof(BrickHeader);
+  header.brickSize = brickSize;
+  for (std::size_t iDim = 0; iDim < 3; iDim++) {
+    header.dims[iDim] = dims[iDim];
+    header.res[iDim] = res[iDim];
+    header.center[iDim] = center[iDim];
+  }
+
+  m_file.open(filePath, std::ios::binary | std::ios::in | std::ios::out |
+                            std::ios::trunc);
+  if (!m_file)
+    throw std::runtime_error("could not open " + filePath + " for writing");
+  m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (!m_file)
+    throw std::runtime_error("could not write header of " + filePath);
+}
+
+BrickVolumeWriter::~BrickVolumeWriter() {
+  if (!m_finalized) {
+    try {
+      Finalize();
+    } catch (...) {
+      // destructors must not throw, an unfinished file fails to open later
+    }
+  }
+}
+
+void BrickVolumeWriter::WriteBrick(const Size3& iBrick,
+                                   std::span<const float> voxels) {
+  const std::size_t iLinear = m_layout.GetLinearIndex(iBrick);
+  if (voxels.size() != m_layout.GetBrickDims(iBrick).InnerProduct())
+    throw std::invalid_argument("voxels do not match the brick size");
+
+  // compression runs outside of the lock, only the append is serialized
+  BrickCodec codec;
+  const std::vector<uint8_t> data = CompressBrick(voxels, codec);
+
+  std::scoped_lock lock(m_mutex);
+  if (m_finalized)
+    throw std::logic_error("brick volume file is already finalized");
+  if (m_index[iLinear].offset != 0)
+    throw std::invalid_argument("brick was already written");
+  m_file.seekp(m_nextOffset);
+  m_file.write(reinterpret_cast<const char*>(data.data()), data.size());
+  if (!m_file)
+    throw std::runtime_error("could not write brick to volume file");
+  m_index[iLinear] = {m_nextOffset, static_cast<uint32_t>(data.size()), codec};
+  m_nextOffset += data.size();
+  m_compressedBytes += data.size();
+}
+
+void BrickVolumeWriter::WriteSlab(const Volume& slab, const std::size_t yOffset,
+                                  const unsigned int threadCount) {
+  ProfileZone zone("write");
+  const Size3& dims = m_layout.get_dims();
+  const std::size_t brickSize = m_layout.get_brickSize();
+  const std::size_t yStop = yOffset + slab.get_dim(1);
+  if ((slab.get_dim(0) != dims[0]) || (slab.get_dim(2) != dims[2]) ||
+      (yStop > dims[1]))
+    throw std::invalid_argument("slab does not fit into volume");
+  if ((yOffset % brickSize != 0) ||
+      ((yStop % brickSize != 0) && (yStop != dims[1])))
+    throw std::invalid_argument("slab is not aligned to the bricks");
+
+  const Size3& nBricks = m_layout.get_nBricks();
+  std::vector<Size3> bricks;
+  for (std::size_t iZ = 0; iZ < nBricks[2]; iZ++) {
+    for (std::size_t iY = yOffset / brickSize; iY * brickSize < yStop; iY++) {
+      for (std::size_t iX = 0; iX < nBricks[0]; iX++)
+        bricks.push_back({iX, iY, iZ});
+    }
+  }
+
+  ParallelFor(bricks.size(), threadCount, [&](const std::size_t iBrick) {
+    const Size3 start = m_layout.GetBrickStart(bricks[iBrick]);
+    const Size3 brickDims = m_layout.GetBrickDims(bricks[iBrick]);
+    std::vector<float> voxels(brickDims.InnerProduct());
+    float* out = voxels.data();
+    for (std::size_t z = start[2]; z < start[2] + brickDims[2]; z++) {
+      for (std::size_t y = start[1]; y < start[1] + brickDims[1]; y++) {
+        const float* in =
+            &slab[start[0] + dims[0] * (y - yOffset + slab.get_dim(1) * z)];
+        out = std::copy(in, in + brickDims[0], out);
+      }
+    }
+    WriteBrick(bricks[iBrick], voxels);
+  });
+}
+
+void BrickVolumeWriter::Finalize() {
+  std::scoped_lock lock(m_mutex);
+  if (m_finalized)
+    return;
+
+  m_file.seekp(m_nextOffset);
+  m_file.write(reinterpret_cast<const char*>(m_index.data()),
+               m_index.size() * sizeof(BrickIndexEntry));
+  const uint64_t indexOffset = m_nextOffset;
+  m_file.seekp(offsetof(BrickHeader, indexOffset));
+  m_file.write(reinterpret_cast<const char*>(&indexOffset),
+               sizeof(indexOffset));
+  m_file.flush();
+  if (!m_file)
+    throw std::runtime_error("could not write brick index");
+  m_finalized = true;
+}
+
+uint64_t BrickVolumeWriter::get_compressedBytes() const {
+  std::scoped_lock lock(m_mutex);
+  return m_compressedBytes;
+}
+
+BrickVolumeReader::BrickVolumeReader(const std::string& filePath)
+    : m_layout(Size3(), 1) {
+  const std::size_t fileSize = std::filesystem::file_size(filePath);
+  if (fileSize < sizeof(BrickHeader))
+    throw std::runtime_error(filePath + " is not an opensaft brick volume");
+  m_file = std::make_unique<MappedFile>(filePath, 0, fileSize);
+
+  BrickHeader header;
+  std::memcpy(&header, m_file->data(), sizeof(header));
+  if (std::memcmp(header.magic, BrickMagic, sizeof(BrickMagic)) != 0)
+    throw std::runtime_error(filePath + " is not an opensaft brick volume");
+  if (header.version != BrickVersion ||
+      header.headerSize != sizeof(BrickHeader))
+    throw std::runtime_error("unsupported brick volume version in " +
+                             filePath);
+  if (header.indexOffset == 0)
+    throw std::runtime_error(filePath + " was not finalized");
+
+  m_layout = BrickLayout({header.dims[0], header.dims[1], header.dims[2]},
+                         header.brickSize);
+  m_res = {header.res[0], header.res[1], header.res[2]};
+  m_center = {header.center[0], header.center[1], header.center[2]};
+
+  m_index.resize(m_layout.get_nBricks().InnerProduct());
+  const std::size_t indexBytes = m_index.size() * sizeof(BrickIndexEntry);
+  if (header.indexOffset + indexBytes > fileSize)
+    throw std::runtime_error("truncated brick index in " + filePath);
+  std::memcpy(m_index.data(),
+              static_cast<const uint8_t*>(m_file->data()) + header.indexOffset,
+              indexBytes);
+  for (const BrickIndexEntry& entry : m_index) {
+    if (entry.offset + entry.size > header.indexOffset)
+      throw std::runtime_error("invalid brick offset in " + filePath);
+  }
+}
+
+void BrickVolumeReader::DecodeBrick(const Size3& iBrick,
+                                    std::span<float> voxels) const {
+  const BrickIndexEntry& entry = m_index[m_layout.GetLinearIndex(iBrick)];
+  if (entry.offset == 0) {
+    std::fill(voxels.begin(), voxels.end(), 0.0f);
+    return;
+  }
+  const auto* data = static_cast<const uint8_t*>(m_file->data());
+  DecompressBrick({data + entry.offset, entry.size}, entry.codec, voxels);
+}
+
+Volume BrickVolumeReader::CreateRegion(const Size3& start,
+                                       const Size3& dims) const {
+  Volume region(dims);
+  region.set_res(m_res);
+  Float3 center;
+  for (std::size_t iDim = 0; iDim < 3; iDim++) {
+    // offset between the center of the region and the full volume in voxels
+    const float shift = 0.5f * (2.0f * static_cast<float>(start[iDim]) +
+                                static_cast<float>(dims[iDim]) -
+                                static_cast<float>(get_dims()[iDim]));
+    center[iDim] = m_center[iDim] + m_res[iDim] * shift;
+  }
+  region.set_center(center);
+  return region;
+}
+
+void BrickVolumeReader::CopyBrick(const Size3& iBrick,
+                                  std::span<const float> voxels,
+                                  Volume& region,
+                                  const Size3& regionStart) const {
+  const Size3 start = m_layout.GetBrickStart(iBrick);
+  const Size3 dims = m_layout.GetBrickDims(iBrick);
+  const Size3 regionDims = region.get_dims();
+
+  // intersection of brick and region in volume coordinates
+  Size3 first;
+  Size3 last;
+  for (std::size_t iDim = 0; iDim < 3; iDim++) {
+    first[iDim] = std::max(start[iDim], regionStart[iDim]);
+    last[iDim] = std::min(start[iDim] + dims[iDim],
+                          regionStart[iDim] + regionDims[iDim]);
+    if (first[iDim] >= last[iDim])
+      return;
+  }
+
+  for (std::size_t z = first[2]; z < last[2]; z++) {
+    for (std::size_t y = first[1]; y < last[1]; y++) {
+      const float* in = &voxels[(first[0] - start[0]) +
+                                dims[0] * ((y - start[1]) +
+                                           dims[1] * (z - start[2]))];
+      float* out = &region(first[0] - regionStart[0], y - regionStart[1],
+                           z - regionStart[2]);
+      std::copy(in, in + (last[0] - first[0]), out);
+    }
+  }
+}
+
+Volume BrickVolumeReader::ReadBrick(const Size3& iBrick) const {
+  Volume brick = CreateRegion(m_layout.GetBrickStart(iBrick),
+                              m_layout.GetBrickDims(iBrick));
+  DecodeBrick(iBrick, brick);
+  return brick;
+}
+
+Volume BrickVolumeReader::ReadSlice(const Dimension dim,
+                                    const std::size_t idx) const {
+  const auto iDim = static_cast<std::size_t>(dim);
+  if (idx >= get_dims()[iDim])
+    throw std::out_of_range("slice index outside of volume");
+
+  Size3 start;
+  start[iDim] = idx;
+  Size3 dims = get_dims();
+  dims[iDim] = 1;
+  Volume slice = CreateRegion(start, dims);
+
+  Size3 nBricks = m_layout.get_nBricks();
+  Size3 firstBrick;
+  firstBrick[iDim] = idx / m_layout.get_brickSize();
+  nBricks[iDim] = firstBrick[iDim] + 1;
+  std::vector<float> voxels;
+  for (std::size_t iZ = firstBrick[2]; iZ < nBricks[2]; iZ++) {
+    for (std::size_t iY = firstBrick[1]; iY < nBricks[1]; iY++) {
+      for (std::size_t iX = firstBrick[0]; iX < nBricks[0]; iX++) {
+        const Size3 iBrick{iX, iY, iZ};
+        voxels.resize(m_layout.GetBrickDims(iBrick).InnerProduct());
+        DecodeBrick(iBrick, voxels);
+        CopyBrick(iBrick, voxels, slice, start);
+      }
+    }
+  }
+  return slice;
+}
+
+Volume BrickVolumeReader::ReadVolume() const {
+  Volume vol = CreateRegion(Size3(), get_dims());
+  const Size3& nBricks = m_layout.get_nBricks();
+  std::vector<float> voxels;
+  for (std::size_t iZ = 0; iZ < nBricks[2]; iZ++) {
+    for (std::size_t iY = 0; iY < nBricks[1]; iY++) {
+      for (std::size_t iX = 0; iX < nBricks[0]; iX++) {
+        const Size3 iBrick{iX, iY, iZ};
+        voxels.resize(m_layout.GetBrickDims(iBrick).InnerProduct());
+        DecodeBrick(iBrick, voxels);
+        CopyBrick(iBrick, voxels, vol, Size3());
+      }
+    }
+  }
+  return vol;
+}
+
+} // namespace opensaft
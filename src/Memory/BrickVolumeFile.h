@@ -0,0 +1,143 @@
+#include "Memory/BrickCodec.h"
+#include "Memory/MappedFile.h"
+#include "Memory/Volume.h"
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#pragma once
+
+namespace opensaft {
+
+/// subdivision of a volume into cubic bricks, bricks at the upper border are
+/// clipped to the volume
+class BrickLayout {
+public:
+  BrickLayout(const Size3& dims, const std::size_t brickSize);
+
+  [[nodiscard]] const Size3& get_dims() const noexcept { return m_dims; }
+  [[nodiscard]] std::size_t get_brickSize() const noexcept {
+    return m_brickSize;
+  }
+
+  /// \returns number of bricks along x, y and z
+  [[nodiscard]] const Size3& get_nBricks() const noexcept {
+    return m_nBricks;
+  }
+
+  /// \returns position of the brick in the list of bricks, x fastest
+  [[nodiscard]] std::size_t GetLinearIndex(const Size3& iBrick) const;
+
+  /// \returns first voxel of the brick
+  [[nodiscard]] Size3 GetBrickStart(const Size3& iBrick) const;
+
+  /// \returns number of voxels of the brick along x, y and z
+  [[nodiscard]] Size3 GetBrickDims(const Size3& iBrick) const;
+
+private:
+  Size3 m_dims;
+  std::size_t m_brickSize;
+  Size3 m_nBricks;
+};
+
+/// on disk location of a single brick
+struct BrickIndexEntry {
+  uint64_t offset = 0; //!< byte offset of the compressed brick, 0 if missing
+  uint32_t size = 0;   //!< number of compressed bytes
+  BrickCodec codec = BrickCodec::Raw;
+};
+
+/// writes a bricked, compressed volume file (see docs/data_format.md). Bricks
+/// can be written in any order and from several threads, each one is
+/// compressed by the calling thread and appended to the file as it arrives.
+class BrickVolumeWriter {
+public:
+  BrickVolumeWriter(const std::string& filePath, const Size3& dims,
+                    const Float3& res, const Float3& center,
+                    const std::size_t brickSize = 64);
+
+  /// finalizes the file if Finalize was not called
+  ~BrickVolumeWriter();
+
+  BrickVolumeWriter(const BrickVolumeWriter&) = delete;
+  BrickVolumeWriter& operator=(const BrickVolumeWriter&) = delete;
+
+  /// compresses and appends a single brick, voxels hold the brick x fastest
+  /// with the dimensions of BrickLayout::GetBrickDims. Thread safe.
+  void WriteBrick(const Size3& iBrick, std::span<const float> voxels);
+
+  /// writes all bricks of slab which spans the rows [yOffset, yOffset + nY of
+  /// slab), both borders need to be brick aligned or the end of the volume.
+  /// The bricks are compressed in parallel on threadCount threads (0: all)
+  void WriteSlab(const Volume& slab, const std::size_t yOffset,
+                 const unsigned int threadCount = 0);
+
+  /// writes the brick index, no further bricks can be written afterwards.
+  /// Bricks which were never written read as 0.
+  void Finalize();
+
+  [[nodiscard]] const BrickLayout& get_layout() const noexcept {
+    return m_layout;
+  }
+
+  /// \returns number of compressed voxel bytes written so far
+  [[nodiscard]] uint64_t get_compressedBytes() const;
+
+private:
+  BrickLayout m_layout;
+  std::fstream m_file;
+  mutable std::mutex m_mutex; //!< guards file, index and m_nextOffset
+  std::vector<BrickIndexEntry> m_index;
+  uint64_t m_nextOffset;      //!< where the next brick is appended
+  uint64_t m_compressedBytes = 0;
+  bool m_finalized = false;
+};
+
+/// random access to a bricked volume file, only the header and the brick
+/// index are read on construction and bricks are decompressed on demand
+class BrickVolumeReader {
+public:
+  explicit BrickVolumeReader(const std::string& filePath);
+
+  [[nodiscard]] const BrickLayout& get_layout() const noexcept {
+    return m_layout;
+  }
+  [[nodiscard]] const Size3& get_dims() const noexcept {
+    return m_layout.get_dims();
+  }
+  [[nodiscard]] const Float3& get_res() const noexcept { return m_res; }
+  [[nodiscard]] const Float3& get_center() const noexcept { return m_center; }
+
+  /// \returns a single brick including its position, thread safe
+  [[nodiscard]] Volume ReadBrick(const Size3& iBrick) const;
+
+  /// \returns the slice at index idx along dim (only the bricks intersecting
+  /// the slice are decompressed), the volume has one voxel along dim
+  [[nodiscard]] Volume ReadSlice(const Dimension dim,
+                                 const std::size_t idx) const;
+
+  /// \returns the full volume
+  [[nodiscard]] Volume ReadVolume() const;
+
+private:
+  /// decompresses brick iBrick into voxels (size of the brick)
+  void DecodeBrick(const Size3& iBrick, std::span<float> voxels) const;
+
+  /// \returns empty volume covering [start, start + dims) at its position
+  [[nodiscard]] Volume CreateRegion(const Size3& start,
+                                    const Size3& dims) const;
+
+  /// copies a decoded brick into region, which starts at regionStart
+  void CopyBrick(const Size3& iBrick, std::span<const float> voxels,
+                 Volume& region, const Size3& regionStart) const;
+
+  BrickLayout m_layout;
+  Float3 m_res;
+  Float3 m_center;
+  std::vector<BrickIndexEntry> m_index;
+  std::unique_ptr<MappedFile> m_file;
+};
+
+} // namespace opensaft
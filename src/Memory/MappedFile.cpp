@@ -0,0 +1,73 @@
+#include "Memory/MappedFile.h"
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace opensaft {
+
+MappedFile::MappedFile(const std::string& filePath, const std::size_t offset,
+                       const std::size_t length)
+    : m_length(length) {
+  const int fd = open(filePath.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("could not open " + filePath);
+
+  struct stat fileStat;
+  if ((fstat(fd, &fileStat) != 0) ||
+      (offset + length > static_cast<std::size_t>(fileStat.st_size))) {
+    close(fd);
+    throw std::runtime_error("requested range exceeds size of " + filePath);
+  }
+
+  // mmap requires the offset to be a multiple of the page size
+  const std::size_t pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  const std::size_t pageOffset = offset % pageSize;
+  m_mappingSize = length + pageOffset;
+  if (m_mappingSize > 0) {
+    // private mapping: in place preprocessing copies the touched pages and
+    // never writes back to the file
+    m_mapping = mmap(nullptr, m_mappingSize, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE, fd, static_cast<off_t>(offset - pageOffset));
+  }
+  close(fd);
+
+  if (m_mapping == MAP_FAILED) {
+    m_mapping = nullptr;
+    throw std::runtime_error("could not map " + filePath);
+  }
+  m_data = static_cast<char*>(m_mapping) + pageOffset;
+}
+
+void MappedFile::Release(const std::size_t offset,
+                         const std::size_t length) const {
+  const std::size_t pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  const std::size_t start = reinterpret_cast<std::size_t>(m_data) + offset;
+  const std::size_t stop = start + length;
+  const std::size_t firstPage = (start + pageSize - 1) / pageSize * pageSize;
+  const std::size_t lastPage = stop / pageSize * pageSize;
+  if (lastPage > firstPage)
+    madvise(reinterpret_cast<void*>(firstPage), lastPage - firstPage,
+            MADV_DONTNEED);
+}
+
+void MappedFile::Prefetch() const {
+  if (m_mapping == nullptr)
+    return;
+
+  // the advice lets the kernel read ahead in large requests, touching a
+  // byte of every page then maps them into this process
+  madvise(m_mapping, m_mappingSize, MADV_WILLNEED);
+  const std::size_t pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  const volatile char* bytes = static_cast<const char*>(m_mapping);
+  for (std::size_t offset = 0; offset < m_mappingSize; offset += pageSize)
+    static_cast<void>(bytes[offset]);
+}
+
+MappedFile::~MappedFile() {
+  if (m_mapping != nullptr)
+    munmap(m_mapping, m_mappingSize);
+}
+
+} // namespace opensaft
@@ -0,0 +1,43 @@
+#include <cstddef>
+#include <string>
+
+#pragma once
+
+namespace opensaft {
+
+/// read only, copy on write mapping of a byte range of a file, pages are only
+/// read from disk once they are touched
+class MappedFile {
+public:
+  /// maps length bytes starting at offset, offset does not need to be page
+  /// aligned
+  MappedFile(const std::string& filePath, const std::size_t offset,
+             const std::size_t length);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /// \returns pointer to the byte at the requested offset
+  [[nodiscard]] void* data() const noexcept { return m_data; }
+
+  /// \returns number of mapped bytes starting at data()
+  [[nodiscard]] std::size_t size() const noexcept { return m_length; }
+
+  /// reads all pages of the mapping from disk and maps them, so later
+  /// accesses do not fault. Blocks until the data is in memory.
+  void Prefetch() const;
+
+  /// hands the pages fully inside [offset, offset + length) of data() back to
+  /// the operating system, they are read from disk again on the next access
+  /// and lose any modification made in memory
+  void Release(const std::size_t offset, const std::size_t length) const;
+
+private:
+  void* m_mapping = nullptr;      //!< start of the page aligned mapping
+  std::size_t m_mappingSize = 0;  //!< size of the page aligned mapping
+  void* m_data = nullptr;         //!< requested offset within the mapping
+  std::size_t m_length = 0;       //!< requested length
+};
+
+} // namespace opensaft
@@ -1,19 +1,152 @@
 #include "Memory/UltrasoundSignals.h"
+#include <algorithm>
+#include <stdexcept>
 
 namespace opensaft {
 
-void TimeSignal::RemoveDC() {
+void SubtractMean(std::span<float> signal) {
   // calculate mean
   double mean = 0.0;
-  for (size_t i = 0; i < this->size(); i++) {
-    mean += this->at(i);
+  for (const float value : signal) {
+    mean += value;
   }
-  mean /= this->size();
+  mean /= signal.size();
 
   // remove mean
-  for (size_t i = 0; i < this->size(); i++) {
-    this->at(i) -= mean;
+  for (float& value : signal) {
+    value -= mean;
   }
 }
 
-} // namespace opensaft
\ No newline at end of file
+UltrasoundSignals::UltrasoundSignals(const AcquisitionProperties& props,
+                                     const std::size_t nT)
+    : AcquisitionProperties(props), m_nT(nT), m_stride(GetStride(nT)) {
+  m_samples.resize(size() * m_stride, 0.0f);
+  m_data = m_samples.data();
+  InitSignalProperties();
+}
+
+UltrasoundSignals::UltrasoundSignals(const AcquisitionProperties& props,
+                                     const std::size_t nT,
+                                     const std::size_t stride,
+                                     std::shared_ptr<MappedFile> mapping)
+    : AcquisitionProperties(props), m_nT(nT), m_stride(stride),
+      m_mapping(std::move(mapping)) {
+  m_data = static_cast<float*>(m_mapping->data());
+  InitSignalProperties();
+}
+
+UltrasoundSignals::UltrasoundSignals(const UltrasoundSignals& other)
+    : AcquisitionProperties(other), m_nT(other.m_nT), m_stride(other.m_stride),
+      m_samples(other.m_data, other.m_data + other.size() * other.m_stride),
+      m_sampleRate(other.m_sampleRate), m_deltaT(other.m_deltaT),
+      m_pos(other.m_pos) {
+  m_data = m_samples.data();
+}
+
+UltrasoundSignals::UltrasoundSignals(UltrasoundSignals&& other) noexcept
+    : AcquisitionProperties(other), m_nT(other.m_nT), m_stride(other.m_stride),
+      m_data(other.m_data), m_samples(std::move(other.m_samples)),
+      m_mapping(std::move(other.m_mapping)),
+      m_sampleRate(std::move(other.m_sampleRate)),
+      m_deltaT(std::move(other.m_deltaT)), m_pos(std::move(other.m_pos)) {
+  other.m_data = nullptr;
+  static_cast<AcquisitionProperties&>(other) = AcquisitionProperties();
+  other.m_nT = 0;
+  other.m_stride = 0;
+}
+
+UltrasoundSignals&
+UltrasoundSignals::operator=(const UltrasoundSignals& other) {
+  if (this != &other)
+    *this = UltrasoundSignals(other);
+  return *this;
+}
+
+UltrasoundSignals&
+UltrasoundSignals::operator=(UltrasoundSignals&& other) noexcept {
+  if (this != &other) {
+    static_cast<AcquisitionProperties&>(*this) = other;
+    m_nT = other.m_nT;
+    m_stride = other.m_stride;
+    m_data = other.m_data;
+    m_samples = std::move(other.m_samples);
+    m_mapping = std::move(other.m_mapping);
+    m_sampleRate = std::move(other.m_sampleRate);
+    m_deltaT = std::move(other.m_deltaT);
+    m_pos = std::move(other.m_pos);
+
+    other.m_data = nullptr;
+    static_cast<AcquisitionProperties&>(other) = AcquisitionProperties();
+    other.m_nT = 0;
+    other.m_stride = 0;
+  }
+  return *this;
+}
+
+UltrasoundSignals
+UltrasoundSignals::ExtractRows(const std::size_t yStart,
+                               const std::size_t yStop) const {
+  if (yStart >= yStop || yStop > nY)
+    throw std::out_of_range("invalid row range");
+
+  AcquisitionProperties props = *this;
+  props.nY = yStop - yStart;
+  props.origin[1] += dy * static_cast<float>(yStart);
+  UltrasoundSignals rows(props, m_nT);
+
+  for (std::size_t iY = yStart; iY < yStop; iY++) {
+    for (std::size_t iX = 0; iX < nX; iX++) {
+      const std::size_t iSig = iX + nX * iY;
+      const auto src = (*this)[iSig];
+      std::copy(src.begin(), src.end(), rows(iX, iY - yStart).begin());
+      rows.set_signalProperties(iX + nX * (iY - yStart),
+                                get_signalProperties(iSig));
+    }
+  }
+  return rows;
+}
+
+void UltrasoundSignals::Prefetch() const {
+  if (IsMapped())
+    m_mapping->Prefetch();
+}
+
+void UltrasoundSignals::DropCachedRows(const std::size_t yStart,
+                                       const std::size_t yStop) const {
+  if (!IsMapped() || yStart >= yStop)
+    return;
+
+  const std::size_t bytesPerRow = nX * m_stride * sizeof(float);
+  m_mapping->Release(yStart * bytesPerRow, (yStop - yStart) * bytesPerRow);
+}
+
+void UltrasoundSignals::set_properties(const AcquisitionProperties& props) {
+  if (props.nX * props.nY != size())
+    throw std::invalid_argument("number of waveforms must not change");
+
+  static_cast<AcquisitionProperties&>(*this) = props;
+  InitSignalProperties();
+}
+
+void UltrasoundSignals::set_signalProperties(
+    const std::size_t iSig, const TimeSignalProperties& props) {
+  m_sampleRate[iSig] = props.sampleRate;
+  m_deltaT[iSig] = props.deltaT;
+  m_pos[iSig] = props.pos;
+}
+
+void UltrasoundSignals::InitSignalProperties() {
+  m_sampleRate.assign(size(), sampleRate);
+  m_deltaT.assign(size(), t0);
+  m_pos.resize(size());
+  for (std::size_t iY = 0; iY < nY; iY++) {
+    for (std::size_t iX = 0; iX < nX; iX++) {
+      m_pos[iX + nX * iY] =
+          origin + Float3{dx * static_cast<float>(iX),
+                          dy * static_cast<float>(iY), 0.0f};
+    }
+  }
+}
+
+} // namespace opensaft
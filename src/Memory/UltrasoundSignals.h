@@ -1,5 +1,10 @@
-
+#include "Memory/AlignedAllocator.h"
+#include "Memory/MappedFile.h"
 #include "VectorN.h"
+#include <iterator>
+#include <memory>
+#include <span>
+#include <string>
 #include <vector>
 
 #pragma once
@@ -11,24 +16,241 @@ struct TimeSignalProperties {
   Float3 pos{0.0f};       //!< transducer position in global coordinate system
 };
 
+/// removes the DC content of a signal so that its mean is zero
+void SubtractMean(std::span<float> signal);
+
 class TimeSignal : public std::vector<float>, TimeSignalProperties {
 public:
   TimeSignal() = default;
   TimeSignal(const std::size_t nt) : std::vector<float>(nt, 0.0f) {}
 
   /// removes the DC content of a signal so that its mean is zero
-  void RemoveDC();
+  void RemoveDC() { SubtractMean(*this); }
 
 private:
 };
 
-struct AcquisitionProperties {};
+/// non owning view onto a single waveform stored inside UltrasoundSignals
+template <typename T> class BasicTimeSignalView : public std::span<T> {
+public:
+  using std::span<T>::span;
 
-class UltrasoundSignals : public std::vector<TimeSignal>,
-                          AcquisitionProperties {
+  /// removes the DC content of a signal so that its mean is zero
+  void RemoveDC() const
+    requires(!std::is_const_v<T>)
+  {
+    SubtractMean(*this);
+  }
+};
+
+using TimeSignalView = BasicTimeSignalView<float>;
+using ConstTimeSignalView = BasicTimeSignalView<const float>;
 
+/// iterates over all waveforms of UltrasoundSignals yielding views
+template <typename T> class TimeSignalIterator {
 public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = BasicTimeSignalView<T>;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = value_type;
+
+  TimeSignalIterator() = default;
+  TimeSignalIterator(T* ptr, const std::size_t stride, const std::size_t nT)
+      : m_ptr(ptr), m_stride(stride), m_nT(nT) {}
+
+  [[nodiscard]] reference operator*() const { return {m_ptr, m_nT}; }
+
+  TimeSignalIterator& operator++() {
+    m_ptr += m_stride;
+    return *this;
+  }
+
+  TimeSignalIterator operator++(int) {
+    TimeSignalIterator previous = *this;
+    ++(*this);
+    return previous;
+  }
+
+  [[nodiscard]] bool operator==(const TimeSignalIterator& other) const {
+    return m_ptr == other.m_ptr;
+  }
+
 private:
+  T* m_ptr = nullptr;
+  std::size_t m_stride = 0;
+  std::size_t m_nT = 0;
+};
+
+/// properties shared by all waveforms of a regular raster scan, the waveforms
+/// are stored with x being the fast and y the slow scan direction
+struct AcquisitionProperties {
+  std::size_t nX{0};      //!< number of A-scans along x
+  std::size_t nY{0};      //!< number of A-scans along y
+  float dx{1e-6f};        //!< step size of the raster along x [m]
+  float dy{1e-6f};        //!< step size of the raster along y [m]
+  float sampleRate{1e9f}; //!< sampling rate of all waveforms [Hz]
+  float t0{0.0f};         //!< time between excitation and first sample [s]
+  Float3 origin{0.0f};    //!< position of the first A-scan [m]
+};
+
+/// all waveforms of a raster scan stored in a single 64 byte aligned slab in
+/// [iy][ix][it] order, each waveform starts on its own cache line. The per
+/// waveform properties are kept in separate arrays next to it. Alternatively
+/// the slab can be a memory mapped region of a file (see ReadFromFile), then
+/// the waveforms are only guaranteed to be contiguous, not aligned.
+class UltrasoundSignals : AcquisitionProperties {
+
+public:
+  using iterator = TimeSignalIterator<float>;
+  using const_iterator = TimeSignalIterator<const float>;
+
+  /// number of bytes every waveform is aligned to
+  static constexpr std::size_t Alignment = 64;
+
+  UltrasoundSignals() = default;
+
+  /// allocates a zero initialized raster of nX * nY waveforms with nT samples
+  UltrasoundSignals(const AcquisitionProperties& props, const std::size_t nT);
+
+  /// \returns the samples between two waveforms allocated with nT samples,
+  /// nT padded to a multiple of the alignment
+  [[nodiscard]] static std::size_t GetStride(const std::size_t nT) {
+    constexpr std::size_t floatsPerLine = Alignment / sizeof(float);
+    return (nT + floatsPerLine - 1) / floatsPerLine * floatsPerLine;
+  }
+
+  /// copies of a memory mapped dataset hold their own samples
+  UltrasoundSignals(const UltrasoundSignals& other);
+  UltrasoundSignals(UltrasoundSignals&& other) noexcept;
+  UltrasoundSignals& operator=(const UltrasoundSignals& other);
+  UltrasoundSignals& operator=(UltrasoundSignals&& other) noexcept;
+
+  /// maps a dataset into memory without copying it, supports the raw format
+  /// described in docs/data_format.md and contiguous HDF5 datasets (.h5,
+  /// .hdf5, .mat) if compiled with OPENSAFT_HDF5_SUPPORT
+  [[nodiscard]] static UltrasoundSignals
+  ReadFromFile(const std::string& filePath);
+
+  /// writes the dataset in the raw format described in docs/data_format.md
+  void WriteToFile(const std::string& filePath) const;
+
+  /// \returns true if the samples are a memory mapped region of a file
+  [[nodiscard]] bool IsMapped() const noexcept { return m_mapping != nullptr; }
+
+  /// \returns a copy of the raster rows [yStart, yStop) with adjusted origin
+  [[nodiscard]] UltrasoundSignals ExtractRows(const std::size_t yStart,
+                                              const std::size_t yStop) const;
+
+  /// reads the samples of a mapped dataset into memory ahead of their use,
+  /// no-op if not mapped
+  void Prefetch() const;
+
+  /// releases the memory of the rows [yStart, yStop) of a mapped dataset, the
+  /// samples are read from the file again on the next access, so this must
+  /// only be used on datasets which were not modified. No-op if not mapped.
+  void DropCachedRows(const std::size_t yStart, const std::size_t yStop) const;
+
+  /// raster access operators (const and non const)
+  [[nodiscard]] TimeSignalView operator()(const std::size_t x,
+                                          const std::size_t y) {
+    return (*this)[x + nX * y];
+  }
+
+  [[nodiscard]] ConstTimeSignalView operator()(const std::size_t x,
+                                               const std::size_t y) const {
+    return (*this)[x + nX * y];
+  }
+
+  /// access to a waveform by its linear index ix + nX * iy
+  [[nodiscard]] TimeSignalView operator[](const std::size_t iSig) {
+    return {m_data + iSig * m_stride, m_nT};
+  }
+
+  [[nodiscard]] ConstTimeSignalView operator[](const std::size_t iSig) const {
+    return {m_data + iSig * m_stride, m_nT};
+  }
+
+  [[nodiscard]] iterator begin() { return {m_data, m_stride, m_nT}; }
+  [[nodiscard]] iterator end() {
+    return {m_data + size() * m_stride, m_stride, m_nT};
+  }
+  [[nodiscard]] const_iterator begin() const {
+    return {m_data, m_stride, m_nT};
+  }
+  [[nodiscard]] const_iterator end() const {
+    return {m_data + size() * m_stride, m_stride, m_nT};
+  }
+
+  /// \returns number of waveforms
+  [[nodiscard]] std::size_t size() const noexcept { return nX * nY; }
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+  /// \returns pointer to the first sample of the slab
+  [[nodiscard]] float* data() noexcept { return m_data; }
+  [[nodiscard]] const float* data() const noexcept { return m_data; }
+
+  /// \returns pointer to the first sample of waveform iSig
+  [[nodiscard]] const float* get_psignal(const std::size_t iSig) const {
+    return m_data + iSig * m_stride;
+  }
+
+  /// \returns distance between the first samples of two neighbouring waveforms
+  [[nodiscard]] std::size_t get_stride() const noexcept { return m_stride; }
+
+  [[nodiscard]] const AcquisitionProperties& get_properties() const noexcept {
+    return *this;
+  }
+  void set_properties(const AcquisitionProperties& props);
+
+  /// per waveform properties, initialized from the raster geometry
+  [[nodiscard]] TimeSignalProperties
+  get_signalProperties(const std::size_t iSig) const {
+    return {m_sampleRate[iSig], m_deltaT[iSig], m_pos[iSig]};
+  }
+  void set_signalProperties(const std::size_t iSig,
+                            const TimeSignalProperties& props);
+
+  [[nodiscard]] std::size_t get_nX() const noexcept { return nX; }
+  [[nodiscard]] std::size_t get_nY() const noexcept { return nY; }
+
+  /// \returns number of time samples per waveform
+  [[nodiscard]] std::size_t get_nT() const noexcept { return m_nT; }
+
+  /// \returns the temporal resolution of the waveforms [s]
+  [[nodiscard]] float get_dt() const noexcept { return 1.0f / sampleRate; }
+
+  /// \returns true if the waveforms form a non empty raster
+  [[nodiscard]] bool IsRaster() const { return !empty() && m_nT > 0; }
+
+private:
+  /// wraps memory mapped samples, stride may be any value >= nT
+  UltrasoundSignals(const AcquisitionProperties& props, const std::size_t nT,
+                    const std::size_t stride,
+                    std::shared_ptr<MappedFile> mapping);
+
+#ifdef OPENSAFT_HDF5_SUPPORT
+  [[nodiscard]] static UltrasoundSignals
+  ReadFromH5(const std::string& filePath);
+#endif
+
+  [[nodiscard]] static UltrasoundSignals
+  ReadFromRaw(const std::string& filePath);
+
+  /// derives position, delay and sampling rate of each waveform from the
+  /// raster geometry
+  void InitSignalProperties();
+
+  std::size_t m_nT = 0;     //!< number of samples per waveform
+  std::size_t m_stride = 0; //!< nT padded to a multiple of the alignment
+  float* m_data = nullptr;  //!< first sample, owned or mapped
+  std::vector<float, AlignedAllocator<float, Alignment>> m_samples; //!< owned
+  std::shared_ptr<MappedFile> m_mapping; //!< mapped region if not owned
+
+  // per waveform properties stored as structure of arrays
+  std::vector<float> m_sampleRate; //!< sampling rate of each waveform [Hz]
+  std::vector<float> m_deltaT;     //!< delay of each waveform [s]
+  std::vector<Float3> m_pos;       //!< position of each waveform [m]
 };
 
-} // namespace opensaft
\ No newline at end of file
+} // namespace opensaft
@@ -0,0 +1,226 @@
+// reading and writing of UltrasoundSignals, see docs/data_format.md
+
+#include "Memory/UltrasoundSignals.h"
+#include "Util/Profiler.h"
+#include <algorithm>
+#include <cstdint>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <stdexcept>
+
+#ifdef OPENSAFT_HDF5_SUPPORT
+#include <hdf5.h>
+#endif
+
+namespace opensaft {
+
+namespace {
+
+/// header at the beginning of a raw dataset file, all values little endian
+struct RawHeader {
+  char magic[8];       //!< always "OSAFTRAW"
+  uint32_t version;    //!< format version, currently 1
+  uint32_t headerSize; //!< sizeof(RawHeader)
+  uint64_t nX;         //!< number of A-scans along x
+  uint64_t nY;         //!< number of A-scans along y
+  uint64_t nT;         //!< number of samples per A-scan
+  uint64_t stride;     //!< samples between the start of two A-scans
+  uint64_t dataOffset; //!< byte offset of the first sample
+  float dx;            //!< step size along x [m]
+  float dy;            //!< step size along y [m]
+  float sampleRate;    //!< sampling rate [Hz]
+  float t0;            //!< time of the first sample [s]
+  float origin[3];     //!< position of the first A-scan [m]
+  float reserved[2];
+};
+static_assert(sizeof(RawHeader) == 96, "raw header must not be padded");
+
+constexpr char RawMagic[8] = {'O', 'S', 'A', 'F', 'T', 'R', 'A', 'W'};
+constexpr uint32_t RawVersion = 1;
+constexpr uint64_t RawDataAlignment = 4096; //!< page size of most systems
+
+bool HasExtension(const std::string& filePath,
+                  std::initializer_list<const char*> extensions) {
+  std::string extension = std::filesystem::path(filePath).extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return std::find(extensions.begin(), extensions.end(), extension) !=
+         extensions.end();
+}
+
+} // namespace
+
+UltrasoundSignals UltrasoundSignals::ReadFromFile(const std::string& filePath) {
+  ProfileZone zone("load");
+  if (HasExtension(filePath, {".h5", ".hdf5", ".mat"})) {
+#ifdef OPENSAFT_HDF5_SUPPORT
+    return ReadFromH5(filePath);
+#else
+    throw std::runtime_error("opensaft was compiled without HDF5 support");
+#endif
+  }
+  return ReadFromRaw(filePath);
+}
+
+UltrasoundSignals UltrasoundSignals::ReadFromRaw(const std::string& filePath) {
+  RawHeader header;
+  {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+      throw std::runtime_error("could not read header of " + filePath);
+  }
+
+  if (std::memcmp(header.magic, RawMagic, sizeof(RawMagic)) != 0)
+    throw std::runtime_error(filePath + " is not a raw opensaft dataset");
+  if (header.version != RawVersion || header.headerSize != sizeof(RawHeader))
+    throw std::runtime_error("unsupported raw format version in " + filePath);
+  if (header.stride < header.nT)
+    throw std::runtime_error("stride smaller than number of samples");
+
+  AcquisitionProperties props;
+  props.nX = header.nX;
+  props.nY = header.nY;
+  props.dx = header.dx;
+  props.dy = header.dy;
+  props.sampleRate = header.sampleRate;
+  props.t0 = header.t0;
+  props.origin = Float3{header.origin[0], header.origin[1], header.origin[2]};
+
+  const std::size_t nBytes =
+      header.nX * header.nY * header.stride * sizeof(float);
+  auto mapping =
+      std::make_shared<MappedFile>(filePath, header.dataOffset, nBytes);
+  return UltrasoundSignals(props, header.nT, header.stride,
+                           std::move(mapping));
+}
+
+void UltrasoundSignals::WriteToFile(const std::string& filePath) const {
+  RawHeader header{};
+  std::memcpy(header.magic, RawMagic, sizeof(RawMagic));
+  header.version = RawVersion;
+  header.headerSize = sizeof(RawHeader);
+  header.nX = nX;
+  header.nY = nY;
+  header.nT = m_nT;
+  header.stride = m_stride;
+  header.dataOffset = RawDataAlignment;
+  header.dx = dx;
+  header.dy = dy;
+  header.sampleRate = sampleRate;
+  header.t0 = t0;
+  for (std::size_t iDim = 0; iDim < 3; iDim++)
+    header.origin[iDim] = origin[iDim];
+
+  std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+  if (!file)
+    throw std::runtime_error("could not open " + filePath + " for writing");
+
+  // pad the header so the samples start on a page boundary and can be mapped
+  // with the alignment they had in memory
+  std::vector<char> padding(RawDataAlignment - sizeof(RawHeader), 0);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(padding.data(), padding.size());
+  file.write(reinterpret_cast<const char*>(m_data),
+             size() * m_stride * sizeof(float));
+  if (!file)
+    throw std::runtime_error("could not write " + filePath);
+}
+
+#ifdef OPENSAFT_HDF5_SUPPORT
+
+namespace {
+
+/// closes an HDF5 handle when going out of scope
+class H5Handle {
+public:
+  H5Handle(const hid_t id, herr_t (*close)(hid_t)) : m_id(id), m_close(close) {
+    if (m_id < 0)
+      throw std::runtime_error("HDF5 call failed");
+  }
+  ~H5Handle() { m_close(m_id); }
+  H5Handle(const H5Handle&) = delete;
+  H5Handle& operator=(const H5Handle&) = delete;
+
+  [[nodiscard]] hid_t get() const noexcept { return m_id; }
+
+private:
+  hid_t m_id;
+  herr_t (*m_close)(hid_t);
+};
+
+/// reads an optional float attribute of a dataset, keeps value if not present
+void ReadAttribute(const hid_t dataset, const char* name, float* value,
+                   const std::size_t nElements = 1) {
+  if (H5Aexists(dataset, name) <= 0)
+    return;
+
+  H5Handle attribute(H5Aopen(dataset, name, H5P_DEFAULT), H5Aclose);
+  H5Handle space(H5Aget_space(attribute.get()), H5Sclose);
+  if (H5Sget_simple_extent_npoints(space.get()) !=
+      static_cast<hssize_t>(nElements))
+    throw std::runtime_error(std::string("unexpected size of attribute ") +
+                             name);
+  H5Aread(attribute.get(), H5T_NATIVE_FLOAT, value);
+}
+
+} // namespace
+
+UltrasoundSignals UltrasoundSignals::ReadFromH5(const std::string& filePath) {
+  H5Handle file(H5Fopen(filePath.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT),
+                H5Fclose);
+  H5Handle dataset(H5Dopen2(file.get(), "signals", H5P_DEFAULT), H5Dclose);
+  H5Handle space(H5Dget_space(dataset.get()), H5Sclose);
+
+  // signals are stored as [nY][nX][nT] (nT x nX x nY in column major tools)
+  if (H5Sget_simple_extent_ndims(space.get()) != 3)
+    throw std::runtime_error("signals dataset must be three dimensional");
+  hsize_t dims[3];
+  H5Sget_simple_extent_dims(space.get(), dims, nullptr);
+
+  AcquisitionProperties props;
+  props.nY = dims[0];
+  props.nX = dims[1];
+  const std::size_t nT = dims[2];
+  ReadAttribute(dataset.get(), "dx", &props.dx);
+  ReadAttribute(dataset.get(), "dy", &props.dy);
+  ReadAttribute(dataset.get(), "sampleRate", &props.sampleRate);
+  ReadAttribute(dataset.get(), "t0", &props.t0);
+  ReadAttribute(dataset.get(), "origin", props.origin.get_data(), 3);
+
+  // contiguous native float datasets can be mapped directly, everything else
+  // (chunked, compressed, other types) goes through the HDF5 library
+  H5Handle type(H5Dget_type(dataset.get()), H5Tclose);
+  H5Handle dcpl(H5Dget_create_plist(dataset.get()), H5Pclose);
+  const haddr_t offset = H5Dget_offset(dataset.get());
+  if ((H5Tequal(type.get(), H5T_NATIVE_FLOAT) > 0) &&
+      (H5Pget_layout(dcpl.get()) == H5D_CONTIGUOUS) &&
+      (offset != HADDR_UNDEF)) {
+    // the offset is absolute and already includes the user block (e.g. the
+    // 512 byte header of MATLAB files)
+    auto mapping = std::make_shared<MappedFile>(
+        filePath, static_cast<std::size_t>(offset),
+        props.nX * props.nY * nT * sizeof(float));
+    return UltrasoundSignals(props, nT, nT, std::move(mapping));
+  }
+
+  // read into an aligned slab, the memory space skips the padding at the end
+  // of each waveform
+  UltrasoundSignals signals(props, nT);
+  const hsize_t memDims[2] = {props.nX * props.nY, signals.get_stride()};
+  const hsize_t memStart[2] = {0, 0};
+  const hsize_t memCount[2] = {props.nX * props.nY, nT};
+  H5Handle memSpace(H5Screate_simple(2, memDims, nullptr), H5Sclose);
+  H5Sselect_hyperslab(memSpace.get(), H5S_SELECT_SET, memStart, nullptr,
+                      memCount, nullptr);
+  if (H5Dread(dataset.get(), H5T_NATIVE_FLOAT, memSpace.get(), H5S_ALL,
+              H5P_DEFAULT, signals.data()) < 0)
+    throw std::runtime_error("could not read signals from " + filePath);
+  return signals;
+}
+
+#endif
+
+} // namespace opensaft
@@ -1,12 +1,63 @@
-
-
 #include "Memory/Volume.h"
+#include "Memory/VolumeFile.h"
+#include <algorithm>
+#include <cmath>
 
 namespace opensaft {
 
-void Volume::ReadFromFile(const std::string& filePath) {
-  // make sure that file extension is hdf
+Volume Volume::ReadFromFile(const std::string& filePath) {
+  return ReadVolumeFile(filePath);
+}
+
+void Volume::WriteToFile(const std::string& filePath) const {
+  VolumeFileWriter writer(filePath, m_dims, m_res, m_center);
+  writer.WriteSlab(*this, 0);
+}
+
+void Volume::set_cropRange(const uint8_t iDim, const float minPos,
+                           const float maxPos) {
+  const auto toIndex = [this, iDim](const float pos) {
+    return (pos - get_minPos(iDim)) / m_res[iDim];
+  };
+  const auto n = static_cast<float>(m_dims[iDim]);
+  const float first = std::clamp(std::floor(toIndex(minPos)), 0.0f, n - 1.0f);
+  const float last = std::clamp(std::ceil(toIndex(maxPos)), first + 1.0f, n);
+
+  Size3 start = m_mips.get_cropStart();
+  Size3 stop = m_mips.get_cropStop();
+  start[iDim] = static_cast<std::size_t>(first);
+  stop[iDim] = static_cast<std::size_t>(last);
+  m_mips.SetCropRange(start, stop);
+}
+
+void Volume::calcCroppedMips() {
+  if (!m_mips.IsValid(get_version()))
+    calcMips();
+  m_mips.CalculateCropped(std::as_const(*this), get_version());
+}
+
+std::span<const float> Volume::get_mip(const uint8_t iDim) {
+  if (!m_mips.IsValid(get_version()))
+    calcMips();
+  return m_mips.get_mip(iDim);
+}
+
+std::span<const float> Volume::get_croppedMip(const uint8_t iDim) {
+  if (get_updatedCropRange())
+    calcCroppedMips();
+  return m_mips.get_croppedMip(iDim);
+}
+
+float Volume::get_minValCrop() {
+  if (get_updatedCropRange())
+    calcCroppedMips();
+  return m_mips.get_minValCrop();
+}
 
+float Volume::get_maxValCrop() {
+  if (get_updatedCropRange())
+    calcCroppedMips();
+  return m_mips.get_maxValCrop();
 }
 
-} // namespace opensaft
\ No newline at end of file
+} // namespace opensaft
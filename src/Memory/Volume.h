@@ -1,7 +1,13 @@
 
+#include "Memory/VolumeMips.h"
+#include "Memory/VolumeStats.h"
 #include "VectorN.h"
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
 #include <vector>
 
 #pragma once
@@ -10,10 +16,76 @@ namespace opensaft {
 
 enum class Dimension { X, Y, Z };
 
+/// modification counter of a volume, atomic since the non const accessors
+/// may be called from several threads at once. Copies continue from the
+/// count of the original, like the caches they are copied with.
+class VersionCounter {
+public:
+  VersionCounter() = default;
+  VersionCounter(const VersionCounter& other) noexcept
+      : m_count(other.get()) {}
+  VersionCounter& operator=(const VersionCounter& other) noexcept {
+    m_count.store(other.get(), std::memory_order_relaxed);
+    return *this;
+  }
+
+  void Increment() noexcept {
+    m_count.fetch_add(1, std::memory_order_relaxed);
+  }
+  [[nodiscard]] uint64_t get() const noexcept {
+    return m_count.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<uint64_t> m_count{0};
+};
+
 class Volume : public std::vector<float> {
 public:
   Volume(const Size3& dims)
-      : std::vector<float>(dims.InnerProduct(), 0.0f), m_dims(dims) {}
+      : std::vector<float>(dims.InnerProduct(), 0.0f), m_dims(dims),
+        m_mips(dims) {}
+
+  // the non const accessors of std::vector are hidden to count the
+  // modifications the cached statistics and projections are compared
+  // against, pointers and iterators kept across GetStats or calcMips calls
+  // need to call InvalidateStats after writing. Parallel loops should take
+  // the pointer once outside of the loop body.
+  [[nodiscard]] float& operator[](const std::size_t idx) {
+    MarkModified();
+    return std::vector<float>::operator[](idx);
+  }
+  [[nodiscard]] const float& operator[](const std::size_t idx) const {
+    return std::vector<float>::operator[](idx);
+  }
+  [[nodiscard]] float& at(const std::size_t idx) {
+    MarkModified();
+    return std::vector<float>::at(idx);
+  }
+  [[nodiscard]] const float& at(const std::size_t idx) const {
+    return std::vector<float>::at(idx);
+  }
+  [[nodiscard]] float* data() noexcept {
+    MarkModified();
+    return std::vector<float>::data();
+  }
+  [[nodiscard]] const float* data() const noexcept {
+    return std::vector<float>::data();
+  }
+  [[nodiscard]] iterator begin() noexcept {
+    MarkModified();
+    return std::vector<float>::begin();
+  }
+  [[nodiscard]] const_iterator begin() const noexcept {
+    return std::vector<float>::begin();
+  }
+  [[nodiscard]] iterator end() noexcept {
+    MarkModified();
+    return std::vector<float>::end();
+  }
+  [[nodiscard]] const_iterator end() const noexcept {
+    return std::vector<float>::end();
+  }
 
   /// volumetric access operators (const and non const)
   [[nodiscard]] float& operator()(const std::size_t x, const std::size_t y,
@@ -27,8 +99,7 @@ public:
   }
 
   void operator=(const float& setPoint) {
-    for (auto& elem : *this)
-      elem = setPoint;
+    std::fill(begin(), end(), setPoint);
   }
 
   /// \return side length along that dimension
@@ -46,16 +117,32 @@ public:
     return m_center[iDim] + get_length(iDim) * 0.5f;
   }
 
-  /// \returns the minimum value held by the data vector
-  [[nodiscard]] float get_minVal() const {
-    return *std::min_element(begin(), end());
+  /// \returns min, max, absolute max, mean, standard deviation and, if
+  /// nBins > 0, a histogram of the voxels, see CalculateStats. The result is
+  /// cached until the voxels are accessed non const.
+  [[nodiscard]] VolumeStats GetStats(const std::size_t nBins = 0) const {
+    return m_stats.Get(*this, nBins, get_version());
   }
 
-  /// \returns the maximum value held by the data vector
-  [[nodiscard]] float get_maxVal() const {
-    return *std::max_element(begin(), end());
+  /// marks the cached statistics as outdated after writing through a pointer
+  /// or iterator obtained before the last GetStats
+  void InvalidateStats() noexcept { MarkModified(); }
+
+  /// \returns counter increased on every non const access, caches derived
+  /// from the voxels are outdated once it changed
+  [[nodiscard]] uint64_t get_version() const noexcept {
+    return m_version.get();
   }
 
+  /// \returns the minimum value held by the data vector
+  [[nodiscard]] float get_minVal() const { return GetStats().minVal; }
+
+  /// \returns the maximum value held by the data vector
+  [[nodiscard]] float get_maxVal() const { return GetStats().maxVal; }
+
+  /// \returns the largest magnitude held by the data vector
+  [[nodiscard]] float get_absMaxVal() const { return GetStats().absMax; }
+
   /// \returns the resolution of the vector along xzy
   [[nodiscard]] Float3 get_res() const { return m_res; }
 
@@ -93,6 +180,9 @@ public:
 
   [[nodiscard]] Float3 get_center() const { return m_center; }
 
+  void set_center(const Float3& center) { m_center = center; }
+  void set_res(const Float3& res) { m_res = res; }
+
   [[nodiscard]] bool operator==(const Volume& other) {
     if (m_center != other.get_center())
       return false;
@@ -107,13 +197,71 @@ public:
     return true;
   }
 
-  /// \returns reads the volume from a file (shouldbe externalized later)
-  void ReadFromFile(const std::string& filePath);
+  /// computes the maximum intensity projections along x, y and z in one
+  /// parallel pass, see VolumeMips. The getters below call it on demand, the
+  /// projections are cached until the voxels change like GetStats.
+  void calcMips() { m_mips.Calculate(std::as_const(*this), get_version()); }
+
+  /// crops the projections to the voxels [start, stop) along each dimension
+  void set_cropRange(const Size3& start, const Size3& stop) {
+    m_mips.SetCropRange(start, stop);
+  }
+
+  /// crops the projections along iDim to the voxels overlapping the
+  /// positions [minPos, maxPos], at least one voxel is kept
+  void set_cropRange(const uint8_t iDim, const float minPos,
+                     const float maxPos);
+
+  [[nodiscard]] Size3 get_cropStart() const { return m_mips.get_cropStart(); }
+  [[nodiscard]] Size3 get_cropStop() const { return m_mips.get_cropStop(); }
+
+  /// \returns true if the cropped projections need to be updated
+  [[nodiscard]] bool get_updatedCropRange() const {
+    return !m_mips.IsValid(get_version()) || m_mips.IsCroppedOutdated();
+  }
+
+  /// updates the cropped projections along the dimensions whose crop range
+  /// changed, the others are kept. Only the blocks of voxels at the borders
+  /// of the crop range are read from the volume.
+  void calcCroppedMips();
+
+  /// projections along iDim of the full volume, see VolumeMips for the layout
+  [[nodiscard]] std::span<const float> get_mip(const uint8_t iDim);
+  [[nodiscard]] std::span<const float> get_mipX() { return get_mip(0); }
+  [[nodiscard]] std::span<const float> get_mipY() { return get_mip(1); }
+  [[nodiscard]] std::span<const float> get_mipZ() { return get_mip(2); }
+
+  /// projections along iDim of the voxels within the crop range
+  [[nodiscard]] std::span<const float> get_croppedMip(const uint8_t iDim);
+  [[nodiscard]] std::span<const float> get_croppedMipX() {
+    return get_croppedMip(0);
+  }
+  [[nodiscard]] std::span<const float> get_croppedMipY() {
+    return get_croppedMip(1);
+  }
+  [[nodiscard]] std::span<const float> get_croppedMipZ() {
+    return get_croppedMip(2);
+  }
+
+  /// value range of the cropped projection along z within the crop range
+  [[nodiscard]] float get_minValCrop();
+  [[nodiscard]] float get_maxValCrop();
+
+  /// \returns the volume stored in a raw volume file
+  [[nodiscard]] static Volume ReadFromFile(const std::string& filePath);
+
+  /// writes the volume to a raw volume file, see docs/data_format.md
+  void WriteToFile(const std::string& filePath) const;
 
 private:
   Float3 m_center{0.0f}; ///!< the center of the 3D volume
   Float3 m_res{1.0f};    ///!< the resolution of the voxels in xyz
   const Size3 m_dims;    ///!< number of voxels along each dimension
+  VolumeStatsCache m_stats;
+  VolumeMips m_mips;
+  VersionCounter m_version; ///!< see get_version
+
+  void MarkModified() noexcept { m_version.Increment(); }
 };
 
 } // namespace opensaft
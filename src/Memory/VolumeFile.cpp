@@ -0,0 +1,107 @@
+#include "Memory/VolumeFile.h"
+#include "Util/Profiler.h"
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace opensaft {
+
+namespace {
+
+/// header at the beginning of a raw volume file, all values little endian
+struct VolumeHeader {
+  char magic[8];       //!< always "OSAFTVOL"
+  uint32_t version;    //!< format version, currently 1
+  uint32_t headerSize; //!< sizeof(VolumeHeader)
+  uint64_t dims[3];    //!< number of voxels along x, y and z
+  uint64_t dataOffset; //!< byte offset of the first voxel
+  float res[3];        //!< resolution along x, y and z [m]
+  float center[3];     //!< center of the volume [m]
+};
+static_assert(sizeof(VolumeHeader) == 72, "volume header must not be padded");
+
+constexpr char VolumeMagic[8] = {'O', 'S', 'A', 'F', 'T', 'V', 'O', 'L'};
+constexpr uint32_t VolumeVersion = 1;
+constexpr uint64_t VolumeDataAlignment = 4096;
+
+} // namespace
+
+VolumeFileWriter::VolumeFileWriter(const std::string& filePath,
+                                   const Size3& dims, const Float3& res,
+                                   const Float3& center)
+    : m_dims(dims), m_dataOffset(VolumeDataAlignment) {
+  VolumeHeader header{};
+  std::memcpy(header.magic, VolumeMagic, sizeof(VolumeMagic));
+  header.version = VolumeVersion;
+  header.headerSize = sizeof(VolumeHeader);
+  header.dataOffset = m_dataOffset;
+  for (std::size_t iDim = 0; iDim < 3; iDim++) {
+    header.dims[iDim] = dims[iDim];
+    header.res[iDim] = res[iDim];
+    header.center[iDim] = center[iDim];
+  }
+
+  m_file.open(filePath, std::ios::binary | std::ios::in | std::ios::out |
+                            std::ios::trunc);
+  if (!m_file)
+    throw std::runtime_error("could not open " + filePath + " for writing");
+
+  std::vector<char> padding(m_dataOffset - sizeof(VolumeHeader), 0);
+  m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  m_file.write(padding.data(), padding.size());
+
+  // extend the file to its final size, unwritten voxels read as 0
+  const uint64_t nBytes = dims.InnerProduct() * sizeof(float);
+  if (nBytes > 0) {
+    m_file.seekp(m_dataOffset + nBytes - 1);
+    m_file.put(0);
+  }
+  if (!m_file)
+    throw std::runtime_error("could not write header of " + filePath);
+}
+
+void VolumeFileWriter::WriteSlab(const Volume& slab,
+                                 const std::size_t yOffset) {
+  ProfileZone zone("write");
+  const std::size_t nX = m_dims[0];
+  const std::size_t nY = m_dims[1];
+  const std::size_t nYSlab = slab.get_dim(1);
+  if ((slab.get_dim(0) != nX) || (slab.get_dim(2) != m_dims[2]) ||
+      (yOffset + nYSlab > nY))
+    throw std::invalid_argument("slab does not fit into volume");
+
+  // x and y are the fast axes, so each z layer of the slab is one contiguous
+  // run in the file
+  for (std::size_t iZ = 0; iZ < m_dims[2]; iZ++) {
+    m_file.seekp(m_dataOffset + (nX * (yOffset + nY * iZ)) * sizeof(float));
+    m_file.write(reinterpret_cast<const char*>(slab.data() + nX * nYSlab * iZ),
+                 nX * nYSlab * sizeof(float));
+  }
+  m_file.flush();
+  if (!m_file)
+    throw std::runtime_error("could not write slab to volume file");
+}
+
+Volume ReadVolumeFile(const std::string& filePath) {
+  std::ifstream file(filePath, std::ios::binary);
+  VolumeHeader header;
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+    throw std::runtime_error("could not read header of " + filePath);
+  if (std::memcmp(header.magic, VolumeMagic, sizeof(VolumeMagic)) != 0)
+    throw std::runtime_error(filePath + " is not an opensaft volume");
+  if (header.version != VolumeVersion ||
+      header.headerSize != sizeof(VolumeHeader))
+    throw std::runtime_error("unsupported volume version in " + filePath);
+
+  Volume vol(Size3{header.dims[0], header.dims[1], header.dims[2]});
+  vol.set_res(Float3{header.res[0], header.res[1], header.res[2]});
+  vol.set_center(Float3{header.center[0], header.center[1], header.center[2]});
+
+  file.seekg(header.dataOffset);
+  if (!file.read(reinterpret_cast<char*>(vol.data()),
+                 vol.size() * sizeof(float)))
+    throw std::runtime_error("could not read voxels of " + filePath);
+  return vol;
+}
+
+} // namespace opensaft
@@ -0,0 +1,31 @@
+#include "Memory/Volume.h"
+#include <fstream>
+#include <string>
+
+#pragma once
+
+namespace opensaft {
+
+/// writes a raw volume file (see docs/data_format.md) in slabs along y, so a
+/// volume never needs to be held in memory as a whole
+class VolumeFileWriter {
+public:
+  /// creates the file and writes the header, all voxels are initialized to 0
+  VolumeFileWriter(const std::string& filePath, const Size3& dims,
+                   const Float3& res, const Float3& center);
+
+  /// writes all voxels of slab into the rows [yOffset, yOffset + nY of slab)
+  void WriteSlab(const Volume& slab, const std::size_t yOffset);
+
+  [[nodiscard]] const Size3& get_dims() const noexcept { return m_dims; }
+
+private:
+  std::fstream m_file;
+  Size3 m_dims;
+  uint64_t m_dataOffset; //!< byte offset of the first voxel
+};
+
+/// reads a raw volume file written by Volume::WriteToFile or VolumeFileWriter
+[[nodiscard]] Volume ReadVolumeFile(const std::string& filePath);
+
+} // namespace opensaft
@@ -0,0 +1,175 @@
+#include "Memory/VolumeMips.h"
+#include "Util/ParallelFor.h"
+#include "Util/Profiler.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace opensaft {
+
+namespace {
+
+constexpr float lowest = std::numeric_limits<float>::lowest();
+
+/// out = max(out, in) for n values
+void MaxInto(float* out, const float* in, const std::size_t n) {
+  for (std::size_t i = 0; i < n; i++)
+    out[i] = std::max(out[i], in[i]);
+}
+
+} // namespace
+
+void VolumeMips::Calculate(std::span<const float> voxels,
+                           const uint64_t version) {
+  ProfileZone zone("MIP");
+  const std::size_t nX = m_dims[0];
+  const std::size_t nY = m_dims[1];
+  const std::size_t nZ = m_dims[2];
+  const Size3 nBlocks = (m_dims + Size3(BlockSize - 1)) / BlockSize;
+  m_blockMax[0].assign(nY * nZ * nBlocks[0], lowest);
+  m_blockMax[1].assign(nX * nZ * nBlocks[1], lowest);
+  m_blockMax[2].assign(nX * nY * nBlocks[2], lowest);
+
+  // a task reads BlockSize x BlockSize rows along x, so every block maximum
+  // is written by a single task and the rows of the z blocks stay in cache
+  ParallelFor(nBlocks[1] * nBlocks[2], 0, [&](const std::size_t iTask) {
+    const std::size_t yBlock = iTask % nBlocks[1];
+    const std::size_t zBlock = iTask / nBlocks[1];
+    const std::size_t yStop = std::min((yBlock + 1) * BlockSize, nY);
+    const std::size_t zStop = std::min((zBlock + 1) * BlockSize, nZ);
+    for (std::size_t z = zBlock * BlockSize; z < zStop; z++) {
+      for (std::size_t y = yBlock * BlockSize; y < yStop; y++) {
+        const float* row = voxels.data() + nX * (y + nY * z);
+        MaxInto(&m_blockMax[2][nX * (y + nY * zBlock)], row, nX);
+        MaxInto(&m_blockMax[1][nX * (z + nZ * yBlock)], row, nX);
+        for (std::size_t xBlock = 0; xBlock < nBlocks[0]; xBlock++) {
+          const float* first = row + xBlock * BlockSize;
+          const float* last = row + std::min((xBlock + 1) * BlockSize, nX);
+          m_blockMax[0][y + nY * (z + nZ * xBlock)] =
+              *std::max_element(first, last);
+        }
+      }
+    }
+  });
+
+  // the full projections only read the block maxima
+  m_version = version;
+  for (uint8_t iDim = 0; iDim < 3; iDim++) {
+    Project(voxels, iDim, 0, m_dims[iDim], m_mips[iDim]);
+    m_isCroppedValid[iDim] = false;
+  }
+  m_isRangeValid = false;
+}
+
+void VolumeMips::SetCropRange(const Size3& start, const Size3& stop) {
+  for (uint8_t iDim = 0; iDim < 3; iDim++) {
+    if ((start[iDim] >= stop[iDim]) || (stop[iDim] > m_dims[iDim]))
+      throw std::invalid_argument("crop range is empty or exceeds volume");
+  }
+  for (uint8_t iDim = 0; iDim < 3; iDim++) {
+    if ((start[iDim] != m_cropStart[iDim]) ||
+        (stop[iDim] != m_cropStop[iDim])) {
+      m_isCroppedValid[iDim] = false;
+      m_isRangeValid = false;
+    }
+  }
+  m_cropStart = start;
+  m_cropStop = stop;
+}
+
+void VolumeMips::CalculateCropped(std::span<const float> voxels,
+                                  const uint64_t version) {
+  if (!IsValid(version))
+    throw std::runtime_error("projections need to be calculated first");
+  ProfileZone zone("MIP");
+  for (uint8_t iDim = 0; iDim < 3; iDim++) {
+    if (!m_isCroppedValid[iDim]) {
+      Project(voxels, iDim, m_cropStart[iDim], m_cropStop[iDim],
+              m_croppedMips[iDim]);
+      m_isCroppedValid[iDim] = true;
+    }
+  }
+  if (!m_isRangeValid)
+    UpdateCropRange();
+}
+
+void VolumeMips::ScanCropped(std::span<const float> voxels,
+                             const uint8_t iDim,
+                             std::vector<float>& image) const {
+  Project(voxels, iDim, m_cropStart[iDim], m_cropStop[iDim], image, false);
+}
+
+bool VolumeMips::IsCroppedOutdated() const noexcept {
+  return !m_isRangeValid ||
+         std::find(m_isCroppedValid.begin(), m_isCroppedValid.end(),
+                   false) != m_isCroppedValid.end();
+}
+
+void VolumeMips::Project(std::span<const float> voxels, const uint8_t iDim,
+                         const std::size_t start, const std::size_t stop,
+                         std::vector<float>& image,
+                         const bool useBlocks) const {
+  const std::size_t nX = m_dims[0];
+  const std::size_t nY = m_dims[1];
+  const std::size_t nZ = m_dims[2];
+  const std::size_t n = m_dims[iDim];
+  const std::size_t nBlocks = (n + BlockSize - 1) / BlockSize;
+
+  // blocks entirely within [start, stop), the last block may be shorter
+  std::size_t blockFirst = (start + BlockSize - 1) / BlockSize;
+  std::size_t blockLast = (stop == n) ? nBlocks : stop / BlockSize;
+  // voxels of the partial blocks: [start, headStop) and [tailStart, stop)
+  std::size_t headStop = stop;
+  std::size_t tailStart = stop;
+  if (useBlocks && blockFirst < blockLast) {
+    headStop = blockFirst * BlockSize;
+    tailStart = std::min(blockLast * BlockSize, stop);
+  } else {
+    blockFirst = blockLast = 0;
+  }
+
+  const std::size_t rowLength = (iDim == 0) ? nY : nX;
+  const std::size_t nRows = (iDim == 2) ? nY : nZ;
+  const std::size_t imageSize = rowLength * nRows;
+  const std::vector<float>& blockMax = m_blockMax[iDim];
+  image.assign(imageSize, lowest);
+
+  // a row of the image per task: along z row y, along x and y row z
+  ParallelFor(nRows, 0, [&](const std::size_t iRow) {
+    float* out = image.data() + rowLength * iRow;
+    for (std::size_t iBlock = blockFirst; iBlock < blockLast; iBlock++)
+      MaxInto(out, &blockMax[rowLength * iRow + imageSize * iBlock],
+              rowLength);
+
+    const auto scan = [&](const std::size_t first, const std::size_t last) {
+      for (std::size_t i = first; i < last; i++) {
+        if (iDim == 2) {
+          MaxInto(out, voxels.data() + nX * (iRow + nY * i), nX);
+        } else if (iDim == 1) {
+          MaxInto(out, voxels.data() + nX * (i + nY * iRow), nX);
+        } else {
+          for (std::size_t y = 0; y < nY; y++)
+            out[y] = std::max(out[y], voxels[i + nX * (y + nY * iRow)]);
+        }
+      }
+    };
+    scan(start, headStop);
+    scan(tailStart, stop);
+  });
+}
+
+void VolumeMips::UpdateCropRange() {
+  const std::vector<float>& image = m_croppedMips[2];
+  m_minValCrop = std::numeric_limits<float>::max();
+  m_maxValCrop = lowest;
+  for (std::size_t y = m_cropStart[1]; y < m_cropStop[1]; y++) {
+    const auto row = image.begin() + m_dims[0] * y;
+    const auto [minIt, maxIt] = std::minmax_element(row + m_cropStart[0],
+                                                    row + m_cropStop[0]);
+    m_minValCrop = std::min(m_minValCrop, *minIt);
+    m_maxValCrop = std::max(m_maxValCrop, *maxIt);
+  }
+  m_isRangeValid = true;
+}
+
+} // namespace opensaft
@@ -0,0 +1,97 @@
+#include "VectorN.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#pragma once
+
+namespace opensaft {
+
+/// maximum intensity projections (MIPs) of a volume along x, y and z and
+/// their cropped variants, held by Volume (see Volume::calcMips). The
+/// projection along x is an nY x nZ image (y fastest), along y nX x nZ and
+/// along z nX x nY. Next to the projections the maxima of blocks of
+/// BlockSize voxels along each dimension are kept (3 / BlockSize of the
+/// volume), so a cropped projection only reads the blocks within the crop
+/// range and the voxels of the partial blocks at its borders.
+class VolumeMips {
+public:
+  static constexpr std::size_t BlockSize = 32;
+
+  /// crop range spans the full volume of dims
+  explicit VolumeMips(const Size3& dims)
+      : m_dims(dims), m_cropStart{0ul, 0ul, 0ul}, m_cropStop(dims) {}
+
+  /// \returns true if the projections were calculated for this version of
+  /// the voxels, see Volume::get_version
+  [[nodiscard]] bool IsValid(const uint64_t version) const noexcept {
+    return m_version == version;
+  }
+
+  /// computes the block maxima and the projections in one cache blocked
+  /// pass over the volume on all processor units
+  void Calculate(std::span<const float> voxels, const uint64_t version);
+
+  /// crops the voxels to [start, stop) along each dimension, throws
+  /// std::invalid_argument if a range is empty or exceeds the volume
+  void SetCropRange(const Size3& start, const Size3& stop);
+
+  /// updates the cropped projections along the dimensions whose crop range
+  /// changed, requires projections valid for version
+  void CalculateCropped(std::span<const float> voxels, const uint64_t version);
+
+  /// projects the crop range along iDim into image by scanning every voxel
+  /// of it without the block maxima, the baseline of CalculateCropped
+  void ScanCropped(std::span<const float> voxels, const uint8_t iDim,
+                   std::vector<float>& image) const;
+
+  /// \returns true if a crop range changed since the last CalculateCropped
+  [[nodiscard]] bool IsCroppedOutdated() const noexcept;
+
+  [[nodiscard]] std::span<const float> get_mip(const uint8_t iDim) const {
+    return m_mips[iDim];
+  }
+  [[nodiscard]] std::span<const float>
+  get_croppedMip(const uint8_t iDim) const {
+    return m_croppedMips[iDim];
+  }
+  [[nodiscard]] const Size3& get_cropStart() const noexcept {
+    return m_cropStart;
+  }
+  [[nodiscard]] const Size3& get_cropStop() const noexcept {
+    return m_cropStop;
+  }
+
+  /// value range of the cropped projection along z within the crop range
+  [[nodiscard]] float get_minValCrop() const noexcept { return m_minValCrop; }
+  [[nodiscard]] float get_maxValCrop() const noexcept { return m_maxValCrop; }
+
+private:
+  /// maximum over [start, stop) along iDim of each pixel of the projection,
+  /// from the block maxima within the range unless useBlocks is false
+  void Project(std::span<const float> voxels, const uint8_t iDim,
+               const std::size_t start, const std::size_t stop,
+               std::vector<float>& image, const bool useBlocks = true) const;
+  void UpdateCropRange();
+
+  const Size3 m_dims;
+  //! version of the voxels the projections belong to, none before the first
+  //! Calculate
+  std::optional<uint64_t> m_version;
+  //! maxima of the blocks along each dimension, one projection image per
+  //! block appended in block order
+  std::array<std::vector<float>, 3> m_blockMax;
+  std::array<std::vector<float>, 3> m_mips;
+  std::array<std::vector<float>, 3> m_croppedMips;
+  Size3 m_cropStart;
+  Size3 m_cropStop;
+  std::array<bool, 3> m_isCroppedValid{false, false, false};
+  bool m_isRangeValid = false; //!< m_min/maxValCrop match the crop range
+  float m_minValCrop = 0.0f;
+  float m_maxValCrop = 0.0f;
+};
+
+} // namespace opensaft
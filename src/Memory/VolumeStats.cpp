@@ -0,0 +1,210 @@
+#include "Memory/VolumeStats.h"
+#include "Recon/SimdKernel.h"
+#include "Util/ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define OPENSAFT_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace opensaft {
+
+namespace {
+
+/// values per task, large enough to amortize the scheduling
+constexpr std::size_t chunkSize = std::size_t{1} << 16;
+
+/// values summed in float lanes before they are flushed into the double sums
+constexpr std::size_t flushSize = 1024;
+
+struct PartialStats {
+  float minVal = std::numeric_limits<float>::max();
+  float maxVal = std::numeric_limits<float>::lowest();
+  double sum = 0.0;
+  double sumSq = 0.0;
+
+  void Add(const PartialStats& other) {
+    minVal = std::min(minVal, other.minVal);
+    maxVal = std::max(maxVal, other.maxVal);
+    sum += other.sum;
+    sumSq += other.sumSq;
+  }
+};
+
+void ReduceScalar(const float* values, const std::size_t n,
+                  PartialStats& stats) {
+  for (std::size_t iVal = 0; iVal < n; iVal++) {
+    stats.minVal = std::min(stats.minVal, values[iVal]);
+    stats.maxVal = std::max(stats.maxVal, values[iVal]);
+    stats.sum += values[iVal];
+    stats.sumSq += static_cast<double>(values[iVal]) * values[iVal];
+  }
+}
+
+#ifdef OPENSAFT_X86_SIMD
+
+__attribute__((target("avx2"))) void
+ReduceAvx2(const float* values, const std::size_t n, PartialStats& stats) {
+  __m256 minVec = _mm256_set1_ps(stats.minVal);
+  __m256 maxVec = _mm256_set1_ps(stats.maxVal);
+  const std::size_t nVec = n - n % 8;
+  alignas(32) float lanes[8];
+  for (std::size_t first = 0; first < nVec; first += flushSize) {
+    const std::size_t last = std::min(first + flushSize, nVec);
+    __m256 sumVec = _mm256_setzero_ps();
+    __m256 sumSqVec = _mm256_setzero_ps();
+    for (std::size_t iVal = first; iVal < last; iVal += 8) {
+      const __m256 value = _mm256_loadu_ps(values + iVal);
+      minVec = _mm256_min_ps(minVec, value);
+      maxVec = _mm256_max_ps(maxVec, value);
+      sumVec = _mm256_add_ps(sumVec, value);
+      sumSqVec = _mm256_add_ps(sumSqVec, _mm256_mul_ps(value, value));
+    }
+    _mm256_store_ps(lanes, sumVec);
+    for (const float lane : lanes)
+      stats.sum += lane;
+    _mm256_store_ps(lanes, sumSqVec);
+    for (const float lane : lanes)
+      stats.sumSq += lane;
+  }
+  _mm256_store_ps(lanes, minVec);
+  stats.minVal = *std::min_element(lanes, lanes + 8);
+  _mm256_store_ps(lanes, maxVec);
+  stats.maxVal = *std::max_element(lanes, lanes + 8);
+  ReduceScalar(values + nVec, n - nVec, stats);
+}
+
+__attribute__((target("avx512f"))) void
+ReduceAvx512(const float* values, const std::size_t n, PartialStats& stats) {
+  __m512 minVec = _mm512_set1_ps(stats.minVal);
+  __m512 maxVec = _mm512_set1_ps(stats.maxVal);
+  const std::size_t nVec = n - n % 16;
+  for (std::size_t first = 0; first < nVec; first += flushSize) {
+    const std::size_t last = std::min(first + flushSize, nVec);
+    __m512 sumVec = _mm512_setzero_ps();
+    __m512 sumSqVec = _mm512_setzero_ps();
+    for (std::size_t iVal = first; iVal < last; iVal += 16) {
+      const __m512 value = _mm512_loadu_ps(values + iVal);
+      minVec = _mm512_min_ps(minVec, value);
+      maxVec = _mm512_max_ps(maxVec, value);
+      sumVec = _mm512_add_ps(sumVec, value);
+      sumSqVec = _mm512_add_ps(sumSqVec, _mm512_mul_ps(value, value));
+    }
+    stats.sum += _mm512_reduce_add_ps(sumVec);
+    stats.sumSq += _mm512_reduce_add_ps(sumSqVec);
+  }
+  stats.minVal = _mm512_reduce_min_ps(minVec);
+  stats.maxVal = _mm512_reduce_max_ps(maxVec);
+  ReduceScalar(values + nVec, n - nVec, stats);
+}
+
+#endif
+
+PartialStats Reduce(const float* values, const std::size_t n) {
+  static const SimdLevel level = DetectSimdLevel();
+  PartialStats stats;
+#ifdef OPENSAFT_X86_SIMD
+  switch (level) {
+  case SimdLevel::Avx512:
+    ReduceAvx512(values, n, stats);
+    return stats;
+  case SimdLevel::Avx2:
+    ReduceAvx2(values, n, stats);
+    return stats;
+  case SimdLevel::Scalar:
+    break;
+  }
+#endif
+  ReduceScalar(values, n, stats);
+  return stats;
+}
+
+} // namespace
+
+VolumeStats CalculateStats(std::span<const float> values,
+                           const std::size_t nBins,
+                           const unsigned int threadCount) {
+  VolumeStats result;
+  result.nValues = values.size();
+  if (values.empty())
+    return result;
+
+  // fixed chunks combined in order keep the sums independent of the threads
+  const std::size_t nChunks = (values.size() + chunkSize - 1) / chunkSize;
+  std::vector<PartialStats> partials(nChunks);
+  ParallelFor(nChunks, threadCount, [&](const std::size_t iChunk) {
+    const std::size_t first = iChunk * chunkSize;
+    const std::size_t n = std::min(chunkSize, values.size() - first);
+    partials[iChunk] = Reduce(values.data() + first, n);
+  });
+
+  PartialStats total;
+  for (const PartialStats& partial : partials)
+    total.Add(partial);
+  const double n = static_cast<double>(values.size());
+  result.minVal = total.minVal;
+  result.maxVal = total.maxVal;
+  result.absMax = std::max(std::fabs(total.minVal), std::fabs(total.maxVal));
+  result.mean = total.sum / n;
+  result.std = std::sqrt(std::max(total.sumSq / n - result.mean * result.mean,
+                                  0.0));
+  if (nBins == 0)
+    return result;
+
+  // a histogram per task, counts are exact so the split does not matter
+  const std::size_t nTasks =
+      std::min<std::size_t>(nChunks, 4 * ResolveThreadCount(threadCount));
+  std::vector<std::vector<uint64_t>> histograms(
+      nTasks, std::vector<uint64_t>(nBins, 0));
+  const float range = result.maxVal - result.minVal;
+  const float scale = (range > 0.0f) ? nBins / range : 0.0f;
+  ParallelFor(nTasks, threadCount, [&](const std::size_t iTask) {
+    const std::size_t first = values.size() * iTask / nTasks;
+    const std::size_t last = values.size() * (iTask + 1) / nTasks;
+    std::vector<uint64_t>& histogram = histograms[iTask];
+    for (std::size_t iVal = first; iVal < last; iVal++) {
+      const auto iBin =
+          static_cast<std::size_t>((values[iVal] - result.minVal) * scale);
+      histogram[std::min(iBin, nBins - 1)]++;
+    }
+  });
+
+  result.histogram.assign(nBins, 0);
+  for (const auto& histogram : histograms)
+    for (std::size_t iBin = 0; iBin < nBins; iBin++)
+      result.histogram[iBin] += histogram[iBin];
+  return result;
+}
+
+VolumeStatsCache::VolumeStatsCache(const VolumeStatsCache& other) {
+  std::lock_guard<std::mutex> lock(other.m_mutex);
+  m_stats = other.m_stats;
+  m_version = other.m_version;
+}
+
+VolumeStatsCache& VolumeStatsCache::operator=(const VolumeStatsCache& other) {
+  if (this == &other)
+    return *this;
+  std::scoped_lock lock(m_mutex, other.m_mutex);
+  m_stats = other.m_stats;
+  m_version = other.m_version;
+  return *this;
+}
+
+VolumeStats VolumeStatsCache::Get(std::span<const float> values,
+                                  const std::size_t nBins,
+                                  const uint64_t version) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  // statistics with a histogram also serve requests without one
+  if (!m_stats || m_version != version ||
+      (nBins > 0 && m_stats->histogram.size() != nBins)) {
+    m_stats = CalculateStats(values, nBins);
+    m_version = version;
+  }
+  return *m_stats;
+}
+
+} // namespace opensaft
@@ -0,0 +1,58 @@
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+#pragma once
+
+namespace opensaft {
+
+/// summary of the values of a volume, see CalculateStats
+struct VolumeStats {
+  float minVal = 0.0f;
+  float maxVal = 0.0f;
+  float absMax = 0.0f; //!< largest magnitude
+  double mean = 0.0;
+  double std = 0.0; //!< standard deviation
+  std::size_t nValues = 0;
+  std::vector<uint64_t> histogram; //!< equal bins spanning [minVal, maxVal]
+
+  /// \returns the value range covered by a bin of the histogram
+  [[nodiscard]] float get_binWidth() const {
+    return histogram.empty() ? 0.0f
+                             : (maxVal - minVal) / histogram.size();
+  }
+};
+
+/// computes the statistics of values in a single vectorized pass on up to
+/// threadCount threads (0: all), the histogram with nBins bins needs the
+/// value range and is counted in a second pass if nBins > 0. The result does
+/// not depend on the number of threads.
+[[nodiscard]] VolumeStats CalculateStats(std::span<const float> values,
+                                         const std::size_t nBins = 0,
+                                         const unsigned int threadCount = 0);
+
+/// thread safe cache of the statistics of a volume, copies share the result
+/// since they hold the same values
+class VolumeStatsCache {
+public:
+  VolumeStatsCache() = default;
+  VolumeStatsCache(const VolumeStatsCache& other);
+  VolumeStatsCache& operator=(const VolumeStatsCache& other);
+
+  /// \returns the cached statistics if they belong to this version of the
+  /// values (see Volume::get_version) and have nBins bins, otherwise
+  /// calculates and caches them
+  [[nodiscard]] VolumeStats Get(std::span<const float> values,
+                                const std::size_t nBins,
+                                const uint64_t version) const;
+
+private:
+  mutable std::mutex m_mutex;
+  mutable std::optional<VolumeStats> m_stats;
+  mutable uint64_t m_version = 0; //!< version of the values of m_stats
+};
+
+} // namespace opensaft
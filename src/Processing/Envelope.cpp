@@ -0,0 +1,128 @@
+#include "Processing/Envelope.h"
+#include "Processing/Fft.h"
+#include "Util/ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+namespace opensaft {
+
+namespace {
+
+/// number of neighbouring columns gathered at once, neighbours along x share
+/// the cache lines of each z plane
+constexpr std::size_t columnBatch = 16;
+
+/// per thread scratch of the analytic signal computation, only grows
+struct EnvelopeScratch {
+  std::vector<float> padded;
+  std::vector<std::complex<float>> spectrum;
+  std::vector<std::complex<float>> analytic;
+
+  void Reserve(const std::size_t nFft) {
+    padded.resize(std::max(padded.size(), nFft));
+    spectrum.resize(std::max(spectrum.size(), nFft / 2 + 1));
+    analytic.resize(std::max(analytic.size(), nFft));
+  }
+};
+
+/// envelope of the first n samples of scratch.padded, padded with zeros up to
+/// the plan size, written back into scratch.padded
+void AnalyticMagnitude(const RealFftPlan& realPlan, const FftPlan& plan,
+                       EnvelopeScratch& scratch, const std::size_t n) {
+  const std::size_t nFft = realPlan.size();
+  const std::span<float> padded(scratch.padded.data(), nFft);
+  const std::span<std::complex<float>> spectrum(scratch.spectrum.data(),
+                                                nFft / 2 + 1);
+  const std::span<std::complex<float>> analytic(scratch.analytic.data(),
+                                                nFft);
+  std::fill(padded.begin() + n, padded.end(), 0.0f);
+  realPlan.Forward(padded, spectrum);
+
+  // analytic signal: keep DC and nyquist, double the positive and drop the
+  // negative frequencies
+  analytic[0] = spectrum[0];
+  for (std::size_t k = 1; k < nFft / 2; k++)
+    analytic[k] = 2.0f * spectrum[k];
+  analytic[nFft / 2] = spectrum[nFft / 2];
+  std::fill(analytic.begin() + nFft / 2 + 1, analytic.end(),
+            std::complex<float>(0.0f));
+
+  plan.Inverse(analytic);
+  // sqrt(norm) skips the overflow guarding hypot of std::abs, which is not
+  // needed here and slower
+  for (std::size_t i = 0; i < n; i++)
+    padded[i] = std::sqrt(std::norm(analytic[i]));
+}
+
+/// \returns the transform length for signals of n samples, the guard
+/// interval suppresses the wrap around at both ends
+std::size_t GetEnvelopeLength(const std::size_t n) {
+  return NextPowerOfTwo(std::max<std::size_t>(n + n / 2, 2));
+}
+
+} // namespace
+
+void CalculateEnvelope(std::span<float> signal) {
+  if (signal.empty())
+    return;
+
+  const std::size_t nFft = GetEnvelopeLength(signal.size());
+  const auto realPlan = RealFftPlan::Get(nFft);
+  const auto plan = FftPlan::Get(nFft);
+  thread_local EnvelopeScratch scratch;
+  scratch.Reserve(nFft);
+  std::copy(signal.begin(), signal.end(), scratch.padded.begin());
+  AnalyticMagnitude(*realPlan, *plan, scratch, signal.size());
+  std::copy_n(scratch.padded.begin(), signal.size(), signal.begin());
+}
+
+void CalculateEnvelope(Volume& vol, const unsigned int threadCount) {
+  const std::size_t nX = vol.get_dim(0);
+  const std::size_t nY = vol.get_dim(1);
+  const std::size_t nZ = vol.get_dim(2);
+  if (vol.empty())
+    return;
+
+  const std::size_t nFft = GetEnvelopeLength(nZ);
+  const auto realPlan = RealFftPlan::Get(nFft);
+  const auto plan = FftPlan::Get(nFft);
+  const std::size_t planeSize = nX * nY;
+  float* voxels = vol.data();
+
+  ParallelFor(nY, threadCount, [&](const std::size_t iY) {
+    thread_local EnvelopeScratch scratch;
+    thread_local std::vector<float> columns;
+    scratch.Reserve(nFft);
+    columns.resize(std::max(columns.size(), columnBatch * nZ));
+
+    for (std::size_t x0 = 0; x0 < nX; x0 += columnBatch) {
+      const std::size_t nCols = std::min(columnBatch, nX - x0);
+      float* rowStart = voxels + x0 + nX * iY;
+
+      // gather the batch plane by plane into contiguous columns
+      for (std::size_t iZ = 0; iZ < nZ; iZ++) {
+        const float* src = rowStart + planeSize * iZ;
+        for (std::size_t iCol = 0; iCol < nCols; iCol++)
+          columns[iCol * nZ + iZ] = src[iCol];
+      }
+
+      for (std::size_t iCol = 0; iCol < nCols; iCol++) {
+        float* column = columns.data() + iCol * nZ;
+        std::copy_n(column, nZ, scratch.padded.begin());
+        AnalyticMagnitude(*realPlan, *plan, scratch, nZ);
+        std::copy_n(scratch.padded.begin(), nZ, column);
+      }
+
+      // scatter the envelopes back
+      for (std::size_t iZ = 0; iZ < nZ; iZ++) {
+        float* dst = rowStart + planeSize * iZ;
+        for (std::size_t iCol = 0; iCol < nCols; iCol++)
+          dst[iCol] = columns[iCol * nZ + iZ];
+      }
+    }
+  });
+}
+
+} // namespace opensaft
@@ -0,0 +1,17 @@
+#include "Memory/Volume.h"
+#include <span>
+
+#pragma once
+
+namespace opensaft {
+
+/// replaces signal by its envelope, the magnitude of the analytic signal
+/// obtained through the Hilbert transform. Thread safe, uses per thread
+/// scratch buffers.
+void CalculateEnvelope(std::span<float> signal);
+
+/// replaces every column of vol along z (depth) by its envelope, columns are
+/// distributed over threadCount threads (0: all processor units)
+void CalculateEnvelope(Volume& vol, const unsigned int threadCount = 0);
+
+} // namespace opensaft
@@ -0,0 +1,198 @@
+#include "Processing/Fft.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numbers>
+#include <stdexcept>
+
+namespace opensaft {
+
+namespace {
+
+/// plans are small compared to the data they transform and typically only a
+/// handful of lengths is used, so they are kept for the lifetime of the
+/// program
+template <typename Plan>
+std::shared_ptr<const Plan> GetCachedPlan(const std::size_t n) {
+  static std::mutex cacheMutex;
+  static std::map<std::size_t, std::shared_ptr<const Plan>> cache;
+
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  auto& plan = cache[n];
+  if (!plan)
+    plan = std::make_shared<const Plan>(n);
+  return plan;
+}
+
+std::complex<float> Twiddle(const std::size_t k, const std::size_t n) {
+  const double phi =
+      -2.0 * std::numbers::pi * static_cast<double>(k) / static_cast<double>(n);
+  return {static_cast<float>(std::cos(phi)), static_cast<float>(std::sin(phi))};
+}
+
+/// complex product without the inf / nan recovery of operator*, which turns
+/// into a library call unless compiled with fast math
+inline std::complex<float> Multiply(const std::complex<float> a,
+                                    const std::complex<float> b) {
+  return {a.real() * b.real() - a.imag() * b.imag(),
+          a.real() * b.imag() + a.imag() * b.real()};
+}
+
+} // namespace
+
+std::size_t NextPowerOfTwo(const std::size_t n) {
+  return std::bit_ceil(std::max<std::size_t>(n, 1));
+}
+
+FftPlan::FftPlan(const std::size_t n) : m_n(n) {
+  if (n == 0 || !std::has_single_bit(n))
+    throw std::invalid_argument("fft length must be a power of two");
+
+  // twiddles of each stage in one contiguous run, half - 1 + j holds
+  // exp(-2 pi i j / len) for the blocks of size len = 2 half
+  m_twiddles.resize(n - 1);
+  for (std::size_t half = 1; half < n; half *= 2)
+    for (std::size_t j = 0; j < half; j++)
+      m_twiddles[half - 1 + j] = Twiddle(j, 2 * half);
+
+  const int nBits = std::countr_zero(n);
+  m_bitReverse.resize(n);
+  for (std::size_t i = 0; i < n; i++) {
+    uint32_t reversed = 0;
+    for (int iBit = 0; iBit < nBits; iBit++)
+      reversed |= ((i >> iBit) & 1u) << (nBits - 1 - iBit);
+    m_bitReverse[i] = reversed;
+  }
+}
+
+void FftPlan::Forward(std::span<std::complex<float>> data) const {
+  Transform(data, false);
+}
+
+void FftPlan::Inverse(std::span<std::complex<float>> data) const {
+  Transform(data, true);
+  const float scale = 1.0f / static_cast<float>(m_n);
+  for (auto& value : data)
+    value *= scale;
+}
+
+void FftPlan::Transform(std::span<std::complex<float>> data,
+                        const bool inverse) const {
+  if (data.size() != m_n)
+    throw std::invalid_argument("data does not match the fft length");
+
+  for (std::size_t i = 0; i < m_n; i++) {
+    if (i < m_bitReverse[i])
+      std::swap(data[i], data[m_bitReverse[i]]);
+  }
+  if (inverse)
+    Butterflies<true>(data);
+  else
+    Butterflies<false>(data);
+}
+
+template <bool inverse>
+void FftPlan::Butterflies(std::span<std::complex<float>> data) const {
+  // first stage without multiplications
+  for (std::size_t start = 0; start + 1 < m_n; start += 2) {
+    const std::complex<float> odd = data[start + 1];
+    data[start + 1] = data[start] - odd;
+    data[start] += odd;
+  }
+
+  // iterative decimation in time, the twiddles of the stage with blocks of
+  // size len are stored contiguously starting at index half - 1
+  for (std::size_t len = 4; len <= m_n; len *= 2) {
+    const std::size_t half = len / 2;
+    const std::complex<float>* twiddles = m_twiddles.data() + half - 1;
+    for (std::size_t start = 0; start < m_n; start += len) {
+      std::complex<float>* lower = data.data() + start;
+      std::complex<float>* upper = lower + half;
+      for (std::size_t j = 0; j < half; j++) {
+        const std::complex<float> w =
+            inverse ? std::conj(twiddles[j]) : twiddles[j];
+        const std::complex<float> odd = Multiply(w, upper[j]);
+        upper[j] = lower[j] - odd;
+        lower[j] += odd;
+      }
+    }
+  }
+}
+
+std::shared_ptr<const FftPlan> FftPlan::Get(const std::size_t n) {
+  return GetCachedPlan<FftPlan>(n);
+}
+
+RealFftPlan::RealFftPlan(const std::size_t n) : m_n(n) {
+  if (n < 2 || !std::has_single_bit(n))
+    throw std::invalid_argument("real fft length must be a power of two");
+
+  m_half = FftPlan::Get(n / 2);
+  m_twiddles.resize(n / 2);
+  for (std::size_t k = 0; k < n / 2; k++)
+    m_twiddles[k] = Twiddle(k, n);
+}
+
+void RealFftPlan::Forward(std::span<const float> in,
+                          std::span<std::complex<float>> spectrum) const {
+  const std::size_t half = m_n / 2;
+  if (in.size() != m_n || spectrum.size() != half + 1)
+    throw std::invalid_argument("data does not match the fft length");
+
+  // even samples as real, odd samples as imaginary part
+  for (std::size_t k = 0; k < half; k++)
+    spectrum[k] = {in[2 * k], in[2 * k + 1]};
+  m_half->Forward(spectrum.first(half));
+
+  // untangle the spectra of even and odd samples, bins k and half - k
+  // depend on each other and are updated together
+  const std::complex<float> z0 = spectrum[0];
+  spectrum[0] = {z0.real() + z0.imag(), 0.0f};
+  spectrum[half] = {z0.real() - z0.imag(), 0.0f};
+  const std::complex<float> minusHalfI{0.0f, -0.5f};
+  for (std::size_t k = 1; k <= half / 2; k++) {
+    const std::complex<float> a = spectrum[k];
+    const std::complex<float> b = spectrum[half - k];
+    const std::complex<float> even = 0.5f * (a + std::conj(b));
+    const std::complex<float> odd = Multiply(minusHalfI, a - std::conj(b));
+    const std::complex<float> wOdd = Multiply(m_twiddles[k], odd);
+    spectrum[k] = even + wOdd;
+    spectrum[half - k] = std::conj(even - wOdd);
+  }
+}
+
+void RealFftPlan::Inverse(std::span<std::complex<float>> spectrum,
+                          std::span<float> out) const {
+  const std::size_t half = m_n / 2;
+  if (out.size() != m_n || spectrum.size() != half + 1)
+    throw std::invalid_argument("data does not match the fft length");
+
+  // inverse of the untangling in Forward
+  const float x0 = spectrum[0].real();
+  const float xHalf = spectrum[half].real();
+  spectrum[0] = {0.5f * (x0 + xHalf), 0.5f * (x0 - xHalf)};
+  const std::complex<float> i{0.0f, 1.0f};
+  for (std::size_t k = 1; k <= half / 2; k++) {
+    const std::complex<float> a = spectrum[k];
+    const std::complex<float> b = spectrum[half - k];
+    const std::complex<float> even = 0.5f * (a + std::conj(b));
+    const std::complex<float> odd =
+        Multiply(0.5f * (a - std::conj(b)), std::conj(m_twiddles[k]));
+    spectrum[k] = even + Multiply(i, odd);
+    spectrum[half - k] = std::conj(even) + Multiply(i, std::conj(odd));
+  }
+
+  m_half->Inverse(spectrum.first(half));
+  for (std::size_t k = 0; k < half; k++) {
+    out[2 * k] = spectrum[k].real();
+    out[2 * k + 1] = spectrum[k].imag();
+  }
+}
+
+std::shared_ptr<const RealFftPlan> RealFftPlan::Get(const std::size_t n) {
+  return GetCachedPlan<RealFftPlan>(n);
+}
+
+} // namespace opensaft
@@ -0,0 +1,72 @@
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#pragma once
+
+namespace opensaft {
+
+/// \returns the smallest power of two which is >= n
+[[nodiscard]] std::size_t NextPowerOfTwo(const std::size_t n);
+
+/// in place complex radix-2 FFT of a fixed power of two length with
+/// precomputed twiddle factors and bit reversal. Plans are immutable, so a
+/// single plan can be used by any number of threads at the same time.
+class FftPlan {
+public:
+  explicit FftPlan(const std::size_t n);
+
+  /// forward transform, X[k] = sum x[j] exp(-2 pi i j k / n)
+  void Forward(std::span<std::complex<float>> data) const;
+
+  /// inverse transform normalized by 1 / n
+  void Inverse(std::span<std::complex<float>> data) const;
+
+  [[nodiscard]] std::size_t size() const noexcept { return m_n; }
+
+  /// \returns a cached plan of length n, creating it on first use
+  [[nodiscard]] static std::shared_ptr<const FftPlan> Get(const std::size_t n);
+
+private:
+  void Transform(std::span<std::complex<float>> data, const bool inverse) const;
+
+  template <bool inverse>
+  void Butterflies(std::span<std::complex<float>> data) const;
+
+  std::size_t m_n;
+  std::vector<std::complex<float>> m_twiddles; //!< per stage twiddles
+  std::vector<uint32_t> m_bitReverse;          //!< permutation of the input
+};
+
+/// real to complex FFT of a power of two length n, computed through a complex
+/// FFT of length n / 2. The spectrum holds the n / 2 + 1 non negative
+/// frequencies.
+class RealFftPlan {
+public:
+  explicit RealFftPlan(const std::size_t n);
+
+  /// transforms n real samples into n / 2 + 1 frequency bins
+  void Forward(std::span<const float> in,
+               std::span<std::complex<float>> spectrum) const;
+
+  /// transforms n / 2 + 1 bins back into n samples, normalized so that
+  /// Inverse(Forward(x)) == x. The spectrum is used as workspace.
+  void Inverse(std::span<std::complex<float>> spectrum,
+               std::span<float> out) const;
+
+  [[nodiscard]] std::size_t size() const noexcept { return m_n; }
+
+  /// \returns a cached plan of length n, creating it on first use
+  [[nodiscard]] static std::shared_ptr<const RealFftPlan>
+  Get(const std::size_t n);
+
+private:
+  std::size_t m_n;
+  std::shared_ptr<const FftPlan> m_half;       //!< complex plan of n / 2
+  std::vector<std::complex<float>> m_twiddles; //!< exp(-2 pi i k / n)
+};
+
+} // namespace opensaft
@@ -0,0 +1,75 @@
+#include "Processing/FftBandpass.h"
+#include "Util/ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+namespace opensaft {
+
+FftBandpass::FftBandpass(const float fMin, const float fMax,
+                         const float sampleRate, const std::size_t nT,
+                         const float transition)
+    : m_nT(nT) {
+  if (fMax <= fMin)
+    throw std::invalid_argument("upper cutoff must exceed the lower one");
+
+  // half a signal of guard interval keeps the wrap around of the filter
+  // response out of the signal
+  m_plan = RealFftPlan::Get(NextPowerOfTwo(std::max<std::size_t>(
+      nT + nT / 2, 2)));
+  const std::size_t nFft = m_plan->size();
+  const float width = (transition > 0.0f) ? transition : 0.1f * (fMax - fMin);
+
+  // raised cosine from 0 to 1 over [edge - width, edge]
+  const auto flank = [width](const float distance) {
+    if (distance <= 0.0f)
+      return 1.0f;
+    if (distance >= width)
+      return 0.0f;
+    const float c = std::cos(0.5f * std::numbers::pi_v<float> * distance /
+                             width);
+    return c * c;
+  };
+
+  m_response.resize(nFft / 2 + 1);
+  for (std::size_t k = 0; k < m_response.size(); k++) {
+    const float f = static_cast<float>(k) * sampleRate /
+                    static_cast<float>(nFft);
+    m_response[k] = flank(fMin - f) * flank(f - fMax);
+  }
+}
+
+void FftBandpass::Apply(std::span<float> signal) const {
+  if (signal.size() != m_nT)
+    throw std::invalid_argument("signal does not match the filter length");
+
+  // per thread scratch, only grows
+  thread_local std::vector<float> padded;
+  thread_local std::vector<std::complex<float>> spectrum;
+  const std::size_t nFft = m_plan->size();
+  padded.resize(std::max(padded.size(), nFft));
+  spectrum.resize(std::max(spectrum.size(), nFft / 2 + 1));
+  const std::span<float> paddedSpan(padded.data(), nFft);
+  const std::span<std::complex<float>> spectrumSpan(spectrum.data(),
+                                                    nFft / 2 + 1);
+
+  std::copy(signal.begin(), signal.end(), paddedSpan.begin());
+  std::fill(paddedSpan.begin() + m_nT, paddedSpan.end(), 0.0f);
+  m_plan->Forward(paddedSpan, spectrumSpan);
+  for (std::size_t k = 0; k < spectrumSpan.size(); k++)
+    spectrumSpan[k] *= m_response[k];
+  m_plan->Inverse(spectrumSpan, paddedSpan);
+  std::copy(paddedSpan.begin(), paddedSpan.begin() + m_nT, signal.begin());
+}
+
+void FftBandpass::Apply(UltrasoundSignals& signals,
+                        const unsigned int threadCount) const {
+  const std::size_t nX = signals.get_nX();
+  ParallelFor(signals.get_nY(), threadCount, [&](const std::size_t iY) {
+    for (std::size_t iX = 0; iX < nX; iX++)
+      Apply(signals(iX, iY));
+  });
+}
+
+} // namespace opensaft
@@ -0,0 +1,46 @@
+#include "Memory/UltrasoundSignals.h"
+#include "Processing/Fft.h"
+#include <memory>
+#include <span>
+#include <vector>
+
+#pragma once
+
+namespace opensaft {
+
+/// zero phase bandpass applied by multiplication in the frequency domain.
+/// The passband [fMin, fMax] has unit gain and raised cosine flanks of
+/// width transition on both sides. Signals are zero padded to a power of two
+/// with a guard interval against wrap around. The plan is shared and all
+/// buffers are per thread scratch, so filtering allocates nothing once a
+/// thread has processed its first signal.
+class FftBandpass {
+public:
+  /// \param nT number of samples of the signals to filter
+  /// \param transition width of the flanks [Hz], 0 selects 10 % of the band
+  FftBandpass(const float fMin, const float fMax, const float sampleRate,
+              const std::size_t nT, const float transition = 0.0f);
+
+  /// filters a single signal of nT samples in place, thread safe
+  void Apply(std::span<float> signal) const;
+
+  /// filters all A-scans of signals on threadCount threads (0: all)
+  void Apply(UltrasoundSignals& signals,
+             const unsigned int threadCount = 0) const;
+
+  /// \returns the gain of frequency bin k of the padded transform
+  [[nodiscard]] std::span<const float> get_response() const noexcept {
+    return m_response;
+  }
+
+  [[nodiscard]] std::size_t get_nFft() const noexcept {
+    return m_plan->size();
+  }
+
+private:
+  std::size_t m_nT;
+  std::shared_ptr<const RealFftPlan> m_plan;
+  std::vector<float> m_response; //!< gain of the n / 2 + 1 bins
+};
+
+} // namespace opensaft
@@ -0,0 +1,169 @@
+#include "Processing/Preprocessor.h"
+#include "Util/ParallelFor.h"
+#include "Util/Profiler.h"
+#include "Util/Timer.h"
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <stdexcept>
+
+namespace opensaft {
+
+namespace {
+
+/// crops in into out, removes the mean and applies the optional filter
+void ProcessSignal(std::span<const float> in, std::span<float> out,
+                   const FftBandpass* filter) {
+  double sum = 0.0;
+  {
+    ProfileZone zone("crop");
+    for (std::size_t tIdx = 0; tIdx < out.size(); tIdx++) {
+      out[tIdx] = in[tIdx];
+      sum += in[tIdx];
+    }
+  }
+
+  {
+    ProfileZone zone("RemoveDC");
+    const auto mean =
+        static_cast<float>(sum / static_cast<double>(out.size()));
+    for (float& value : out)
+      value -= mean;
+  }
+
+  if (filter != nullptr) {
+    ProfileZone zone("filter");
+    filter->Apply(out);
+  }
+}
+
+} // namespace
+
+std::pair<std::size_t, std::size_t>
+Preprocessor::GetCropRange(const AcquisitionProperties& props,
+                           const std::size_t nT) const {
+  // crop is stored in ms relative to the excitation
+  const double tMin = m_settings.get_cropTMin() * 1e-3;
+  const double tMax = m_settings.get_cropTMax() * 1e-3;
+  if (tMax <= tMin)
+    return {0, nT};
+
+  // a small tolerance keeps samples lying exactly on the border despite the
+  // limited precision of the stored times
+  constexpr double tolerance = 1e-3;
+  const double first =
+      std::ceil((tMin - props.t0) * props.sampleRate - tolerance);
+  const double last =
+      std::floor((tMax - props.t0) * props.sampleRate + tolerance);
+  const auto start = static_cast<std::size_t>(
+      std::clamp(first, 0.0, static_cast<double>(nT)));
+  const auto stop = static_cast<std::size_t>(
+      std::clamp(last + 1.0, static_cast<double>(start),
+                 static_cast<double>(nT)));
+  return {start, stop};
+}
+
+AcquisitionProperties
+Preprocessor::GetOutputProperties(const AcquisitionProperties& props,
+                                  const std::size_t nT) const {
+  const auto [start, stop] = GetCropRange(props, nT);
+  AcquisitionProperties output = props;
+  output.t0 += static_cast<float>(start) / props.sampleRate;
+  return output;
+}
+
+std::optional<FftBandpass>
+Preprocessor::GetBandpass(const float sampleRate, const std::size_t nT) const {
+  if (!m_settings.get_flagBandpass() || nT == 0)
+    return std::nullopt;
+
+  // cutoffs outside of (0, nyquist) leave that side of the band open
+  const float nyquist = 0.5f * sampleRate;
+  float fMin = m_settings.get_bandpassMin();
+  float fMax = m_settings.get_bandpassMax();
+  if (fMin <= 0.0f || fMin >= nyquist)
+    fMin = 0.0f;
+  if (fMax <= 0.0f || fMax >= nyquist)
+    fMax = sampleRate;
+  return FftBandpass(fMin, fMax, sampleRate, nT);
+}
+
+void Preprocessor::ProcessRows(const UltrasoundSignals& input,
+                               const std::size_t yStart,
+                               UltrasoundSignals& output,
+                               const FftBandpass* filter) const {
+  const auto [start, stop] =
+      GetCropRange(input.get_properties(), input.get_nT());
+  const float deltaStart =
+      static_cast<float>(start) / input.get_properties().sampleRate;
+  const std::size_t nX = input.get_nX();
+
+  Timer T;
+  // a row of A-scans per task keeps the scheduling overhead negligible
+  ParallelFor(output.get_nY(), m_threadCount, [&](const std::size_t iY) {
+    for (std::size_t iX = 0; iX < nX; iX++) {
+      const std::size_t iIn = iX + nX * (iY + yStart);
+      const std::size_t iOut = iX + nX * iY;
+      ProcessSignal(input[iIn].subspan(start, stop - start), output[iOut],
+                    filter);
+      if (&input != &output) {
+        TimeSignalProperties props = input.get_signalProperties(iIn);
+        props.deltaT += deltaStart;
+        output.set_signalProperties(iOut, props);
+      }
+    }
+  });
+  T.Stop();
+
+  const double nBytes =
+      static_cast<double>(output.size() * (stop - start) * sizeof(float));
+  Log(std::format("Preprocessed {} A-scans in {:.3f} s ({:.2f} GB/s)",
+                  output.size(), T.GetElapsedTime(),
+                  nBytes / T.GetElapsedTime() * 1e-9));
+}
+
+UltrasoundSignals
+Preprocessor::Process(const UltrasoundSignals& input) const {
+  const auto [start, stop] =
+      GetCropRange(input.get_properties(), input.get_nT());
+  UltrasoundSignals output(
+      GetOutputProperties(input.get_properties(), input.get_nT()),
+      stop - start);
+  const auto filter =
+      GetBandpass(input.get_properties().sampleRate, stop - start);
+  ProcessRows(input, 0, output, filter ? &*filter : nullptr);
+  return output;
+}
+
+UltrasoundSignals Preprocessor::Process(const UltrasoundSignals& input,
+                                        const std::size_t yStart,
+                                        const std::size_t yStop) const {
+  if (yStart >= yStop || yStop > input.get_nY())
+    throw std::out_of_range("invalid row range");
+
+  const auto [start, stop] =
+      GetCropRange(input.get_properties(), input.get_nT());
+  AcquisitionProperties props =
+      GetOutputProperties(input.get_properties(), input.get_nT());
+  props.nY = yStop - yStart;
+  props.origin[1] += props.dy * static_cast<float>(yStart);
+  UltrasoundSignals output(props, stop - start);
+  const auto filter =
+      GetBandpass(input.get_properties().sampleRate, stop - start);
+  ProcessRows(input, yStart, output, filter ? &*filter : nullptr);
+  return output;
+}
+
+void Preprocessor::Process(UltrasoundSignals& signals) const {
+  const auto [start, stop] =
+      GetCropRange(signals.get_properties(), signals.get_nT());
+  if (stop - start != signals.get_nT()) {
+    signals = Process(std::as_const(signals));
+    return;
+  }
+  const auto filter =
+      GetBandpass(signals.get_properties().sampleRate, signals.get_nT());
+  ProcessRows(signals, 0, signals, filter ? &*filter : nullptr);
+}
+
+} // namespace opensaft
@@ -0,0 +1,65 @@
+#include "Memory/UltrasoundSignals.h"
+#include "Processing/FftBandpass.h"
+#include "ReconSettings.h"
+#include "Util/Logger.h"
+#include <optional>
+#include <utility>
+
+#pragma once
+
+namespace opensaft {
+
+/// fused preprocessing of the raw A-scans prior reconstruction: each A-scan
+/// is cropped to [cropTMin, cropTMax] of the settings, its DC component is
+/// removed and optionally a zero phase FFT bandpass is applied. All
+/// steps run back to back on one A-scan while it sits in the cache, the
+/// A-scans are distributed over worker threads.
+class Preprocessor : LoggingClass {
+public:
+  void SetSettings(const ReconSettings& settings) { m_settings = settings; }
+
+  /// overwrites the number of worker threads (0 uses all processor units)
+  void SetThreadCount(const unsigned int threadCount) {
+    m_threadCount = threadCount;
+  }
+
+  /// \returns the range of samples [start, stop) kept by the crop, the full
+  /// A-scan if cropping is disabled (cropTMax <= cropTMin)
+  [[nodiscard]] std::pair<std::size_t, std::size_t>
+  GetCropRange(const AcquisitionProperties& props,
+               const std::size_t nT) const;
+
+  /// \returns the properties of the raster after cropping
+  [[nodiscard]] AcquisitionProperties
+  GetOutputProperties(const AcquisitionProperties& props,
+                      const std::size_t nT) const;
+
+  /// \returns a new, preprocessed copy of input
+  [[nodiscard]] UltrasoundSignals Process(const UltrasoundSignals& input) const;
+
+  /// \returns a new, preprocessed copy of the raster rows [yStart, yStop) of
+  /// input with adjusted origin like UltrasoundSignals::ExtractRows, without
+  /// copying the raw rows first
+  [[nodiscard]] UltrasoundSignals Process(const UltrasoundSignals& input,
+                                          const std::size_t yStart,
+                                          const std::size_t yStop) const;
+
+  /// preprocesses signals in place, copies only if the crop changes the
+  /// number of samples
+  void Process(UltrasoundSignals& signals) const;
+
+  /// \returns the bandpass for A-scans of nT samples, empty if disabled
+  [[nodiscard]] std::optional<FftBandpass>
+  GetBandpass(const float sampleRate, const std::size_t nT) const;
+
+private:
+  /// crops the rows of input from yStart on into output and removes their DC
+  /// and applies the filter
+  void ProcessRows(const UltrasoundSignals& input, const std::size_t yStart,
+                   UltrasoundSignals& output, const FftBandpass* filter) const;
+
+  ReconSettings m_settings;
+  unsigned int m_threadCount = 0;
+};
+
+} // namespace opensaft
@@ -0,0 +1,85 @@
+#include "Recon/Accuracy.h"
+#include <cmath>
+#include <format>
+#include <stdexcept>
+
+namespace opensaft {
+
+namespace {
+
+/// \returns the raster position of linear index idx
+Float3 GetPosition(const Volume& vol, const std::size_t idx) {
+  const std::size_t nX = vol.get_dim(0);
+  const std::size_t nY = vol.get_dim(1);
+  return {static_cast<float>(idx % nX),
+          static_cast<float>(idx / nX % nY),
+          static_cast<float>(idx / (nX * nY))};
+}
+
+} // namespace
+
+AccuracyReport CompareVolumes(const Volume& reference, const Volume& test) {
+  if (reference.get_dims() != test.get_dims())
+    throw std::invalid_argument("volumes differ in size");
+
+  AccuracyReport report;
+  if (reference.empty())
+    return report;
+
+  // accumulate in double, the volumes easily hold 1e8 voxels
+  double sumRef = 0.0;
+  double sumTest = 0.0;
+  double sumRefSq = 0.0;
+  double sumTestSq = 0.0;
+  double sumProd = 0.0;
+  double sumDiffSq = 0.0;
+  float maxDiff = 0.0f;
+  std::size_t peakRef = 0;
+  std::size_t peakTest = 0;
+  for (std::size_t iVox = 0; iVox < reference.size(); iVox++) {
+    const double ref = reference[iVox];
+    const double val = test[iVox];
+    sumRef += ref;
+    sumTest += val;
+    sumRefSq += ref * ref;
+    sumTestSq += val * val;
+    sumProd += ref * val;
+    sumDiffSq += (ref - val) * (ref - val);
+    maxDiff = std::max(maxDiff, std::fabs(reference[iVox] - test[iVox]));
+    if (std::fabs(reference[iVox]) > std::fabs(reference[peakRef]))
+      peakRef = iVox;
+    if (std::fabs(test[iVox]) > std::fabs(test[peakTest]))
+      peakTest = iVox;
+  }
+
+  const auto n = static_cast<double>(reference.size());
+  const float peak = std::fabs(reference[peakRef]);
+  if (peak > 0.0f) {
+    report.maxError = maxDiff / peak;
+    report.peakRatio = std::fabs(test[peakTest]) / peak;
+    report.rmsError = static_cast<float>(std::sqrt(sumDiffSq / sumRefSq));
+  }
+
+  const double covariance = sumProd - sumRef * sumTest / n;
+  const double varRef = sumRefSq - sumRef * sumRef / n;
+  const double varTest = sumTestSq - sumTest * sumTest / n;
+  report.correlation =
+      (varRef > 0.0 && varTest > 0.0)
+          ? static_cast<float>(covariance / std::sqrt(varRef * varTest))
+          : 0.0f;
+
+  const Float3 shift =
+      GetPosition(reference, peakRef) - GetPosition(test, peakTest);
+  report.peakShift = std::sqrt(shift[0] * shift[0] + shift[1] * shift[1] +
+                               shift[2] * shift[2]);
+  return report;
+}
+
+std::string ToString(const AccuracyReport& report) {
+  return std::format("max error {:.2f} %, rms error {:.2f} %, correlation "
+                     "{:.4f}, peak ratio {:.3f}, peak shift {:.1f} voxels",
+                     report.maxError * 100.0f, report.rmsError * 100.0f,
+                     report.correlation, report.peakRatio, report.peakShift);
+}
+
+} // namespace opensaft
@@ -0,0 +1,24 @@
+#include "Memory/Volume.h"
+#include <string>
+
+#pragma once
+
+namespace opensaft {
+
+/// deviation of an approximate reconstruction from a reference one
+struct AccuracyReport {
+  float maxError = 0.0f;    //!< max abs difference relative to the peak
+  float rmsError = 0.0f;    //!< rms difference relative to rms reference
+  float correlation = 1.0f; //!< pearson correlation coefficient
+  float peakRatio = 1.0f;   //!< ratio of the absolute peak values
+  float peakShift = 0.0f;   //!< distance between the abs peaks [voxels]
+};
+
+/// compares test against reference voxel by voxel, both volumes must have
+/// the same dimensions
+[[nodiscard]] AccuracyReport CompareVolumes(const Volume& reference,
+                                            const Volume& test);
+
+[[nodiscard]] std::string ToString(const AccuracyReport& report);
+
+} // namespace opensaft
@@ -0,0 +1,123 @@
+#include "Recon/DelayTable.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+namespace opensaft {
+
+DelayTableKey DelayTableKey::Create(const SaftGeometry& geom) {
+  return {geom.dx, geom.dy, geom.dt,   geom.c0,  geom.fd,
+          geom.critRatio, geom.t0, geom.rMin, geom.nT};
+}
+
+// mirrors the loops of the direct voxel kernel so that both visit the
+// A-scans in the same order and produce bitwise identical sums
+DelayTable::DelayTable(const SaftGeometry& geom)
+    : m_key(DelayTableKey::Create(geom)) {
+  m_zOffsets.reserve(geom.nT + 1);
+  m_signs.reserve(geom.nT);
+  m_zOffsets.push_back(0);
+
+  for (int zIm = 0; zIm < geom.nT; zIm++) {
+    const float zDepth =
+        (geom.t0 + geom.dt * static_cast<float>(zIm)) * geom.c0;
+    const float deltaZ = zDepth - geom.fd;
+    const float absDeltaZ = std::fabs(deltaZ);
+    const int signMultip = (zDepth >= geom.fd) ? 1 : -1;
+    m_signs.push_back(signMultip);
+
+    const int xConsider =
+        static_cast<int>(geom.critRatio * absDeltaZ / geom.dx);
+    const int yConsider =
+        static_cast<int>(geom.critRatio * absDeltaZ / geom.dy);
+    for (int iY = -yConsider; iY <= yConsider; iY++) {
+      const float yRel = geom.dy * static_cast<float>(iY);
+      for (int iX = -xConsider; iX <= xConsider; iX++) {
+        const float xRel = geom.dx * static_cast<float>(iX);
+        const float rDist = std::sqrt(xRel * xRel + yRel * yRel);
+        if ((rDist <= geom.critRatio * absDeltaZ) || (rDist < geom.rMin)) {
+          const float distTot = std::sqrt(rDist * rDist + deltaZ * deltaZ);
+          const int deltaT =
+              static_cast<int>(distTot / geom.c0 / geom.dt + 0.5f);
+          const int tIdx = geom.idxFoc + deltaT * signMultip;
+          if ((tIdx >= 0) && (tIdx < geom.nT)) {
+            m_entries.push_back({iX, iY, tIdx});
+            m_maxOffsetX = std::max(m_maxOffsetX, std::abs(iX));
+            m_maxOffsetY = std::max(m_maxOffsetY, std::abs(iY));
+          }
+        }
+      }
+    }
+    m_zOffsets.push_back(m_entries.size());
+  }
+
+  BuildBlocks();
+}
+
+void DelayTable::BuildBlocks() {
+  const int nT = static_cast<int>(m_signs.size());
+  const int nBlocks = (nT + DelayBlockWidth - 1) / DelayBlockWidth;
+  m_blockOffsets.reserve(nBlocks + 1);
+  m_blockOffsets.push_back(0);
+
+  for (int iBlock = 0; iBlock < nBlocks; iBlock++) {
+    // merge the offsets of all depths in the block, keeping the y then x
+    // order so every lane sums up its A-scans in the same sequence as the
+    // per depth kernel
+    std::vector<std::pair<int, int>> offsets;
+    const int zStart = iBlock * DelayBlockWidth;
+    const int zStop = std::min(zStart + DelayBlockWidth, nT);
+    for (int zIm = zStart; zIm < zStop; zIm++) {
+      for (const auto& entry : get_entries(zIm))
+        offsets.emplace_back(entry.offsetY, entry.offsetX);
+    }
+    std::sort(offsets.begin(), offsets.end());
+    offsets.erase(std::unique(offsets.begin(), offsets.end()), offsets.end());
+
+    const std::size_t iFirst = m_blocks.size();
+    for (const auto& [offsetY, offsetX] : offsets) {
+      DelayBlockEntry block{offsetX, offsetY, {}};
+      std::fill(std::begin(block.tIdx), std::end(block.tIdx), -1);
+      m_blocks.push_back(block);
+    }
+
+    for (int zIm = zStart; zIm < zStop; zIm++) {
+      for (const auto& entry : get_entries(zIm)) {
+        const auto it = std::lower_bound(
+            offsets.begin(), offsets.end(),
+            std::make_pair(entry.offsetY, entry.offsetX));
+        m_blocks[iFirst + (it - offsets.begin())].tIdx[zIm - zStart] =
+            entry.tIdx;
+      }
+    }
+    m_blockOffsets.push_back(m_blocks.size());
+  }
+}
+
+std::shared_ptr<const DelayTable> DelayTable::Get(const SaftGeometry& geom) {
+  // the last few tables are kept alive, a batch of scans acquired with the
+  // same system usually shares a single geometry
+  constexpr std::size_t cacheSize = 4;
+  static std::mutex cacheMutex;
+  static std::vector<std::shared_ptr<const DelayTable>> cache;
+
+  const DelayTableKey key = DelayTableKey::Create(geom);
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  const auto it = std::find_if(cache.begin(), cache.end(),
+                               [&key](const auto& table) {
+                                 return table->get_key() == key;
+                               });
+  if (it != cache.end()) {
+    // move the hit to the front so it is evicted last
+    std::rotate(cache.begin(), it, it + 1);
+    return cache.front();
+  }
+
+  auto table = std::make_shared<const DelayTable>(geom);
+  cache.insert(cache.begin(), table);
+  if (cache.size() > cacheSize)
+    cache.pop_back();
+  return table;
+}
+
+} // namespace opensaft
@@ -0,0 +1,105 @@
+#include "Recon/SaftGeometry.h"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#pragma once
+
+namespace opensaft {
+
+/// all quantities the delays of a reconstruction depend on, two geometries
+/// with the same key share the same table
+struct DelayTableKey {
+  float dx = 0.0f;
+  float dy = 0.0f;
+  float dt = 0.0f;
+  float c0 = 0.0f;
+  float fd = 0.0f;
+  float critRatio = 0.0f;
+  float t0 = 0.0f;
+  float rMin = 0.0f;
+  int nT = 0;
+
+  bool operator==(const DelayTableKey& other) const = default;
+
+  static DelayTableKey Create(const SaftGeometry& geom);
+};
+
+/// lateral offset of a contributing A-scan and the time index we sample it at
+struct DelayEntry {
+  int32_t offsetX; //!< offset along x relative to the voxel [A-scans]
+  int32_t offsetY; //!< offset along y relative to the voxel [A-scans]
+  int32_t tIdx;    //!< time index within the contributing A-scan
+};
+
+/// number of consecutive depths the vectorized kernels process at once
+constexpr int DelayBlockWidth = 16;
+
+/// lateral offset of a contributing A-scan together with the time indices
+/// for a block of consecutive depths, -1 marks depths it does not contribute to
+struct DelayBlockEntry {
+  int32_t offsetX;                  //!< offset along x [A-scans]
+  int32_t offsetY;                  //!< offset along y [A-scans]
+  int32_t tIdx[DelayBlockWidth]; //!< time index per depth of the block
+};
+
+/// for each depth the list of A-scans within the aperture cone and their
+/// delays, so the voxel kernel reduces to a gather-and-add
+class DelayTable {
+public:
+  explicit DelayTable(const SaftGeometry& geom);
+
+  /// \returns all contributing offsets for depth zIm, ordered by y then x
+  [[nodiscard]] std::span<const DelayEntry> get_entries(const int zIm) const {
+    return {m_entries.data() + m_zOffsets[zIm],
+            m_entries.data() + m_zOffsets[zIm + 1]};
+  }
+
+  /// \returns the entries of the depths [iBlock, iBlock + 1) *
+  /// DelayBlockWidth, ordered by y then x like the entries of a single depth
+  [[nodiscard]] std::span<const DelayBlockEntry>
+  get_blockEntries(const int iBlock) const {
+    return {m_blocks.data() + m_blockOffsets[iBlock],
+            m_blocks.data() + m_blockOffsets[iBlock + 1]};
+  }
+
+  /// \returns number of depth blocks covering all nT depths
+  [[nodiscard]] int get_nBlocks() const noexcept {
+    return static_cast<int>(m_blockOffsets.size()) - 1;
+  }
+
+  /// \returns 1 if zIm lies beyond the focal point, -1 otherwise
+  [[nodiscard]] int get_sign(const int zIm) const { return m_signs[zIm]; }
+
+  /// \returns largest lateral offset found in the table along x and y
+  [[nodiscard]] int get_maxOffsetX() const noexcept { return m_maxOffsetX; }
+  [[nodiscard]] int get_maxOffsetY() const noexcept { return m_maxOffsetY; }
+
+  [[nodiscard]] const DelayTableKey& get_key() const noexcept { return m_key; }
+
+  /// \returns total number of entries over all depths
+  [[nodiscard]] std::size_t get_nEntries() const noexcept {
+    return m_entries.size();
+  }
+
+  /// \returns a table matching the geometry, reusing a previously built one
+  /// if the geometry of an earlier reconstruction was the same
+  [[nodiscard]] static std::shared_ptr<const DelayTable>
+  Get(const SaftGeometry& geom);
+
+private:
+  /// regroups the per depth entries into blocks of consecutive depths
+  void BuildBlocks();
+
+  DelayTableKey m_key;
+  std::vector<DelayEntry> m_entries;  //!< entries of all depths
+  std::vector<std::size_t> m_zOffsets; //!< first entry per depth, size nT + 1
+  std::vector<int> m_signs;           //!< far / close field sign per depth
+  std::vector<DelayBlockEntry> m_blocks;   //!< entries of all depth blocks
+  std::vector<std::size_t> m_blockOffsets; //!< first entry per block
+  int m_maxOffsetX = 0;
+  int m_maxOffsetY = 0;
+};
+
+} // namespace opensaft
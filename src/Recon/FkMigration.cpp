@@ -0,0 +1,271 @@
+#include "Recon/FkMigration.h"
+#include "Processing/Fft.h"
+#include "Util/ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace opensaft {
+
+namespace {
+
+/// number of neighbouring lines gathered at once for the strided transforms
+constexpr std::size_t lineBatch = 16;
+
+/// \returns the signed frequency of bin k of a transform of length n
+int SignedBin(const std::size_t k, const std::size_t n) {
+  return (k <= n / 2) ? static_cast<int>(k)
+                      : static_cast<int>(k) - static_cast<int>(n);
+}
+
+/// transforms the strided lines of a buffer: for each of nOuter blocks
+/// starting outerStride apart, the nInner consecutive elements each start a
+/// line of plan.size() elements which lie stride apart. Batches of
+/// neighbouring lines are gathered into contiguous scratch memory.
+void TransformLines(std::vector<std::complex<float>>& data,
+                    const FftPlan& plan, const std::size_t nOuter,
+                    const std::size_t outerStride, const std::size_t nInner,
+                    const std::size_t stride, const bool inverse,
+                    const unsigned int threadCount) {
+  const std::size_t n = plan.size();
+  ParallelFor(nOuter, threadCount, [&](const std::size_t iOuter) {
+    thread_local std::vector<std::complex<float>> lines;
+    lines.resize(std::max(lines.size(), lineBatch * n));
+    std::complex<float>* block = data.data() + iOuter * outerStride;
+
+    for (std::size_t first = 0; first < nInner; first += lineBatch) {
+      const std::size_t nLines = std::min(lineBatch, nInner - first);
+      for (std::size_t i = 0; i < n; i++)
+        for (std::size_t iLine = 0; iLine < nLines; iLine++)
+          lines[iLine * n + i] = block[first + iLine + i * stride];
+
+      for (std::size_t iLine = 0; iLine < nLines; iLine++) {
+        const std::span<std::complex<float>> line(lines.data() + iLine * n,
+                                                  n);
+        if (inverse)
+          plan.Inverse(line);
+        else
+          plan.Forward(line);
+      }
+
+      for (std::size_t i = 0; i < n; i++)
+        for (std::size_t iLine = 0; iLine < nLines; iLine++)
+          block[first + iLine + i * stride] = lines[iLine * n + i];
+    }
+  });
+}
+
+/// \returns the bytes of the transform buffer of the padded dimensions
+std::size_t GetBufferBytes(const Size3& padded) {
+  return padded[0] * padded[1] * (padded[2] / 2 + 1) *
+         sizeof(std::complex<float>);
+}
+
+/// \returns the number of samples from the focus to the end of the A-scans,
+/// including those before the first recorded one if the focus lies before it
+int GetSamplesAfter(const SaftGeometry& geom) {
+  return std::max(geom.nT - geom.idxFoc, 0);
+}
+
+/// \returns the number of samples from the focus back to the first one
+int GetSamplesBefore(const SaftGeometry& geom) {
+  return std::max(geom.idxFoc + 1, 0);
+}
+
+} // namespace
+
+FkMigration::FkMigration(const SaftGeometry& geom)
+    : m_geom(geom), m_padded(GetPaddedDims(GetSamplesAfter(geom))) {}
+
+std::size_t FkMigration::get_bufferBytes() const {
+  return std::max(GetBufferBytes(GetPaddedDims(GetSamplesAfter(m_geom))),
+                  GetBufferBytes(GetPaddedDims(GetSamplesBefore(m_geom))));
+}
+
+Size3 FkMigration::GetPaddedDims(const int nSamples) const {
+  // the deepest voxel defines the widest lateral reach of the cone, which
+  // must not wrap around into the raster
+  const float maxDist = static_cast<float>(nSamples) * m_geom.dt * m_geom.c0;
+  const auto haloX = static_cast<std::size_t>(
+      std::ceil(m_geom.critRatio * maxDist / m_geom.dx));
+  const auto haloY = static_cast<std::size_t>(
+      std::ceil(m_geom.critRatio * maxDist / m_geom.dy));
+  const auto nX = static_cast<std::size_t>(m_geom.nX);
+  const auto nY = static_cast<std::size_t>(m_geom.nY);
+  // migration moves energy towards the focal plane only, so a few samples
+  // of guard interval suffice against the wrap around of the interpolation
+  constexpr std::size_t guard = 16;
+  Size3 padded;
+  padded[0] = NextPowerOfTwo(nX + std::min(haloX, nX));
+  padded[1] = NextPowerOfTwo(nY + std::min(haloY, nY));
+  padded[2] = NextPowerOfTwo(static_cast<std::size_t>(nSamples) + guard);
+  return padded;
+}
+
+void FkMigration::Reconstruct(const UltrasoundSignals& signals,
+                              const Size3& start, const Size3& stop,
+                              Volume& output, const unsigned int threadCount,
+                              const ProgressCallback& progress) const {
+  if (output.get_dims() != stop - start)
+    throw std::invalid_argument("output does not match the region");
+
+  // a raster too large for the transforms fails here rather than with a
+  // bad_alloc or by swapping halfway through
+  const std::size_t bufferBytes = get_bufferBytes();
+  const auto physicalBytes = static_cast<std::size_t>(sysconf(_SC_PHYS_PAGES)) *
+                             static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  if (bufferBytes > physicalBytes)
+    throw std::runtime_error(std::format(
+        "f-k migration needs {} MB for its transforms, but only {} MB of "
+        "memory are installed",
+        bufferBytes >> 20, physicalBytes >> 20));
+
+  std::vector<std::complex<float>> data;
+  std::fill(output.begin(), output.end(), 0.0f);
+
+  // the focus sample belongs to the far field, like in the delay-and-sum
+  if (GetSamplesAfter(m_geom) > 0)
+    MigrateHalf(signals, 1, GetSamplesAfter(m_geom), start, stop, output,
+                data, threadCount);
+  if (progress)
+    progress(output.size() / 2);
+
+  if (GetSamplesBefore(m_geom) > 1)
+    MigrateHalf(signals, -1, GetSamplesBefore(m_geom), start, stop, output,
+                data, threadCount);
+  if (progress)
+    progress(output.size() - output.size() / 2);
+}
+
+void FkMigration::MigrateHalf(const UltrasoundSignals& signals,
+                              const int direction, const int nSamples,
+                              const Size3& start, const Size3& stop,
+                              Volume& output,
+                              std::vector<std::complex<float>>& data,
+                              const unsigned int threadCount) const {
+  const Size3 padded = GetPaddedDims(nSamples);
+  const std::size_t nXp = padded[0];
+  const std::size_t nYp = padded[1];
+  const std::size_t nTp = padded[2];
+  // real input, only the non negative temporal frequencies are stored
+  const std::size_t nF = nTp / 2 + 1;
+  const auto nX = static_cast<std::size_t>(m_geom.nX);
+  const auto nY = static_cast<std::size_t>(m_geom.nY);
+  const int nT = m_geom.nT;
+  const int idxFoc = m_geom.idxFoc;
+  // sample i of a line lies i samples after (or before) the focus, the
+  // focus itself is part of the far field only
+  const int iFirst = (direction > 0) ? std::max(0, -idxFoc) : 1;
+  const int iStop = std::min(nSamples, static_cast<int>(nTp));
+  data.assign(nXp * nYp * nF, std::complex<float>(0.0f));
+  const auto frequencyLine = [&](const std::size_t iX, const std::size_t iY) {
+    return data.data() + nF * (iX + nXp * iY);
+  };
+
+  // copy the raster into the padded buffer and transform along time, the
+  // frequency is the fastest axis
+  const auto planT = RealFftPlan::Get(nTp);
+  ParallelFor(nY, threadCount, [&](const std::size_t iY) {
+    thread_local std::vector<float> samples;
+    samples.resize(std::max(samples.size(), nTp));
+    const std::span<float> line(samples.data(), nTp);
+    for (std::size_t iX = 0; iX < nX; iX++) {
+      std::fill(line.begin(), line.end(), 0.0f);
+      const float* sig = signals.get_psignal(iX + nX * iY);
+      for (int i = iFirst; i < iStop; i++) {
+        const int tIdx = idxFoc + direction * i;
+        if (tIdx >= 0 && tIdx < nT)
+          line[i] = sig[tIdx];
+      }
+      planT->Forward(line, {frequencyLine(iX, iY), nF});
+    }
+  });
+
+  // lateral transforms, lines along x and y are strided. Rows beyond the
+  // raster are all zero and stay zero along x.
+  TransformLines(data, *FftPlan::Get(nXp), nY, nXp * nF, nF, nF, false,
+                 threadCount);
+  TransformLines(data, *FftPlan::Get(nYp), nXp, nF, nF, nF * nXp, false,
+                 threadCount);
+
+  // stolt mapping: the wavenumber kz of the image is fed by the temporal
+  // frequency f = c sqrt(kx^2 + ky^2 + kz^2), both expressed in bins of the
+  // time axis since dz = c dt. The migration inverts a spherical wave with
+  // 1 / r spreading and a time derivative, whereas the delay-and-sum adds up
+  // the samples of the aperture: the filter i / kz undoes the derivative
+  // (and the phase shift of the migrated pulse), the spreading is
+  // compensated per depth below. kz = 0 is skipped, DC carries no echo.
+  const float dz = m_geom.dt * m_geom.c0;
+  const float binScale = static_cast<float>(nTp) * dz;
+  const auto maxBin = static_cast<float>(nTp / 2);
+  ParallelFor(nYp, threadCount, [&](const std::size_t iKy) {
+    thread_local std::vector<std::complex<float>> spectrum;
+    spectrum.resize(std::max(spectrum.size(), nF));
+    const float fy = static_cast<float>(SignedBin(iKy, nYp)) /
+                     (static_cast<float>(nYp) * m_geom.dy);
+    for (std::size_t iKx = 0; iKx < nXp; iKx++) {
+      const float fx = static_cast<float>(SignedBin(iKx, nXp)) /
+                       (static_cast<float>(nXp) * m_geom.dx);
+      const float lateral = binScale * std::sqrt(fx * fx + fy * fy);
+      std::complex<float>* line = frequencyLine(iKx, iKy);
+      std::copy(line, line + nF, spectrum.begin());
+
+      line[0] = 0.0f;
+      for (std::size_t iKz = 1; iKz < nF; iKz++) {
+        const auto kz = static_cast<float>(iKz);
+        const float f = std::sqrt(kz * kz + lateral * lateral);
+        // outside of the opening angle of the transducer or the band
+        if (lateral > m_geom.critRatio * kz || f >= maxBin) {
+          line[iKz] = 0.0f;
+          continue;
+        }
+
+        const float lower = std::floor(f);
+        const float weight = f - lower;
+        const auto iLower = static_cast<std::size_t>(lower);
+        const float jacobian = (f > 0.0f) ? kz / f : 1.0f;
+        line[iKz] = std::complex<float>(0.0f, jacobian * binScale / kz) *
+                    ((1.0f - weight) * spectrum[iLower] +
+                     weight * spectrum[iLower + 1]);
+      }
+    }
+  });
+
+  // back to space, only the lines covering the raster are needed
+  TransformLines(data, *FftPlan::Get(nYp), nXp, nF, nF, nF * nXp, true,
+                 threadCount);
+  TransformLines(data, *FftPlan::Get(nXp), nY, nXp * nF, nF, nF, true,
+                 threadCount);
+
+  const Size3 dims = stop - start;
+  const std::size_t planeSize = dims[0] * dims[1];
+  // the delay-and-sum adds the pi (critRatio r)^2 / (dx dy) A-scans of the
+  // aperture at distance r from the focus, the filtered migration yields
+  // pi critRatio^2 r times the pulse, so the gain of r / (dx dy) matches
+  // both. This uses the full cone rather than the count of the DelayTable,
+  // which is clipped at the raster edges the migration sees anyway. The
+  // focal plane gets the gain of its neighbours.
+  const float gain = dz / (m_geom.dx * m_geom.dy);
+  float* voxels = output.data();
+  ParallelFor(dims[1], threadCount, [&](const std::size_t yOut) {
+    thread_local std::vector<float> samples;
+    samples.resize(std::max(samples.size(), nTp));
+    const std::span<float> line(samples.data(), nTp);
+    for (std::size_t xOut = 0; xOut < dims[0]; xOut++) {
+      planT->Inverse({frequencyLine(xOut + start[0], yOut + start[1]), nF},
+                     line);
+      float* column = voxels + xOut + dims[0] * yOut;
+      for (std::size_t zOut = 0; zOut < dims[2]; zOut++) {
+        const int i =
+            direction * (static_cast<int>(zOut + start[2]) - idxFoc);
+        if (i >= iFirst && i < iStop)
+          column[planeSize * zOut] =
+              static_cast<float>(direction * std::max(i, 1)) * gain * line[i];
+      }
+    }
+  });
+}
+
+} // namespace opensaft
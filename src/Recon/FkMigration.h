@@ -0,0 +1,64 @@
+#include "Memory/UltrasoundSignals.h"
+#include "Memory/Volume.h"
+#include "Recon/SaftGeometry.h"
+#include <complex>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#pragma once
+
+namespace opensaft {
+
+/// reconstruction in the frequency-wavenumber domain (Stolt migration). The
+/// focal point of the transducer acts as a plane of virtual detectors: the
+/// samples after the focus are migrated downwards, the samples before it are
+/// reversed in time, migrated and mirrored above the focal plane with the
+/// negative sign of the close field. Each half costs three 3D FFTs of the
+/// zero padded raster plus one interpolation per wavenumber, independent of
+/// the aperture. Components steeper than the opening angle of the transducer
+/// are discarded, so the result covers the same cone as the delay-and-sum.
+/// The output is scaled to the gain of the delay-and-sum, which sums the
+/// A-scans of the aperture. Neither coherence factor weighting nor rMin
+/// apply to this engine.
+class FkMigration {
+public:
+  explicit FkMigration(const SaftGeometry& geom);
+
+  /// called with the number of finished output voxels
+  using ProgressCallback = std::function<void(uint64_t)>;
+
+  /// reconstructs the raster voxels [start, stop) of signals into output,
+  /// which must have the dimensions stop - start. The full raster is
+  /// migrated in any case.
+  void Reconstruct(const UltrasoundSignals& signals, const Size3& start,
+                   const Size3& stop, Volume& output,
+                   const unsigned int threadCount = 0,
+                   const ProgressCallback& progress = nullptr) const;
+
+  /// \returns the padded size of the transforms along x, y and time of the
+  /// far field, the close field usually needs less
+  [[nodiscard]] Size3 get_paddedDims() const noexcept { return m_padded; }
+
+  /// \returns the bytes of the complex transform buffer, which holds
+  /// nX' * nY' * (nT' / 2 + 1) values of the larger half. Reconstruct throws
+  /// a std::runtime_error if it exceeds the physical memory.
+  [[nodiscard]] std::size_t get_bufferBytes() const;
+
+private:
+  /// \returns the transform lengths for a half of nSamples samples
+  [[nodiscard]] Size3 GetPaddedDims(const int nSamples) const;
+
+  /// migrates the nSamples samples following (direction 1) or preceding
+  /// (direction -1) the focus into the depths on that side of the focal
+  /// plane, data is the padded transform buffer
+  void MigrateHalf(const UltrasoundSignals& signals, const int direction,
+                   const int nSamples, const Size3& start, const Size3& stop,
+                   Volume& output, std::vector<std::complex<float>>& data,
+                   const unsigned int threadCount) const;
+
+  SaftGeometry m_geom;
+  Size3 m_padded; //!< transform lengths along x, y and time (far field)
+};
+
+} // namespace opensaft
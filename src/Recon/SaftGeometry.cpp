@@ -0,0 +1,79 @@
+#include "Recon/SaftGeometry.h"
+#include <algorithm>
+#include <cmath>
+
+namespace opensaft {
+
+SaftGeometry SaftGeometry::Create(const UltrasoundSignals& signals,
+                                  const ReconSettings& settings,
+                                  const Transducer& transducer) {
+  return Create(signals.get_properties(), signals.get_nT(), settings,
+                transducer);
+}
+
+SaftGeometry SaftGeometry::Create(const AcquisitionProperties& props,
+                                  const std::size_t nT,
+                                  const ReconSettings& settings,
+                                  const Transducer& transducer) {
+  SaftGeometry geom;
+  geom.nT = static_cast<int>(nT);
+  geom.nX = static_cast<int>(props.nX);
+  geom.nY = static_cast<int>(props.nY);
+  geom.dt = 1.0f / props.sampleRate;
+  geom.dx = props.dx;
+  geom.dy = props.dy;
+  geom.t0 = props.t0;
+  geom.origin = props.origin;
+
+  // in pulse echo mode the wave travels the distance twice
+  geom.c0 = settings.get_flagUs() ? 0.5f * settings.get_sos()
+                                  : settings.get_sos();
+  geom.fd = transducer.get_focalDistance() * 1e-3f;
+  geom.rMin = settings.get_rMin();
+  geom.flagCoherenceW = settings.get_flagCoherenceW();
+
+  // opening angle of the transducer defines the cone we reconstruct in
+  const float fdMm = transducer.get_focalDistance();
+  const float rAperture = transducer.get_rAperture();
+  const float deltaZT = std::sqrt(fdMm * fdMm - rAperture * rAperture);
+  geom.critRatio = rAperture / deltaZT;
+
+  // rounded with floor, the focus lies before the first sample if the
+  // A-scans were cropped
+  geom.idxFoc = static_cast<int>(
+      std::floor((geom.fd / geom.c0 - geom.t0) / geom.dt + 0.5f));
+  return geom;
+}
+
+Float3 SaftGeometry::GetCenter(const Size3& start, const Size3& stop) const {
+  // position of the first voxel, depth is counted from the transducer
+  const Float3 res = GetVoxelSize();
+  const Float3 first{origin[0] + res[0] * start[0],
+                     origin[1] + res[1] * start[1],
+                     origin[2] + (t0 + dt * start[2]) * c0};
+  const Size3 dims = stop - start;
+  return first + Float3{res[0] * (dims[0] - 1), res[1] * (dims[1] - 1),
+                        res[2] * (dims[2] - 1)} *
+                     0.5f;
+}
+
+double SaftGeometry::EstimateApertureSize(const int zIm) const {
+  const float absDeltaZ = std::fabs((t0 + dt * static_cast<float>(zIm)) * c0 -
+                                    fd);
+  const int xConsider = static_cast<int>(critRatio * absDeltaZ / dx);
+  const int yConsider = static_cast<int>(critRatio * absDeltaZ / dy);
+  return static_cast<double>(std::min(2 * xConsider + 1, nX)) *
+         static_cast<double>(std::min(2 * yConsider + 1, nY));
+}
+
+double SaftGeometry::EstimateCost(const Tile& tile) const {
+  double costColumn = 0.0;
+  for (std::size_t zIm = tile.start[2]; zIm < tile.stop[2]; zIm++)
+    costColumn += EstimateApertureSize(static_cast<int>(zIm));
+
+  const std::size_t nColumns =
+      (tile.stop[0] - tile.start[0]) * (tile.stop[1] - tile.start[1]);
+  return costColumn * static_cast<double>(nColumns);
+}
+
+} // namespace opensaft
@@ -0,0 +1,52 @@
+#include "Memory/UltrasoundSignals.h"
+#include "ReconSettings.h"
+#include "Transducer.h"
+#include "Util/TileScheduler.h"
+
+#pragma once
+
+namespace opensaft {
+
+/// geometry of a delay-and-sum reconstruction in SI units, derived once per
+/// run from the input raster, the reconstruction settings and the transducer
+struct SaftGeometry {
+  int nT = 0;                 //!< number of time samples / voxels along z
+  int nX = 0;                 //!< number of A-scans / voxels along x
+  int nY = 0;                 //!< number of A-scans / voxels along y
+  float dt = 1.0f;            //!< temporal resolution [s]
+  float dx = 1.0f;            //!< step size along x [m]
+  float dy = 1.0f;            //!< step size along y [m]
+  float t0 = 0.0f;            //!< time of the first sample [s]
+  float c0 = 1.0f;            //!< speed of sound used for the delays [m/s]
+  float fd = 0.0f;            //!< focal distance of the transducer [m]
+  float critRatio = 0.0f;     //!< max ratio of lateral to axial distance
+  float rMin = 0.0f;          //!< lateral radius always considered [m]
+  int idxFoc = 0;             //!< time index of the focal point
+  bool flagCoherenceW = true; //!< apply coherence factor weighting
+  Float3 origin{0.0f};        //!< position of the first A-scan [m]
+
+  /// \returns the size of a reconstructed voxel along x, y and z [m]
+  [[nodiscard]] Float3 GetVoxelSize() const { return {dx, dy, dt * c0}; }
+
+  /// \returns the center of the volume spanning the voxels [start, stop)
+  [[nodiscard]] Float3 GetCenter(const Size3& start, const Size3& stop) const;
+
+  /// \returns the number of A-scans summed up for a voxel at depth index zIm
+  [[nodiscard]] double EstimateApertureSize(const int zIm) const;
+
+  /// \returns the estimated cost of a tile, proportional to the number of
+  /// A-scans visited while reconstructing it
+  [[nodiscard]] double EstimateCost(const Tile& tile) const;
+
+  static SaftGeometry Create(const UltrasoundSignals& signals,
+                             const ReconSettings& settings,
+                             const Transducer& transducer);
+
+  /// same as above for a raster which is not loaded (yet)
+  static SaftGeometry Create(const AcquisitionProperties& props,
+                             const std::size_t nT,
+                             const ReconSettings& settings,
+                             const Transducer& transducer);
+};
+
+} // namespace opensaft
@@ -0,0 +1,83 @@
+#include "Recon/SaftKernel.h"
+#include <algorithm>
+
+namespace opensaft {
+
+// delay-and-sum over all A-scans within the cone defined by the transducer
+// aperture, see Saft.cu for the equivalent GPU kernel
+float CalculateVoxelDirect(const SaftGeometry& geom,
+                           const UltrasoundSignals& signals, const Size3& idx) {
+  const int xIm = static_cast<int>(idx[0]);
+  const int yIm = static_cast<int>(idx[1]);
+  const int zIm = static_cast<int>(idx[2]);
+
+  // depth of reconstructed point and its distance to the focal point
+  const float zDepth = (geom.t0 + geom.dt * static_cast<float>(zIm)) * geom.c0;
+  const float deltaZ = zDepth - geom.fd;
+  const float absDeltaZ = std::fabs(deltaZ);
+
+  // 1 if far field, -1 if close field
+  const int signMultip = (zDepth >= geom.fd) ? 1 : -1;
+
+  // limit reconstruction range to a local subfield
+  const int xConsider = static_cast<int>(geom.critRatio * absDeltaZ / geom.dx);
+  const int yConsider = static_cast<int>(geom.critRatio * absDeltaZ / geom.dy);
+  const int xStartIdx = std::max(xIm - xConsider, 0);
+  const int yStartIdx = std::max(yIm - yConsider, 0);
+  const int xStopIdx = std::min(xIm + xConsider, geom.nX - 1);
+  const int yStopIdx = std::min(yIm + yConsider, geom.nY - 1);
+
+  float rfsaft = 0.0f;    // coherent saft sum
+  float rfsaftabs = 0.0f; // incoherent saft sum
+  int nElem = 0;
+  for (int iY = yStartIdx; iY <= yStopIdx; iY++) {
+    const float yRel = geom.dy * static_cast<float>(iY - yIm);
+    for (int iX = xStartIdx; iX <= xStopIdx; iX++) {
+      const float xRel = geom.dx * static_cast<float>(iX - xIm);
+      const float rDist = std::sqrt(xRel * xRel + yRel * yRel);
+      if ((rDist <= geom.critRatio * absDeltaZ) || (rDist < geom.rMin)) {
+        // calculate distance, delay time, and index
+        const float distTot = std::sqrt(rDist * rDist + deltaZ * deltaZ);
+        const int deltaT = static_cast<int>(distTot / geom.c0 / geom.dt + 0.5f);
+        const int tIdx = geom.idxFoc + deltaT * signMultip;
+
+        if ((tIdx >= 0) && (tIdx < geom.nT)) {
+          const float value = signals.get_psignal(iX + geom.nX * iY)[tIdx];
+          rfsaft += value;
+          rfsaftabs += std::fabs(value);
+          nElem++;
+        }
+      }
+    }
+  }
+
+  return FinalizeVoxel(rfsaft, rfsaftabs, nElem, signMultip,
+                       geom.flagCoherenceW);
+}
+
+float CalculateVoxel(const SaftGeometry& geom, const DelayTable& table,
+                     const UltrasoundSignals& signals, const Size3& idx) {
+  const int xIm = static_cast<int>(idx[0]);
+  const int yIm = static_cast<int>(idx[1]);
+  const int zIm = static_cast<int>(idx[2]);
+
+  float rfsaft = 0.0f;    // coherent saft sum
+  float rfsaftabs = 0.0f; // incoherent saft sum
+  int nElem = 0;
+  for (const DelayEntry& entry : table.get_entries(zIm)) {
+    const int iX = xIm + entry.offsetX;
+    const int iY = yIm + entry.offsetY;
+    if ((iX < 0) || (iX >= geom.nX) || (iY < 0) || (iY >= geom.nY))
+      continue;
+
+    const float value = signals.get_psignal(iX + geom.nX * iY)[entry.tIdx];
+    rfsaft += value;
+    rfsaftabs += std::fabs(value);
+    nElem++;
+  }
+
+  return FinalizeVoxel(rfsaft, rfsaftabs, nElem, table.get_sign(zIm),
+                       geom.flagCoherenceW);
+}
+
+} // namespace opensaft
@@ -0,0 +1,37 @@
+#include "Memory/UltrasoundSignals.h"
+#include "Recon/DelayTable.h"
+#include "Recon/SaftGeometry.h"
+#include <cmath>
+
+#pragma once
+
+namespace opensaft {
+
+/// turns the coherent and incoherent sums of a voxel into its final value
+[[nodiscard]] inline float FinalizeVoxel(const float rfsaft,
+                                         const float rfsaftabs,
+                                         const int nElem, const int signMultip,
+                                         const bool flagCoherenceW) {
+  if (rfsaftabs <= 0.0f)
+    return 0.0f;
+
+  const float cf = flagCoherenceW
+                       ? rfsaft * rfsaft /
+                             (rfsaftabs * rfsaftabs * static_cast<float>(nElem))
+                       : 1.0f;
+  return static_cast<float>(signMultip) * rfsaft * cf;
+}
+
+/// delay-and-sum of a single voxel computing all delays on the fly, serves as
+/// reference for the table based kernels
+[[nodiscard]] float CalculateVoxelDirect(const SaftGeometry& geom,
+                                         const UltrasoundSignals& signals,
+                                         const Size3& idx);
+
+/// delay-and-sum of a single voxel using precomputed delays
+[[nodiscard]] float CalculateVoxel(const SaftGeometry& geom,
+                                   const DelayTable& table,
+                                   const UltrasoundSignals& signals,
+                                   const Size3& idx);
+
+} // namespace opensaft
@@ -0,0 +1,188 @@
+#include "Recon/SeparableSaft.h"
+#include "Recon/SaftKernel.h"
+#include "Util/ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace opensaft {
+
+namespace {
+
+/// a step size too large for any lateral neighbour to fall into the aperture
+/// degenerates the 2D delay table into a single line along the other axis
+constexpr float singleLine = std::numeric_limits<float>::max();
+
+/// coherent sum, incoherent sum and number of summed samples per voxel
+struct PartialSums {
+  std::vector<float> sum;
+  std::vector<float> sumAbs;
+  std::vector<float> count; //!< only filled with coherence factor weighting
+
+  /// resizes to n zeroed voxels, keeping the allocated memory
+  void Reset(const std::size_t n, const bool withCount) {
+    sum.assign(n, 0.0f);
+    sumAbs.assign(n, 0.0f);
+    count.assign(withCount ? n : 0, 0.0f);
+  }
+};
+
+/// adds the n samples of in to the sums starting at offset, the loop runs
+/// over contiguous memory and vectorizes
+inline void Accumulate(const float* in, PartialSums& sums,
+                       const std::size_t offset, const std::size_t n) {
+  float* sum = sums.sum.data() + offset;
+  float* sumAbs = sums.sumAbs.data() + offset;
+  for (std::size_t i = 0; i < n; i++) {
+    sum[i] += in[i];
+    sumAbs[i] += std::fabs(in[i]);
+  }
+  if (!sums.count.empty()) {
+    float* count = sums.count.data() + offset;
+    for (std::size_t i = 0; i < n; i++)
+      count[i] += 1.0f;
+  }
+}
+
+/// adds n voxels of partial sums of the first pass to those of the second
+inline void Accumulate(const PartialSums& in, const std::size_t inOffset,
+                       PartialSums& sums, const std::size_t offset,
+                       const std::size_t n) {
+  const float* inSum = in.sum.data() + inOffset;
+  const float* inSumAbs = in.sumAbs.data() + inOffset;
+  float* sum = sums.sum.data() + offset;
+  float* sumAbs = sums.sumAbs.data() + offset;
+  for (std::size_t i = 0; i < n; i++) {
+    sum[i] += inSum[i];
+    sumAbs[i] += inSumAbs[i];
+  }
+  if (!sums.count.empty()) {
+    const float* inCount = in.count.data() + inOffset;
+    float* count = sums.count.data() + offset;
+    for (std::size_t i = 0; i < n; i++)
+      count[i] += inCount[i];
+  }
+}
+
+} // namespace
+
+SeparableSaft::SeparableSaft(const SaftGeometry& geom) : m_geom(geom) {
+  SaftGeometry geomX = geom;
+  geomX.dy = singleLine;
+  m_tableX = DelayTable::Get(geomX);
+
+  SaftGeometry geomY = geom;
+  geomY.dx = singleLine;
+  m_tableY = DelayTable::Get(geomY);
+}
+
+void SeparableSaft::Reconstruct(const UltrasoundSignals& signals,
+                                const Size3& start, const Size3& stop,
+                                Volume& output,
+                                const unsigned int threadCount,
+                                const ProgressCallback& progress) const {
+  const Size3 dims = stop - start;
+  if (output.get_dims() != dims)
+    throw std::invalid_argument("output does not match the region");
+
+  const int nX = m_geom.nX;
+  const int nY = m_geom.nY;
+  const int nT = m_geom.nT;
+  const int xStart = static_cast<int>(start[0]);
+  const int xStop = static_cast<int>(stop[0]);
+  const int yStart = static_cast<int>(start[1]);
+  const int yStop = static_cast<int>(stop[1]);
+  const std::size_t nXOut = dims[0];
+  const std::size_t nYOut = dims[1];
+
+  // the second pass samples the intermediate result along y at the depths
+  // and rows listed in its table, only those are computed by the first pass
+  int depthFirst = nT;
+  int depthLast = -1;
+  for (std::size_t zIm = start[2]; zIm < stop[2]; zIm++) {
+    for (const DelayEntry& entry :
+         m_tableY->get_entries(static_cast<int>(zIm))) {
+      depthFirst = std::min(depthFirst, entry.tIdx);
+      depthLast = std::max(depthLast, entry.tIdx);
+    }
+  }
+  const std::size_t nDepths =
+      static_cast<std::size_t>(std::max(depthLast - depthFirst + 1, 0));
+  const int halo = m_tableY->get_maxOffsetY();
+  const int rowFirst = std::max(yStart - halo, 0);
+  const int rowStop = std::min(yStop + halo, nY);
+  const auto nRows = static_cast<std::size_t>(rowStop - rowFirst);
+
+  // first pass: focus every row along x, intermediate layout matches the
+  // volume (x fastest, then rows, then depths)
+  PartialSums rows;
+  rows.Reset(nXOut * nRows * nDepths, m_geom.flagCoherenceW);
+  ParallelFor(nRows, threadCount, [&](const std::size_t iRow) {
+    const int yIn = rowFirst + static_cast<int>(iRow);
+
+    // transposed copy of the row, so neighbouring A-scans are contiguous
+    thread_local std::vector<float> plane;
+    plane.resize(std::max(plane.size(), static_cast<std::size_t>(nT) * nX));
+    for (int iX = 0; iX < nX; iX++) {
+      const float* sig = signals.get_psignal(iX + nX * yIn);
+      for (int tIdx = 0; tIdx < nT; tIdx++)
+        plane[static_cast<std::size_t>(tIdx) * nX + iX] = sig[tIdx];
+    }
+
+    for (std::size_t iDepth = 0; iDepth < nDepths; iDepth++) {
+      const int zIm = depthFirst + static_cast<int>(iDepth);
+      const std::size_t rowOffset = nXOut * (iRow + nRows * iDepth);
+      for (const DelayEntry& entry : m_tableX->get_entries(zIm)) {
+        const int xFirst = std::max(xStart, -entry.offsetX);
+        const int xLast = std::min(xStop, nX - entry.offsetX);
+        if (xFirst >= xLast)
+          continue;
+        const float* in = plane.data() +
+                          static_cast<std::size_t>(entry.tIdx) * nX +
+                          (xFirst + entry.offsetX);
+        Accumulate(in, rows, rowOffset + (xFirst - xStart),
+                   static_cast<std::size_t>(xLast - xFirst));
+      }
+    }
+  });
+
+  // second pass: sum the focused rows along y, one output depth per task
+  const std::size_t planeSize = nXOut * nYOut;
+  float* voxels = output.data();
+  ParallelFor(dims[2], threadCount, [&](const std::size_t iZ) {
+    const int zIm = static_cast<int>(start[2] + iZ);
+    thread_local PartialSums planeSums;
+    planeSums.Reset(planeSize, m_geom.flagCoherenceW);
+
+    for (const DelayEntry& entry : m_tableY->get_entries(zIm)) {
+      const int yFirst = std::max(yStart, -entry.offsetY);
+      const int yLast = std::min(yStop, nY - entry.offsetY);
+      const auto iDepth = static_cast<std::size_t>(entry.tIdx - depthFirst);
+      for (int yIm = yFirst; yIm < yLast; yIm++) {
+        const auto iRow =
+            static_cast<std::size_t>(yIm + entry.offsetY - rowFirst);
+        const std::size_t idxIn = nXOut * (iRow + nRows * iDepth);
+        const std::size_t idxOut =
+            nXOut * static_cast<std::size_t>(yIm - yStart);
+        Accumulate(rows, idxIn, planeSums, idxOut, nXOut);
+      }
+    }
+
+    const int sign = m_tableY->get_sign(zIm);
+    float* out = voxels + planeSize * iZ;
+    for (std::size_t iVox = 0; iVox < planeSize; iVox++) {
+      const int nElem = m_geom.flagCoherenceW
+                            ? static_cast<int>(planeSums.count[iVox] + 0.5f)
+                            : 0;
+      out[iVox] = FinalizeVoxel(planeSums.sum[iVox], planeSums.sumAbs[iVox],
+                                nElem, sign, m_geom.flagCoherenceW);
+    }
+
+    if (progress)
+      progress(planeSize);
+  });
+}
+
+} // namespace opensaft
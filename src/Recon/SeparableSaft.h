@@ -0,0 +1,44 @@
+#include "Memory/UltrasoundSignals.h"
+#include "Memory/Volume.h"
+#include "Recon/DelayTable.h"
+#include "Recon/SaftGeometry.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#pragma once
+
+namespace opensaft {
+
+/// two pass approximation of the delay-and-sum: the first pass focuses each
+/// row of A-scans along x for all depths, the second one sums the focused
+/// rows along y. As the intermediate depth axis shares the sampling of the
+/// time axis, the delays of both passes combine to the exact 3D distance;
+/// the approximation lies in the rectangular instead of circular aperture
+/// and the twice rounded delays. The cost per voxel drops from
+/// aperture_x * aperture_y to aperture_x + aperture_y samples.
+class SeparableSaft {
+public:
+  explicit SeparableSaft(const SaftGeometry& geom);
+
+  /// called with the number of finished output voxels
+  using ProgressCallback = std::function<void(uint64_t)>;
+
+  /// reconstructs the raster voxels [start, stop) of signals into output,
+  /// which must have the dimensions stop - start
+  void Reconstruct(const UltrasoundSignals& signals, const Size3& start,
+                   const Size3& stop, Volume& output,
+                   const unsigned int threadCount = 0,
+                   const ProgressCallback& progress = nullptr) const;
+
+  /// \returns the one dimensional delays of the x and y pass
+  [[nodiscard]] const DelayTable& get_tableX() const { return *m_tableX; }
+  [[nodiscard]] const DelayTable& get_tableY() const { return *m_tableY; }
+
+private:
+  SaftGeometry m_geom;
+  std::shared_ptr<const DelayTable> m_tableX; //!< offsets along x only
+  std::shared_ptr<const DelayTable> m_tableY; //!< offsets along y only
+};
+
+} // namespace opensaft
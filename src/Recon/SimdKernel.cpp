@@ -0,0 +1,174 @@
+#include "Recon/SimdKernel.h"
+#include "Recon/SaftKernel.h"
+#include <algorithm>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define OPENSAFT_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace opensaft {
+
+namespace {
+
+/// applies the coherence factor and sign for all lanes of a block
+void FinalizeBlock(const SaftGeometry& geom, const DelayTable& table,
+                   const int iBlock, const float* rfsaft,
+                   const float* rfsaftabs, const int* nElem, float* out) {
+  const int zStart = iBlock * DelayBlockWidth;
+  for (int iLane = 0; iLane < DelayBlockWidth; iLane++) {
+    const int zIm = zStart + iLane;
+    out[iLane] = (zIm < geom.nT)
+                     ? FinalizeVoxel(rfsaft[iLane], rfsaftabs[iLane],
+                                     nElem[iLane], table.get_sign(zIm),
+                                     geom.flagCoherenceW)
+                     : 0.0f;
+  }
+}
+
+void CalculateVoxelBlockScalar(const SaftGeometry& geom,
+                               const DelayTable& table,
+                               const UltrasoundSignals& signals, const int xIm,
+                               const int yIm, const int iBlock, float* out) {
+  const int zStart = iBlock * DelayBlockWidth;
+  for (int iLane = 0; iLane < DelayBlockWidth; iLane++) {
+    const std::size_t zIm = static_cast<std::size_t>(zStart + iLane);
+    out[iLane] = (zStart + iLane < geom.nT)
+                     ? CalculateVoxel(geom, table, signals,
+                                      {static_cast<std::size_t>(xIm),
+                                       static_cast<std::size_t>(yIm), zIm})
+                     : 0.0f;
+  }
+}
+
+#ifdef OPENSAFT_X86_SIMD
+
+// the vectorized kernels gather the same A-scans in the same order as the
+// scalar one and use plain adds only, masked out lanes add +0.0f which leaves
+// their sums unchanged
+
+__attribute__((target("avx2"))) void
+CalculateVoxelBlockAvx2(const SaftGeometry& geom, const DelayTable& table,
+                        const UltrasoundSignals& signals, const int xIm,
+                        const int yIm, const int iBlock, float* out) {
+  static_assert(DelayBlockWidth == 16, "kernel processes two halves of 8");
+  const __m256 signMask = _mm256_set1_ps(-0.0f);
+  const __m256i minusOne = _mm256_set1_epi32(-1);
+  __m256 rfsaft[2] = {_mm256_setzero_ps(), _mm256_setzero_ps()};
+  __m256 rfsaftabs[2] = {_mm256_setzero_ps(), _mm256_setzero_ps()};
+  __m256i nElem[2] = {_mm256_setzero_si256(), _mm256_setzero_si256()};
+
+  for (const DelayBlockEntry& entry : table.get_blockEntries(iBlock)) {
+    const int iX = xIm + entry.offsetX;
+    const int iY = yIm + entry.offsetY;
+    if ((iX < 0) || (iX >= geom.nX) || (iY < 0) || (iY >= geom.nY))
+      continue;
+
+    const float* sig = signals.get_psignal(iX + geom.nX * iY);
+    for (int iHalf = 0; iHalf < 2; iHalf++) {
+      const __m256i tIdx = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i*>(entry.tIdx + 8 * iHalf));
+      const __m256i valid = _mm256_cmpgt_epi32(tIdx, minusOne);
+      const __m256 value = _mm256_mask_i32gather_ps(
+          _mm256_setzero_ps(), sig, tIdx, _mm256_castsi256_ps(valid), 4);
+      rfsaft[iHalf] = _mm256_add_ps(rfsaft[iHalf], value);
+      rfsaftabs[iHalf] =
+          _mm256_add_ps(rfsaftabs[iHalf], _mm256_andnot_ps(signMask, value));
+      nElem[iHalf] = _mm256_sub_epi32(nElem[iHalf], valid);
+    }
+  }
+
+  alignas(32) float sumCoh[DelayBlockWidth];
+  alignas(32) float sumAbs[DelayBlockWidth];
+  alignas(32) int count[DelayBlockWidth];
+  for (int iHalf = 0; iHalf < 2; iHalf++) {
+    _mm256_store_ps(sumCoh + 8 * iHalf, rfsaft[iHalf]);
+    _mm256_store_ps(sumAbs + 8 * iHalf, rfsaftabs[iHalf]);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(count + 8 * iHalf),
+                       nElem[iHalf]);
+  }
+  FinalizeBlock(geom, table, iBlock, sumCoh, sumAbs, count, out);
+}
+
+__attribute__((target("avx512f"))) void
+CalculateVoxelBlockAvx512(const SaftGeometry& geom, const DelayTable& table,
+                          const UltrasoundSignals& signals, const int xIm,
+                          const int yIm, const int iBlock, float* out) {
+  const __m512i zero = _mm512_setzero_si512();
+  const __m512i one = _mm512_set1_epi32(1);
+  __m512 rfsaft = _mm512_setzero_ps();
+  __m512 rfsaftabs = _mm512_setzero_ps();
+  __m512i nElem = _mm512_setzero_si512();
+
+  for (const DelayBlockEntry& entry : table.get_blockEntries(iBlock)) {
+    const int iX = xIm + entry.offsetX;
+    const int iY = yIm + entry.offsetY;
+    if ((iX < 0) || (iX >= geom.nX) || (iY < 0) || (iY >= geom.nY))
+      continue;
+
+    const float* sig = signals.get_psignal(iX + geom.nX * iY);
+    const __m512i tIdx = _mm512_loadu_si512(entry.tIdx);
+    const __mmask16 valid = _mm512_cmpge_epi32_mask(tIdx, zero);
+    const __m512 value =
+        _mm512_mask_i32gather_ps(_mm512_setzero_ps(), valid, tIdx, sig, 4);
+    rfsaft = _mm512_add_ps(rfsaft, value);
+    rfsaftabs = _mm512_add_ps(rfsaftabs, _mm512_abs_ps(value));
+    nElem = _mm512_mask_add_epi32(nElem, valid, nElem, one);
+  }
+
+  alignas(64) float sumCoh[DelayBlockWidth];
+  alignas(64) float sumAbs[DelayBlockWidth];
+  alignas(64) int count[DelayBlockWidth];
+  _mm512_store_ps(sumCoh, rfsaft);
+  _mm512_store_ps(sumAbs, rfsaftabs);
+  _mm512_store_si512(count, nElem);
+  FinalizeBlock(geom, table, iBlock, sumCoh, sumAbs, count, out);
+}
+
+#endif
+
+} // namespace
+
+SimdLevel DetectSimdLevel() {
+#ifdef OPENSAFT_X86_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return SimdLevel::Avx512;
+  if (__builtin_cpu_supports("avx2"))
+    return SimdLevel::Avx2;
+#endif
+  return SimdLevel::Scalar;
+}
+
+std::string ToString(const SimdLevel level) {
+  switch (level) {
+  case SimdLevel::Avx2:
+    return "AVX2";
+  case SimdLevel::Avx512:
+    return "AVX-512";
+  case SimdLevel::Scalar:
+    break;
+  }
+  return "scalar";
+}
+
+void CalculateVoxelBlock(const SimdLevel level, const SaftGeometry& geom,
+                         const DelayTable& table,
+                         const UltrasoundSignals& signals, const int xIm,
+                         const int yIm, const int iBlock, float* out) {
+#ifdef OPENSAFT_X86_SIMD
+  switch (level) {
+  case SimdLevel::Avx512:
+    CalculateVoxelBlockAvx512(geom, table, signals, xIm, yIm, iBlock, out);
+    return;
+  case SimdLevel::Avx2:
+    CalculateVoxelBlockAvx2(geom, table, signals, xIm, yIm, iBlock, out);
+    return;
+  case SimdLevel::Scalar:
+    break;
+  }
+#endif
+  CalculateVoxelBlockScalar(geom, table, signals, xIm, yIm, iBlock, out);
+}
+
+} // namespace opensaft
@@ -0,0 +1,30 @@
+#include "Memory/UltrasoundSignals.h"
+#include "Recon/DelayTable.h"
+#include "Recon/SaftGeometry.h"
+#include <string>
+
+#pragma once
+
+namespace opensaft {
+
+/// instruction set used by the vectorized delay-and-sum kernel
+enum class SimdLevel : int {
+  Scalar = 0, //!< portable fallback, one voxel at a time
+  Avx2,       //!< 8 depths per instruction
+  Avx512,     //!< 16 depths per instruction
+};
+
+/// \returns the best instruction set supported by the executing cpu
+[[nodiscard]] SimdLevel DetectSimdLevel();
+
+[[nodiscard]] std::string ToString(const SimdLevel level);
+
+/// reconstructs the DelayBlockWidth consecutive depths of block iBlock at the
+/// lateral position (xIm, yIm) and writes them to out, lanes beyond nT are
+/// set to 0. All levels produce bitwise identical results.
+void CalculateVoxelBlock(const SimdLevel level, const SaftGeometry& geom,
+                         const DelayTable& table,
+                         const UltrasoundSignals& signals, const int xIm,
+                         const int yIm, const int iBlock, float* out);
+
+} // namespace opensaft
@@ -0,0 +1,225 @@
+#include "ReconQueue.h"
+#include "Processing/Preprocessor.h"
+#include "Saft.h"
+#include "Util/Timer.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+
+namespace opensaft {
+
+namespace {
+
+/// input of a job handed from the I/O thread to a runner
+struct LoadedInput {
+  std::size_t iJob = 0;
+  std::optional<UltrasoundSignals> signals;
+  std::string error; //!< set if loading failed
+};
+
+/// \returns the message of the exception currently handled
+std::string GetErrorMessage() {
+  try {
+    throw;
+  } catch (const std::exception& e) {
+    return e.what();
+  } catch (...) {
+    return "unknown error";
+  }
+}
+
+} // namespace
+
+std::size_t ReconQueueReport::get_nFailed() const {
+  return static_cast<std::size_t>(
+      std::count_if(jobs.begin(), jobs.end(), [](const ReconJobReport& job) {
+        return !job.error.empty();
+      }));
+}
+
+std::string ReconQueueReport::ToString() const {
+  std::string table = std::format("{:<32} {:>9} {:>9} {:>9} {:>9}  {}\n",
+                                  "job", "load [s]", "wait [s]", "recon [s]",
+                                  "store [s]", "status");
+  double loadTime = 0.0;
+  double reconTime = 0.0;
+  for (const auto& job : jobs) {
+    table += std::format("{:<32} {:>9.3f} {:>9.3f} {:>9.3f} {:>9.3f}  {}\n",
+                         job.name, job.loadTime, job.waitTime, job.reconTime,
+                         job.storeTime, job.error.empty() ? "ok" : job.error);
+    loadTime += job.loadTime;
+    reconTime += job.reconTime;
+  }
+  table += std::format("{} jobs ({} failed) in {:.3f} s, {:.3f} s loading "
+                       "and {:.3f} s reconstructing in total\n",
+                       jobs.size(), get_nFailed(), totalTime, loadTime,
+                       reconTime);
+  return table;
+}
+
+void ReconQueue::SetConcurrency(const unsigned int concurrency) {
+  if (concurrency == 0)
+    throw std::invalid_argument("concurrency must be at least 1");
+  m_concurrency = concurrency;
+}
+
+void ReconQueue::SetPrefetchDepth(const std::size_t depth) {
+  if (depth == 0)
+    throw std::invalid_argument("prefetch depth must be at least 1");
+  m_prefetchDepth = depth;
+}
+
+std::size_t ReconQueue::Add(ReconJob job) {
+  if (!job.load)
+    throw std::invalid_argument("job needs a function loading its input");
+  m_jobs.push_back(std::move(job));
+  return m_jobs.size() - 1;
+}
+
+std::size_t ReconQueue::Add(const std::string& filePath,
+                            const ReconSettings& settings,
+                            const Transducer& transducer,
+                            std::function<void(Volume&&)> store) {
+  return Add(ReconJob{
+      filePath,
+      [filePath]() { return UltrasoundSignals::ReadFromFile(filePath); },
+      settings, transducer, std::move(store)});
+}
+
+std::size_t ReconQueue::Add(UltrasoundSignals&& signals,
+                            const ReconSettings& settings,
+                            const Transducer& transducer,
+                            std::function<void(Volume&&)> store) {
+  // std::function needs a copyable target, the input is moved out once
+  auto input = std::make_shared<UltrasoundSignals>(std::move(signals));
+  return Add(ReconJob{std::format("job {}", m_jobs.size()),
+                      [input]() { return std::move(*input); }, settings,
+                      transducer, std::move(store)});
+}
+
+ReconQueueReport ReconQueue::Run() {
+  Timer T;
+  const std::vector<ReconJob> jobs = std::move(m_jobs);
+  m_jobs.clear();
+  ReconQueueReport report;
+  report.jobs.resize(jobs.size());
+  for (std::size_t iJob = 0; iJob < jobs.size(); iJob++)
+    report.jobs[iJob].name = jobs[iJob].name;
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::deque<LoadedInput> loaded; //!< inputs not taken by a runner yet
+  bool isLoadingDone = false;
+
+  // loads the inputs in order, at most m_prefetchDepth ahead of the runners
+  std::jthread loader([&]() {
+    for (std::size_t iJob = 0; iJob < jobs.size(); iJob++) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return loaded.size() < m_prefetchDepth; });
+      }
+
+      LoadedInput input;
+      input.iJob = iJob;
+      Timer loadTimer;
+      try {
+        input.signals.emplace(jobs[iJob].load());
+        // mapped files are only read on access, which would otherwise
+        // happen on the compute threads of the runner
+        input.signals->Prefetch();
+      } catch (...) {
+        input.error = GetErrorMessage();
+      }
+      loadTimer.Stop();
+      report.jobs[iJob].loadTime = loadTimer.GetElapsedTime();
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        loaded.push_back(std::move(input));
+      }
+      changed.notify_all();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      isLoadingDone = true;
+    }
+    changed.notify_all();
+  });
+
+  const auto runner = [&]() {
+    while (true) {
+      Timer waitTimer;
+      LoadedInput input;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return !loaded.empty() || isLoadingDone; });
+        if (loaded.empty())
+          return;
+        input = std::move(loaded.front());
+        loaded.pop_front();
+      }
+      changed.notify_all();
+
+      const ReconJob& job = jobs[input.iJob];
+      ReconJobReport& jobReport = report.jobs[input.iJob];
+      waitTimer.Stop();
+      jobReport.waitTime = waitTimer.GetElapsedTime();
+      jobReport.error = std::move(input.error);
+      if (!jobReport.error.empty())
+        continue;
+
+      try {
+        // each job runs once, so the input is preprocessed in place instead
+        // of keeping a raw copy next to the preprocessed one
+        Timer reconTimer;
+        Preprocessor preprocessor;
+        preprocessor.SetSettings(job.settings);
+        preprocessor.Process(*input.signals);
+
+        Saft saft;
+        saft.SetSettings(job.settings);
+        saft.SetTransducer(job.transducer);
+        saft.SetPreprocessedInput(std::move(*input.signals));
+        saft.Run();
+        reconTimer.Stop();
+        jobReport.reconTime = reconTimer.GetElapsedTime();
+
+        std::optional<Volume> volume = saft.TakeVolume();
+        if (!volume.has_value())
+          throw std::runtime_error("no volume reconstructed");
+        Timer storeTimer;
+        if (job.store)
+          job.store(std::move(*volume));
+        storeTimer.Stop();
+        jobReport.storeTime = storeTimer.GetElapsedTime();
+      } catch (...) {
+        jobReport.error = GetErrorMessage();
+      }
+    }
+  };
+
+  // the calling thread is one of the runners
+  std::vector<std::jthread> runners;
+  for (unsigned int iRunner = 1; iRunner < m_concurrency; iRunner++)
+    runners.emplace_back(runner);
+  runner();
+  for (auto& thread : runners)
+    thread.join();
+  loader.join();
+
+  T.Stop();
+  report.totalTime = T.GetElapsedTime();
+  Log(std::format("Reconstructed {} jobs ({} failed) in {:.3f} s",
+                  jobs.size(), report.get_nFailed(), report.totalTime));
+  return report;
+}
+
+} // namespace opensaft
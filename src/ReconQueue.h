@@ -0,0 +1,88 @@
+#include "Memory/UltrasoundSignals.h"
+#include "Memory/Volume.h"
+#include "ReconSettings.h"
+#include "Transducer.h"
+#include "Util/Logger.h"
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#pragma once
+
+namespace opensaft {
+
+/// a dataset reconstructed as part of a ReconQueue
+struct ReconJob {
+  std::string name; //!< identifies the job in the report
+  /// provides the input, called on the I/O thread of the queue ahead of the
+  /// reconstruction
+  std::function<UltrasoundSignals()> load;
+  ReconSettings settings;
+  Transducer transducer;
+  /// receives the volume on the thread of the job, may be empty
+  std::function<void(Volume&&)> store;
+};
+
+/// timing of a single job [s]
+struct ReconJobReport {
+  std::string name;
+  double loadTime = 0.0;  //!< loading and reading in on the I/O thread
+  double waitTime = 0.0;  //!< waited for the input once a slot was free
+  double reconTime = 0.0; //!< preprocessing and reconstruction
+  double storeTime = 0.0; //!< spent in ReconJob::store
+  std::string error;      //!< empty if the job succeeded
+};
+
+/// summary of a batch, the jobs are in the order they were added
+struct ReconQueueReport {
+  std::vector<ReconJobReport> jobs;
+  double totalTime = 0.0; //!< wall time of the batch [s]
+
+  [[nodiscard]] std::size_t get_nFailed() const;
+
+  /// \returns a table of the job timings followed by the totals
+  [[nodiscard]] std::string ToString() const;
+};
+
+/// reconstructs a batch of datasets. Up to SetConcurrency jobs run at the
+/// same time, all of them on the shared ThreadPool so that the processor
+/// units are not oversubscribed. A separate I/O thread loads the inputs of
+/// the next jobs while the current ones compute.
+class ReconQueue : LoggingClass {
+public:
+  /// number of jobs reconstructed at the same time (default 1)
+  void SetConcurrency(const unsigned int concurrency);
+
+  /// number of inputs loaded ahead of the running jobs (default 1)
+  void SetPrefetchDepth(const std::size_t depth);
+
+  /// adds a job, \returns its index in the report
+  std::size_t Add(ReconJob job);
+
+  /// adds a job reading its input from a file (see
+  /// UltrasoundSignals::ReadFromFile), named after the file
+  std::size_t Add(const std::string& filePath, const ReconSettings& settings,
+                  const Transducer& transducer,
+                  std::function<void(Volume&&)> store = {});
+
+  /// adds a job for an input which is already in memory
+  std::size_t Add(UltrasoundSignals&& signals, const ReconSettings& settings,
+                  const Transducer& transducer,
+                  std::function<void(Volume&&)> store = {});
+
+  /// reconstructs all queued jobs and empties the queue. A failing job is
+  /// reported and does not stop the others.
+  ReconQueueReport Run();
+
+  [[nodiscard]] std::size_t get_nJobs() const noexcept {
+    return m_jobs.size();
+  }
+
+private:
+  std::vector<ReconJob> m_jobs;
+  unsigned int m_concurrency = 1;
+  std::size_t m_prefetchDepth = 1;
+};
+
+} // namespace opensaft
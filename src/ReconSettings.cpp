@@ -48,4 +48,30 @@ void ReconSettings::sortCropping() {
 
 void ReconSettings::set_rMin(const float _rMin) { rMin = _rMin; }
 
+void ReconSettings::set_flagBandpass(const bool _flagBandpass) {
+  flagBandpass = _flagBandpass;
+}
+
+void ReconSettings::set_bandpass(const float fMin, const float fMax) {
+  bandpass[0] = fMin;
+  bandpass[1] = fMax;
+}
+
+void ReconSettings::set_mode(const ReconMode _mode) { mode = _mode; }
+
+bool ReconSettings::IsSameRecon(const ReconSettings& other) const {
+  return IsSamePreprocessing(other) && sos == other.sos &&
+         flagCoherenceW == other.flagCoherenceW &&
+         flagSensW == other.flagSensW &&
+         flagPulseEcho == other.flagPulseEcho && rMin == other.rMin &&
+         flagUs == other.flagUs && flagGpu == other.flagGpu &&
+         mode == other.mode;
+}
+
+bool ReconSettings::IsSamePreprocessing(const ReconSettings& other) const {
+  return cropMm[0] == other.cropMm[0] && cropMm[1] == other.cropMm[1] &&
+         flagBandpass == other.flagBandpass &&
+         bandpass[0] == other.bandpass[0] && bandpass[1] == other.bandpass[1];
+}
+
 } // namespace opensaft
\ No newline at end of file
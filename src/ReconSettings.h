@@ -13,6 +13,13 @@
 
 namespace opensaft {
 
+/// delay-and-sum variant used by the cpu reconstruction
+enum class ReconMode : int {
+  Exact = 0,       //!< full 3D sum over the circular aperture
+  Separable,       //!< two 2D passes along x then y, approximate but faster
+  FrequencyDomain, //!< f-k (Stolt) migration in O(N log N) via 3D FFTs
+};
+
 class ReconSettings {
 private:
   float sos = 1495.0f;        // speed of sound used [m/s]
@@ -27,6 +34,9 @@ private:
   bool flagUs = false; // if enabled, pulse echo mode
   bool flagGpu =
       true; // defines if the reconstruction should run on the GPU or CPU
+  bool flagBandpass = false; // apply bandpass filter during preprocessing
+  float bandpass[2] = {1e6f, 100e6f}; // lower and upper cutoff [Hz]
+  ReconMode mode = ReconMode::Exact;  // reconstruction engine of the cpu
 
 public:
   // set and get functions for speed of sound
@@ -37,6 +47,9 @@ public:
   // flag for different logical settings
   [[nodiscard]] bool* get_pflagCoherenceW() { return &flagCoherenceW; };
   [[nodiscard]] bool get_flagCoherenceW() const { return flagCoherenceW; };
+  void set_flagCoherenceW(const bool _flagCoherenceW) {
+    flagCoherenceW = _flagCoherenceW;
+  };
 
   [[nodiscard]] bool* get_pflagSensW() { return &flagSensW; };
   [[nodiscard]] bool* get_pflagPulseEcho() { return &flagPulseEcho; };
@@ -88,11 +101,31 @@ public:
   [[nodiscard]] float* get_pcropX() { return &cropMm[2]; };
   [[nodiscard]] float* get_pcropY() { return &cropMm[4]; };
 
+  // bandpass filtering of the A-scans prior reconstruction
+  [[nodiscard]] bool* get_pflagBandpass() { return &flagBandpass; };
+  [[nodiscard]] bool get_flagBandpass() const { return flagBandpass; };
+  void set_flagBandpass(const bool _flagBandpass);
+  [[nodiscard]] float* get_pbandpass() { return &bandpass[0]; };
+  [[nodiscard]] float get_bandpassMin() const { return bandpass[0]; };
+  [[nodiscard]] float get_bandpassMax() const { return bandpass[1]; };
+  void set_bandpass(const float fMin, const float fMax);
+
+  [[nodiscard]] ReconMode get_mode() const { return mode; };
+  void set_mode(const ReconMode _mode);
+
   [[nodiscard]] float* get_prMin() { return &rMin; };
   [[nodiscard]] float get_rMin() const { return rMin; };
   void set_rMin(const float _rMin);
 
   void sortCropping();
+
+  /// \returns if other yields the same voxels as these settings, the lateral
+  /// crop is not compared since Saft::SetRegion sets the region instead
+  [[nodiscard]] bool IsSameRecon(const ReconSettings& other) const;
+
+  /// \returns if other preprocesses the A-scans the same way, i.e. with the
+  /// same time crop and bandpass
+  [[nodiscard]] bool IsSamePreprocessing(const ReconSettings& other) const;
 };
 
 } // namespace opensaft
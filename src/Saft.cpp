@@ -1,73 +1,560 @@
 #include "Saft.h"
+#include "Processing/Preprocessor.h"
+#include "Recon/FkMigration.h"
+#include "Recon/SeparableSaft.h"
 #include "Util/Logger.h"
+#include "Util/ParallelFor.h"
+#include "Util/Profiler.h"
 #include "Util/Timer.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
 #include <format>
+#include <functional>
+#include <stdexcept>
+#include <unistd.h>
+#include <utility>
+#include <vector>
 
 namespace opensaft {
 
-Saft::Saft() : m_processorCount(std::thread::hardware_concurrency()) {
+namespace {
+
+/// \returns up to six disjoint boxes covering [start, stop) except for the
+/// box [innerStart, innerStop), which must lie within the former
+std::vector<std::pair<Size3, Size3>>
+SubtractRegion(const Size3& start, const Size3& stop, const Size3& innerStart,
+               const Size3& innerStop) {
+  std::vector<std::pair<Size3, Size3>> parts;
+  Size3 first = start;
+  Size3 last = stop;
+  // peel off the slabs in front of and behind the inner box along z, y, x
+  for (int iDim = 2; iDim >= 0; iDim--) {
+    if (first[iDim] < innerStart[iDim]) {
+      Size3 partStop = last;
+      partStop[iDim] = innerStart[iDim];
+      parts.emplace_back(first, partStop);
+      first[iDim] = innerStart[iDim];
+    }
+    if (innerStop[iDim] < last[iDim]) {
+      Size3 partStart = first;
+      partStart[iDim] = innerStop[iDim];
+      parts.emplace_back(partStart, last);
+      last[iDim] = innerStop[iDim];
+    }
+  }
+  return parts;
+}
+
+/// copies the raster voxels [start, stop) from src covering the raster from
+/// srcStart on into dst covering the raster from dstStart on
+void CopyRegion(const Volume& src, const Size3& srcStart, Volume& dst,
+                const Size3& dstStart, const Size3& start, const Size3& stop) {
+  const Size3 srcDims = src.get_dims();
+  const Size3 dstDims = dst.get_dims();
+  const std::size_t nX = stop[0] - start[0];
+  for (std::size_t z = start[2]; z < stop[2]; z++) {
+    for (std::size_t y = start[1]; y < stop[1]; y++) {
+      const float* in =
+          src.data() + (start[0] - srcStart[0]) +
+          srcDims[0] * ((y - srcStart[1]) + srcDims[1] * (z - srcStart[2]));
+      float* out =
+          dst.data() + (start[0] - dstStart[0]) +
+          dstDims[0] * ((y - dstStart[1]) + dstDims[1] * (z - dstStart[2]));
+      std::copy(in, in + nX, out);
+    }
+  }
+}
+
+/// \returns if the progressive pass of the given stride reconstructs the
+/// column x, y of the output, the first pass takes the full lattice and each
+/// later one the columns not on the lattice of the previous pass
+bool IsInPass(const std::size_t x, const std::size_t y,
+              const unsigned int stride, const unsigned int firstStride) {
+  if (x % stride != 0 || y % stride != 0)
+    return false;
+  return stride == firstStride || x % (2 * stride) != 0 ||
+         y % (2 * stride) != 0;
+}
+
+} // namespace
+
+Saft::Saft()
+    : m_processorCount(std::thread::hardware_concurrency()),
+      m_threadCount(std::max(1u, m_processorCount)),
+      m_simdLevel(DetectSimdLevel()) {
   Log(std::format("Found {} processor units...", m_processorCount));
 }
 
+Saft::~Saft() {
+  Cancel();
+  if (m_reconThread.joinable())
+    m_reconThread.join();
+}
+
+void Saft::SetRegion(const Size3& start, const Size3& stop) {
+  for (uint8_t iDim = 0; iDim < 3; iDim++) {
+    if (start[iDim] >= stop[iDim])
+      throw std::invalid_argument("region must not be empty");
+  }
+  m_region = {start, stop};
+}
+
+void Saft::SetSimdLevel(const SimdLevel level) {
+  m_simdLevel = std::min(level, DetectSimdLevel());
+}
+
+void Saft::SetPreviewStride(const unsigned int stride) {
+  if (!std::has_single_bit(stride))
+    throw std::invalid_argument("preview stride must be a power of two");
+  m_previewStride = stride;
+}
+
+ReconSnapshot Saft::GetSnapshot() const {
+  std::lock_guard<std::mutex> lock(m_snapshotMutex);
+  return m_snapshot;
+}
+
+void Saft::SetThreadCount(const unsigned int threadCount) {
+  m_threadCount = (threadCount == 0) ? std::max(1u, m_processorCount)
+                                     : threadCount;
+}
+
 // for each a scan first calculate the mean and then substract if from the
 // vector
 void Saft::RemoveDC() {
+  // preprocessed input has no DC component left
+  if (!m_inputData.has_value())
+    return;
 
-  Log("Removing DC offset... ");
-  Timer T;
-  for (auto& sigs : *m_measuredData)
-    sigs.RemoveDC();
+  // default settings neither crop nor filter
+  Preprocessor preprocessor;
+  preprocessor.SetThreadCount(m_threadCount);
+  preprocessor.Process(*m_inputData);
+  m_measuredData.reset();
+  m_inputId++;
+}
 
-  T.Stop();
-  Log(std::format("DC offset removed in {} seconds", T.GetElapsedTime()));
+void Saft::Preprocess() {
+  Preprocessor preprocessor;
+  preprocessor.SetSettings(m_settings);
+  preprocessor.SetThreadCount(m_threadCount);
+  m_measuredData.reset();
+  m_measuredData = preprocessor.Process(std::as_const(*m_inputData));
 }
 
-void Saft::Launch() {
+bool Saft::Start() {
   // if input data was not specified, we cannot do anything
-  if (!m_measuredData.has_value()) {
+  if (!m_inputData.has_value() && !m_measuredData.has_value()) {
     Log(LogLevel::Warning, "No data available for reconstruction!");
-    return;
+    return false;
   }
 
+  // a previous run must have finished before its thread is replaced
+  if (m_reconThread.joinable())
+    m_reconThread.join();
+
   m_start = std::chrono::high_resolution_clock::now();
   m_isRunning = true;
+  m_isCancelled = false;
+  m_stopSource = std::stop_source();
   Log("Starting reconstruction...");
-  m_reconThread = std::thread(&Saft::Recon, this);
+  return true;
+}
+
+void Saft::Launch() {
+  if (Start())
+    m_reconThread = std::jthread(
+        [this, token = m_stopSource.get_token()] { Recon(token); });
+}
+
+void Saft::Run() {
+  if (Start())
+    Recon(m_stopSource.get_token());
 }
 
-void Saft::Recon() {
+void Saft::Cancel() { m_stopSource.request_stop(); }
 
+void Saft::Pause() {
+  std::lock_guard<std::mutex> lock(m_stateMutex);
+  m_isPaused = true;
+}
+
+void Saft::Resume() {
+  {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    m_isPaused = false;
+  }
+  m_stateChanged.notify_all();
+}
+
+bool Saft::WaitWhilePaused(const std::stop_token& token) {
+  std::unique_lock<std::mutex> lock(m_stateMutex);
+  return m_stateChanged.wait(lock, token, [this] { return !m_isPaused; });
+}
+
+void Saft::Recon(const std::stop_token& token) {
+  ProfileZone zone("reconstruction");
   m_percDone = 0.0f;
+  m_voxelsDone = 0;
+  tRemain = 0.0;
+  {
+    std::lock_guard<std::mutex> lock(m_snapshotMutex);
+    m_snapshot = ReconSnapshot();
+  }
+
+  const UltrasoundSignals& input =
+      m_inputData.has_value() ? *m_inputData : *m_measuredData;
+  if (input.IsRaster()) {
+    // crop, remove the DC component and filter in a single pass, the input
+    // itself stays untouched for runs with another crop or bandpass
+    if (m_inputData.has_value() &&
+        (!m_measuredData.has_value() || !m_preprocessSettings.has_value() ||
+         !m_preprocessSettings->IsSamePreprocessing(m_settings))) {
+      Preprocess();
+      m_preprocessSettings = m_settings;
+    }
+
+    // the previous volume stays alive until its voxels have been reused
+    std::optional<Volume> previous = std::move(m_reconData);
+    m_reconData.reset();
+    const std::vector<std::pair<Size3, Size3>> previousPending =
+        std::move(m_pending);
+    m_pending.clear();
+    const Size3 previousStart = m_regionStart;
+    ReconKey reconKey = GetReconKey();
+
+    m_geometry =
+        SaftGeometry::Create(*m_measuredData, m_settings, m_transducer);
+    m_delayTable = DelayTable::Get(m_geometry);
+    const auto& props = m_measuredData->get_properties();
+    const Size3 rasterDims{props.nX, props.nY, m_measuredData->get_nT()};
+    m_regionStart = Size3();
+    Size3 regionStop = rasterDims;
+    if (m_region.has_value()) {
+      for (uint8_t iDim = 0; iDim < 3; iDim++) {
+        regionStop[iDim] = std::min(m_region->second[iDim], rasterDims[iDim]);
+        m_regionStart[iDim] =
+            std::min(m_region->first[iDim], regionStop[iDim] - 1);
+      }
+    }
+    const Size3 dims = regionStop - m_regionStart;
 
-  // remove the DC component
-  RemoveDC();
+    m_reconData.emplace(dims);
+    m_reconData->set_res(m_geometry.GetVoxelSize());
+    m_reconData->set_center(m_geometry.GetCenter(m_regionStart, regionStop));
 
-  // for now we just sleep a bit, then finish
-  for (std::size_t iRound = 0; iRound < 100; iRound++) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-    m_percDone = static_cast<float>(iRound);
-    // todo here we need to insert some sort of calculation
+    std::vector<std::pair<Size3, Size3>> missing{{m_regionStart, regionStop}};
+    m_nReused = 0;
+    if (previous.has_value() && m_reconKey == reconKey)
+      missing = ReusePrevious(*previous, previousStart, previousPending);
+    previous.reset();
+    m_reconKey = std::move(reconKey);
+    m_voxelsDone = m_nReused;
+
+    if (token.stop_requested()) {
+      m_pending = std::move(missing);
+    } else if (m_settings.get_mode() == ReconMode::Exact) {
+      if (!missing.empty())
+        ReconExact(missing, token);
+    } else if (!missing.empty()) {
+      // the approximate engines work on boxes, the bounding box of the
+      // missing parts is reconstructed and copied over
+      Size3 start = missing.front().first;
+      Size3 stop = missing.front().second;
+      for (const auto& [partStart, partStop] : missing) {
+        for (uint8_t iDim = 0; iDim < 3; iDim++) {
+          start[iDim] = std::min(start[iDim], partStart[iDim]);
+          stop[iDim] = std::max(stop[iDim], partStop[iDim]);
+        }
+      }
+
+      std::optional<Volume> part;
+      if (stop - start != dims)
+        part.emplace(stop - start);
+      Volume& output = part.has_value() ? *part : *m_reconData;
+      m_voxelsDone = m_reconData->size() - output.size();
+      if (m_settings.get_mode() == ReconMode::Separable)
+        ReconSeparable(start, stop, output);
+      else
+        ReconFrequencyDomain(start, stop, output);
+
+      if (part.has_value()) {
+        for (const auto& [partStart, partStop] : missing)
+          CopyRegion(*part, start, *m_reconData, m_regionStart, partStart,
+                     partStop);
+      }
+    }
+  } else {
+    Log(LogLevel::Warning, "Input data is not a complete raster, skipping");
   }
 
   // indicate that we are finished and calculate reconstruction time
-  m_isRunning = false;
-  m_percDone = 100.0f;
+  m_isCancelled = !m_pending.empty();
+  if (!m_isCancelled)
+    m_percDone = 100.0f;
+  tRemain = 0.0;
   auto end = std::chrono::high_resolution_clock::now();
   std::chrono::duration<double> elapsed = end - m_start;
   m_reconTime = elapsed.count();
+  {
+    // a pause ends with the run it held, so that a run cancelled while
+    // paused does not hold the next one
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    m_isRunning = false;
+    m_isPaused = false;
+  }
+  m_stateChanged.notify_all();
+}
+
+std::vector<std::pair<Size3, Size3>>
+Saft::ReusePrevious(const Volume& previous, const Size3& previousStart,
+                    const std::vector<std::pair<Size3, Size3>>& pending) {
+  const Size3 start = m_regionStart;
+  const Size3 stop = m_regionStart + m_reconData->get_dims();
+  const Size3 previousStop = previousStart + previous.get_dims();
+  Size3 sharedStart;
+  Size3 sharedStop;
+  for (uint8_t iDim = 0; iDim < 3; iDim++) {
+    sharedStart[iDim] = std::max(start[iDim], previousStart[iDim]);
+    sharedStop[iDim] = std::min(stop[iDim], previousStop[iDim]);
+    if (sharedStart[iDim] >= sharedStop[iDim])
+      return {{start, stop}};
+  }
+
+  CopyRegion(previous, previousStart, *m_reconData, start, sharedStart,
+             sharedStop);
+  const Size3 shared = sharedStop - sharedStart;
+  m_nReused = shared[0] * shared[1] * shared[2];
+  std::vector<std::pair<Size3, Size3>> missing =
+      SubtractRegion(start, stop, sharedStart, sharedStop);
+
+  // parts a cancelled run did not reach lie within the previous volume
+  for (const auto& [pendingStart, pendingStop] : pending) {
+    Size3 partStart;
+    Size3 partStop;
+    bool isEmpty = false;
+    for (uint8_t iDim = 0; iDim < 3; iDim++) {
+      partStart[iDim] = std::max(pendingStart[iDim], sharedStart[iDim]);
+      partStop[iDim] = std::min(pendingStop[iDim], sharedStop[iDim]);
+      isEmpty = isEmpty || partStart[iDim] >= partStop[iDim];
+    }
+    if (isEmpty)
+      continue;
+
+    const Size3 part = partStop - partStart;
+    m_nReused -= part[0] * part[1] * part[2];
+    missing.emplace_back(partStart, partStop);
+  }
+
+  Log(std::format("Reusing {} of {} voxels of the previous reconstruction",
+                  m_nReused, m_reconData->size()));
+  return missing;
+}
+
+void Saft::ReconExact(const std::vector<std::pair<Size3, Size3>>& regions,
+                      const std::stop_token& token) {
+  // small tiles ordered by their estimated cost keep all workers busy
+  // even though the aperture grows with the distance to the focal plane
+  std::vector<Tile> tiles;
+  uint64_t nVoxels = 0;
+  for (const auto& [start, stop] : regions) {
+    for (Tile tile : TileScheduler::Partition(stop - start, m_tileSize)) {
+      tile.start = tile.start + start;
+      tile.stop = tile.stop + start;
+      tile.cost = m_geometry.EstimateCost(tile);
+      nVoxels += tile.get_nVoxels();
+      tiles.push_back(tile);
+    }
+  }
+
+  const std::size_t nThreads =
+      std::min<std::size_t>(m_threadCount, tiles.size());
+  Log(std::format("Reconstructing {} voxels on {} threads ({})", nVoxels,
+                  nThreads, ToString(m_simdLevel)));
+
+  // the passes of the progressive mode share the tiles, each one skips the
+  // columns of the others
+  float* output = m_reconData->data();
+  for (unsigned int stride = m_previewStride; stride > 0; stride /= 2) {
+    TileScheduler scheduler(tiles, nThreads);
+    ParallelFor(nThreads, static_cast<unsigned int>(nThreads),
+                [&](const std::size_t workerId) {
+                  ReconWorker(scheduler, workerId, stride, token, output);
+                });
+
+    if (Logger::IsEnabled(LogLevel::Debug))
+      Log(LogLevel::Debug,
+          std::format("{} tiles were stolen", scheduler.get_nStolen()));
+    if (token.stop_requested()) {
+      // tiles of the coarse passes lack columns of the later ones
+      if (stride > 1)
+        m_pending = regions;
+      Log(std::format("Reconstruction cancelled, {} tiles left",
+                      m_pending.size()));
+      return;
+    }
+    if (stride > 1)
+      PublishSnapshot(regions, stride);
+  }
+}
+
+void Saft::PublishSnapshot(const std::vector<std::pair<Size3, Size3>>& regions,
+                           const unsigned int stride) {
+  // all columns on the lattice of the stride are reconstructed by now
+  const std::size_t nX = m_reconData->get_dim(0);
+  const std::size_t nY = m_reconData->get_dim(1);
+  float* output = m_reconData->data();
+  for (const auto& [start, stop] : regions) {
+    const Size3 first = start - m_regionStart;
+    const Size3 last = stop - m_regionStart;
+    ParallelFor(last[2] - first[2], m_threadCount, [&](const std::size_t iZ) {
+      float* plane = output + nX * nY * (first[2] + iZ);
+      for (std::size_t y = first[1]; y < last[1]; y++) {
+        const float* source = plane + nX * (y - y % stride);
+        for (std::size_t x = first[0]; x < last[0]; x++) {
+          if (x % stride != 0 || y % stride != 0)
+            plane[x + nX * y] = source[x - x % stride];
+        }
+      }
+    });
+  }
+
+  auto volume = std::make_shared<const Volume>(*m_reconData);
+  const std::chrono::duration<double> tPassed =
+      std::chrono::high_resolution_clock::now() - m_start;
+  {
+    std::lock_guard<std::mutex> lock(m_snapshotMutex);
+    m_snapshot = {std::move(volume), stride, tPassed.count()};
+  }
+  Log(std::format("Preview with stride {} available after {:.2f} s", stride,
+                  tPassed.count()));
+}
+
+void Saft::ReconSeparable(const Size3& start, const Size3& stop,
+                          Volume& output) {
+  ProfileZone zone("separable");
+  const SeparableSaft separable(m_geometry);
+  const Size3 dims = stop - start;
+  Log(std::format("Reconstructing {} x {} x {} voxels separable on {} threads",
+                  dims[0], dims[1], dims[2], m_threadCount));
+  separable.Reconstruct(*m_measuredData, start, stop, output, m_threadCount,
+                        [this](const uint64_t nVoxels) {
+                          UpdateProgress(nVoxels);
+                        });
+}
+
+void Saft::ReconFrequencyDomain(const Size3& start, const Size3& stop,
+                                Volume& output) {
+  ProfileZone zone("f-k migration");
+  const FkMigration migration(m_geometry);
+  const Size3 dims = stop - start;
+  const Size3 padded = migration.get_paddedDims();
+  const std::size_t bufferBytes = migration.get_bufferBytes();
+  Log(std::format("Migrating {} x {} x {} voxels in the frequency domain "
+                  "({} x {} x {} padded, {} MB) on {} threads",
+                  dims[0], dims[1], dims[2], padded[0], padded[1], padded[2],
+                  bufferBytes >> 20, m_threadCount));
+  const auto freeBytes = static_cast<std::size_t>(sysconf(_SC_AVPHYS_PAGES)) *
+                         static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  if (bufferBytes > freeBytes)
+    Log(LogLevel::Warning,
+        std::format("f-k migration needs more than the {} MB of free memory",
+                    freeBytes >> 20));
+  migration.Reconstruct(*m_measuredData, start, stop, output, m_threadCount,
+                        [this](const uint64_t nVoxels) {
+                          UpdateProgress(nVoxels);
+                        });
+}
+
+void Saft::ReconWorker(TileScheduler& scheduler, const std::size_t workerId,
+                       const unsigned int stride, const std::stop_token& token,
+                       float* outputVol) {
+  // once cancelled the remaining tiles are drained and remembered, so that
+  // the next run can pick them up
+  while (const auto tile = scheduler.Pop(workerId)) {
+    if (token.stop_requested() || !WaitWhilePaused(token)) {
+      std::lock_guard<std::mutex> lock(m_pendingMutex);
+      m_pending.emplace_back(tile->start, tile->stop);
+      continue;
+    }
+    ReconTile(*tile, stride, outputVol);
+  }
+}
+
+void Saft::ReconTile(const Tile& tile, const unsigned int stride,
+                     float* outputVol) {
+  ProfileZone zone("kernel tile");
+  const std::size_t nX = m_reconData->get_dim(0);
+  const std::size_t nY = m_reconData->get_dim(1);
+  const Size3& offset = m_regionStart;
+
+  // the kernel always reconstructs blocks of consecutive depths, lanes
+  // outside of the tile are discarded
+  const std::size_t width = static_cast<std::size_t>(DelayBlockWidth);
+  const std::size_t blockStart = tile.start[2] / width;
+  const std::size_t blockStop = (tile.stop[2] + width - 1) / width;
+  float block[DelayBlockWidth];
+  std::size_t nColumns = 0;
+
+  for (std::size_t iBlock = blockStart; iBlock < blockStop; iBlock++) {
+    const std::size_t zFirst = std::max(iBlock * width, tile.start[2]);
+    const std::size_t zLast = std::min((iBlock + 1) * width, tile.stop[2]);
+    for (std::size_t yIm = tile.start[1]; yIm < tile.stop[1]; yIm++) {
+      for (std::size_t xIm = tile.start[0]; xIm < tile.stop[0]; xIm++) {
+        const std::size_t xOut = xIm - offset[0];
+        const std::size_t yOut = yIm - offset[1];
+        // a strided subset of depths would cost as much as the full block
+        if (!IsInPass(xOut, yOut, stride, m_previewStride))
+          continue;
+
+        CalculateVoxelBlock(m_simdLevel, m_geometry, *m_delayTable,
+                            *m_measuredData, static_cast<int>(xIm),
+                            static_cast<int>(yIm), static_cast<int>(iBlock),
+                            block);
+        for (std::size_t zIm = zFirst; zIm < zLast; zIm++)
+          outputVol[xOut + nX * (yOut + nY * (zIm - offset[2]))] =
+              block[zIm - iBlock * width];
+        if (iBlock == blockStart)
+          nColumns++;
+      }
+    }
+  }
+
+  UpdateProgress(nColumns * (tile.stop[2] - tile.start[2]));
+}
+
+void Saft::UpdateProgress(const uint64_t nVoxels) {
+  const uint64_t nTotal = m_reconData->size();
+  const uint64_t nDone = m_voxelsDone.fetch_add(nVoxels) + nVoxels;
+  const float percDone = static_cast<float>(nDone) / nTotal * 100.0f;
+  m_percDone = percDone;
+
+  const std::chrono::duration<double> tPassed =
+      std::chrono::high_resolution_clock::now() - m_start;
+  tRemain = tPassed.count() / percDone * (100.0f - percDone);
 }
 
 void Saft::Wait() {
-  while (m_isRunning) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    Log(std::format("Reconstruction status at {}%", get_percDone()));
+  {
+    // wakes up as soon as the reconstruction ends, reporting the progress
+    // every second until then
+    std::unique_lock<std::mutex> lock(m_stateMutex);
+    while (!m_stateChanged.wait_for(lock, std::chrono::seconds(1),
+                                    [this] { return !m_isRunning; }))
+      Log(std::format("Reconstruction status at {}%", get_percDone()));
   }
 
   if (m_reconThread.joinable()) {
     m_reconThread.join();
   }
 
-  Log(std::format("Reconstruction finished after {} seconds", m_reconTime));
+  if (m_isCancelled)
+    Log(std::format("Reconstruction cancelled after {} seconds, launch again "
+                    "to resume",
+                    m_reconTime));
+  else
+    Log(std::format("Reconstruction finished after {} seconds", m_reconTime));
 }
 
 std::optional<Volume> Saft::GetVolume() const {
@@ -77,13 +564,14 @@ std::optional<Volume> Saft::GetVolume() const {
   return m_reconData;
 }
 
-float Saft::CalculateVoxel(Size3 idx) {
-  // calculates the response for a single position in the volume
-  // todo not implemented yet
-  //
-  Float3 posOutput = m_reconData.value().get_pos(idx);
-
-  return 0.0f;
+std::optional<Volume> Saft::TakeVolume() {
+  if (!m_reconData.has_value()) {
+    Log(LogLevel::Warning, "No volume data available");
+  }
+  std::optional<Volume> volume = std::move(m_reconData);
+  m_reconData.reset();
+  m_pending.clear();
+  return volume;
 }
 
-} // namespace opensaft
\ No newline at end of file
+} // namespace opensaft
@@ -1,21 +1,31 @@
 #include "Memory/UltrasoundSignals.h"
 #include "Memory/Volume.h"
+#include "Recon/DelayTable.h"
+#include "Recon/SaftGeometry.h"
+#include "Recon/SimdKernel.h"
 #include "ReconSettings.h"
 #include "Transducer.h"
 #include "Util/Logger.h"
+#include "Util/TileScheduler.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <stop_token>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #pragma once
 
 namespace opensaft {
 
-struct dcData {
-  uint64_t iVecStart;
-  uint64_t iVecEnd;
-  uint64_t nT;
-  uint64_t threadId;
-  float* ptr;
+/// intermediate result of a progressive reconstruction
+struct ReconSnapshot {
+  std::shared_ptr<const Volume> volume; //!< gaps filled by nearest neighbour
+  unsigned int stride = 0; //!< spacing of the reconstructed columns in x, y
+  double time = 0.0;       //!< seconds since the launch of the reconstruction
 };
 
 class Saft : LoggingClass {
@@ -24,17 +34,88 @@ public:
   // class constructor
   Saft();
 
+  /// cancels a running reconstruction and waits for its thread
+  ~Saft();
+
   /// runs the actual reconstruction in a separate thread
   void Launch();
 
-  /// waiting for the reconstruction to finish
+  /// runs the reconstruction in the calling thread, returns when finished
+  void Run();
+
+  /// waiting for the reconstruction to finish or to be cancelled
   void Wait();
 
-  /// define the input data for the reconstruction
-  void SetInput(UltrasoundSignals&& us) { m_measuredData = std::move(us); }
+  /// stops a running reconstruction of the exact engine after the tiles in
+  /// progress, the approximate engines finish first. The finished tiles are
+  /// kept: launching again with unchanged input, settings and region only
+  /// reconstructs the remaining ones.
+  void Cancel();
+
+  /// holds the workers of the exact engine before their next tile, also
+  /// the ones of the next launch if not running. The pause ends with the
+  /// reconstruction it holds.
+  void Pause();
+
+  /// continues a paused reconstruction
+  void Resume();
+
+  /// define the input data for the reconstruction, it is kept unchanged and
+  /// preprocessed into a separate buffer, which later runs reuse until the
+  /// time crop or the bandpass change
+  void SetInput(UltrasoundSignals&& us) {
+    m_inputData = std::move(us);
+    m_measuredData.reset();
+    m_inputId++;
+  }
+
+  /// define input data already preprocessed with the settings of the next
+  /// runs (see Preprocessor), it is used as is and no second copy is held.
+  /// Later changes of the time crop or the bandpass have no effect on it.
+  void SetPreprocessedInput(UltrasoundSignals&& us) {
+    m_inputData.reset();
+    m_measuredData = std::move(us);
+    m_inputId++;
+  }
+
+  /// define the settings and the transducer used for the reconstruction
+  void SetSettings(const ReconSettings& settings) { m_settings = settings; }
+  void SetTransducer(const Transducer& transducer) {
+    m_transducer = transducer;
+  }
+
+  /// overwrites the number of worker threads (0 uses all processor units)
+  void SetThreadCount(const unsigned int threadCount);
+
+  /// restricts the reconstruction to the voxels [start, stop) of the raster
+  /// spanned by the input data, the output volume only covers this region.
+  /// If neither input, settings nor transducer changed since the last run,
+  /// voxels of the previous volume are reused and only the new parts of the
+  /// region are reconstructed (unless the volume was taken).
+  void SetRegion(const Size3& start, const Size3& stop);
+
+  /// reconstructs the full raster spanned by the input data again
+  void ResetRegion() { m_region.reset(); }
+
+  /// enables the progressive mode of the exact engine: the first pass
+  /// reconstructs every stride-th column along x and y, each further pass
+  /// halves the stride until the full resolution is reached. The stride
+  /// must be a power of two, 1 disables the progressive mode.
+  void SetPreviewStride(const unsigned int stride);
+
+  /// \returns a copy of the volume as of the last finished progressive pass,
+  /// empty until the first pass of the running reconstruction finished
+  [[nodiscard]] ReconSnapshot GetSnapshot() const;
+
+  /// overwrites the instruction set of the voxel kernel, levels the cpu does
+  /// not support fall back to the best supported one
+  void SetSimdLevel(const SimdLevel level);
 
   std::optional<Volume> GetVolume() const;
 
+  /// moves the reconstructed volume out of the class instead of copying it
+  std::optional<Volume> TakeVolume();
+
   void saft_cpu(); // cpu version of the kernel, used for debugging and if no
                    // GPU present
 
@@ -43,30 +124,141 @@ public:
   void RemoveDC();
 
   [[nodiscard]] double get_reconTime() const noexcept { return m_reconTime; };
+  /// \returns the number of voxels the last run copied from the previous one
+  [[nodiscard]] uint64_t get_nReusedVoxels() const noexcept {
+    return m_nReused;
+  };
   [[nodiscard]] double get_tRemain() const noexcept { return tRemain; };
 
   [[nodiscard]] bool get_isRunning() const noexcept { return m_isRunning; };
+  [[nodiscard]] bool get_isPaused() const noexcept { return m_isPaused; };
+  /// \returns if the last run was cancelled before reconstructing all voxels
+  [[nodiscard]] bool get_isCancelled() const noexcept {
+    return m_isCancelled;
+  };
   [[nodiscard]] float get_percDone() const noexcept { return m_percDone; };
+  [[nodiscard]] unsigned int get_previewStride() const noexcept {
+    return m_previewStride;
+  };
+  [[nodiscard]] unsigned int get_threadCount() const noexcept {
+    return m_threadCount;
+  };
+  [[nodiscard]] SimdLevel get_simdLevel() const noexcept {
+    return m_simdLevel;
+  };
 
 private:
-  void Recon();
+  /// resets the state of a new run, \returns false if there is no input
+  [[nodiscard]] bool Start();
 
-  /// calculates the response of a single voxel in the output volume
-  float CalculateVoxel(Size3 idx);
+  void Recon(const std::stop_token& token);
 
-  std::optional<UltrasoundSignals> m_measuredData; //!< preprocessed datasets
+  /// blocks while paused, \returns false if cancelled in the meantime
+  [[nodiscard]] bool WaitWhilePaused(const std::stop_token& token);
+
+  /// crops, removes the DC component and filters the input into
+  /// m_measuredData
+  void Preprocess();
+
+  /// everything a voxel value depends on except for its position, the
+  /// fields are compared rather than hashed so that no collision can reuse
+  /// voxels of another reconstruction
+  struct ReconKey {
+    uint64_t inputId = 0;
+    ReconSettings settings;
+    Transducer transducer;
+    SimdLevel simdLevel = SimdLevel::Scalar;
+
+    [[nodiscard]] bool operator==(const ReconKey& other) const {
+      return inputId == other.inputId &&
+             settings.IsSameRecon(other.settings) &&
+             transducer == other.transducer && simdLevel == other.simdLevel;
+    }
+  };
+
+  /// \returns the key of a reconstruction started now
+  [[nodiscard]] ReconKey GetReconKey() const {
+    return {m_inputId, m_settings, m_transducer, m_simdLevel};
+  }
+
+  /// copies the voxels shared with the previous volume starting at
+  /// previousStart except for the parts pending from a cancelled run,
+  /// \returns the parts of the region left to reconstruct
+  [[nodiscard]] std::vector<std::pair<Size3, Size3>>
+  ReusePrevious(const Volume& previous, const Size3& previousStart,
+                const std::vector<std::pair<Size3, Size3>>& pending);
+
+  /// exact delay-and-sum of the regions in tiles distributed over the
+  /// workers, the tiles not reached before a cancel are left in m_pending
+  void ReconExact(const std::vector<std::pair<Size3, Size3>>& regions,
+                  const std::stop_token& token);
+
+  /// two pass approximation of the region, see SeparableSaft
+  void ReconSeparable(const Size3& start, const Size3& stop, Volume& output);
+
+  /// f-k migration of the full raster, see FkMigration
+  void ReconFrequencyDomain(const Size3& start, const Size3& stop,
+                            Volume& output);
+
+  /// pulls tiles from the scheduler until all of them are reconstructed
+  void ReconWorker(TileScheduler& scheduler, const std::size_t workerId,
+                   const unsigned int stride, const std::stop_token& token,
+                   float* outputVol);
+
+  /// reconstructs the voxels of a single tile which belong to the pass of
+  /// the given stride, tiles are given in raster coordinates and written
+  /// relative to m_regionStart
+  void ReconTile(const Tile& tile, const unsigned int stride,
+                 float* outputVol);
+
+  /// fills the columns of the regions not reconstructed by the passes so far
+  /// from their nearest reconstructed neighbour and publishes a snapshot
+  void PublishSnapshot(const std::vector<std::pair<Size3, Size3>>& regions,
+                       const unsigned int stride);
+
+  /// updates progress and remaining time after a number of voxels finished
+  void UpdateProgress(const uint64_t nVoxels);
+
+  std::optional<UltrasoundSignals> m_inputData;    //!< input as set if raw
+  std::optional<UltrasoundSignals> m_measuredData; //!< preprocessed input
   std::optional<Volume> m_reconData;               //!< reconstructed datasets
-  std::thread m_reconThread; //!< thread for reconstruction
+  std::jthread m_reconThread; //!< thread for reconstruction
+  std::stop_source m_stopSource; //!< cancels the running reconstruction
+
+  ReconSettings m_settings;  //!< settings used for the reconstruction
+  Transducer m_transducer;   //!< transducer used for the acquisition
+  SaftGeometry m_geometry;   //!< geometry of the running reconstruction
+  std::shared_ptr<const DelayTable> m_delayTable; //!< delays of m_geometry
+  const Size3 m_tileSize{8ul, 8ul, 32ul}; //!< max size of the scheduled tiles
+  std::optional<std::pair<Size3, Size3>> m_region; //!< requested region
+  Size3 m_regionStart; //!< first raster voxel of the running reconstruction
+  uint64_t m_inputId = 0; //!< incremented whenever the input is replaced
+  /// settings m_measuredData was preprocessed with from m_inputData
+  std::optional<ReconSettings> m_preprocessSettings;
+  std::optional<ReconKey> m_reconKey; //!< GetReconKey of m_reconData
+  uint64_t m_nReused = 0; //!< voxels copied from the previous volume
+  std::vector<std::pair<Size3, Size3>> m_pending; //!< left out by a cancel
+  std::mutex m_pendingMutex; //!< guards m_pending while workers run
+  unsigned int m_previewStride = 1; //!< stride of the first progressive pass
+  mutable std::mutex m_snapshotMutex; //!< guards m_snapshot
+  ReconSnapshot m_snapshot;           //!< last published progressive pass
 
   std::chrono::time_point<std::chrono::high_resolution_clock>
       m_start; //!< time of start
 
   const unsigned int m_processorCount;   //!< total number of cores available
+  unsigned int m_threadCount;            //!< number of worker threads used
+  SimdLevel m_simdLevel;                 //!< instruction set of the kernel
   std::atomic<bool> m_isRunning = false; //!< is reconstruction running
+  std::atomic<bool> m_isPaused = false;  //!< workers hold before next tile
+  std::atomic<bool> m_isCancelled = false; //!< last run left tiles pending
+  std::mutex m_stateMutex; //!< guards waits on the flags above
+  std::condition_variable_any m_stateChanged; //!< end, pause or resume
   std::atomic<float> m_percDone =
-      0.0f;                 //!< perc of reconstruction done so far [%]
-  double tRemain = 0;       //!< remaining reconstruction time (estimate)
-  double m_reconTime = 0.0; //!< time of last reconstruction
+      0.0f; //!< perc of reconstruction done so far [%]
+  std::atomic<uint64_t> m_voxelsDone = 0; //!< finished output voxels
+  std::atomic<double> tRemain = 0; //!< remaining reconstruction time (estimate)
+  double m_reconTime = 0.0;        //!< time of last reconstruction
 };
 
-} // namespace opensaft
\ No newline at end of file
+} // namespace opensaft
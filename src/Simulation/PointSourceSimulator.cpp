@@ -0,0 +1,174 @@
+#include "Simulation/PointSourceSimulator.h"
+#include "Recon/SaftGeometry.h"
+#include "Util/ParallelFor.h"
+#include "Util/Timer.h"
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <numbers>
+#include <stdexcept>
+
+namespace opensaft {
+
+namespace {
+
+/// counter based generator: bijective 64 bit mix of the sample index, so
+/// every sample gets its own reproducible random number in any order
+uint64_t SplitMix64(uint64_t x) {
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+/// \returns uniform number in (0, 1]
+float ToUnitInterval(const uint64_t bits) {
+  return (static_cast<float>(bits >> 40) + 1.0f) * 0x1.0p-24f;
+}
+
+} // namespace
+
+void PointSourceSimulator::SetPulse(const PulseShape shape,
+                                    const float centerFrequency,
+                                    const float bandwidth) {
+  if (shape != PulseShape::Delta && centerFrequency <= 0.0f)
+    throw std::invalid_argument("center frequency must be positive");
+  if (shape == PulseShape::GaussianSine && bandwidth <= 0.0f)
+    throw std::invalid_argument("bandwidth must be positive");
+
+  m_pulseShape = shape;
+  m_centerFrequency = centerFrequency;
+  switch (shape) {
+  case PulseShape::Delta:
+    m_pulseSigma = 0.0f;
+    break;
+  case PulseShape::NShape:
+    // derivative of a gaussian peaks in frequency at 1 / (2 pi sigma)
+    m_pulseSigma = 1.0f / (2.0f * std::numbers::pi_v<float> * centerFrequency);
+    break;
+  case PulseShape::GaussianSine: {
+    // full width at half maximum of the spectrum is bandwidth * centerFreq
+    const float sigmaF = bandwidth * centerFrequency /
+                         (2.0f * std::sqrt(2.0f * std::numbers::ln2_v<float>));
+    m_pulseSigma = 1.0f / (2.0f * std::numbers::pi_v<float> * sigmaF);
+    break;
+  }
+  }
+  m_pulseSupport = 4.0f * m_pulseSigma;
+}
+
+float PointSourceSimulator::EvaluatePulse(const float t) const {
+  const float tNorm = t / m_pulseSigma;
+  const float envelope = std::exp(-0.5f * tNorm * tNorm);
+  switch (m_pulseShape) {
+  case PulseShape::NShape:
+    // scaled to a peak amplitude of 1 at t = -sigma
+    return -tNorm * envelope * std::exp(0.5f);
+  case PulseShape::GaussianSine:
+    return envelope *
+           std::cos(2.0f * std::numbers::pi_v<float> * m_centerFrequency * t);
+  default:
+    return 0.0f;
+  }
+}
+
+Float3 PointSourceSimulator::GetVoxelPosition(const std::size_t iX,
+                                              const std::size_t iY,
+                                              const std::size_t tIdx) const {
+  const float c0 = m_settings.get_flagUs() ? 0.5f * m_settings.get_sos()
+                                           : m_settings.get_sos();
+  const float dt = 1.0f / m_props.sampleRate;
+  const float t = m_props.t0 + dt * static_cast<float>(tIdx);
+  return {m_props.origin[0] + m_props.dx * static_cast<float>(iX),
+          m_props.origin[1] + m_props.dy * static_cast<float>(iY),
+          m_props.origin[2] + t * c0};
+}
+
+UltrasoundSignals PointSourceSimulator::Simulate() const {
+  Timer T;
+  UltrasoundSignals signals(m_props, m_nT);
+  const std::size_t nY = m_props.nY;
+
+  ParallelFor(nY, m_threadCount, [&](const std::size_t iY) {
+    SimulateRows(signals, iY, iY + 1);
+  });
+
+  T.Stop();
+  const double nBytes = static_cast<double>(m_props.nX * nY * m_nT) * 4.0;
+  Log(std::format("Simulated {} absorbers in {:.1f} MB after {:.3f} seconds",
+                  m_absorbers.size(), nBytes * 1e-6, T.GetElapsedTime()));
+  return signals;
+}
+
+void PointSourceSimulator::SimulateRows(UltrasoundSignals& signals,
+                                        const std::size_t yStart,
+                                        const std::size_t yStop) const {
+  const SaftGeometry geom =
+      SaftGeometry::Create(signals, m_settings, m_transducer);
+  const float rHole = m_transducer.get_rHole() * 1e-3f;
+  const int nT = static_cast<int>(m_nT);
+
+  for (std::size_t iY = yStart; iY < yStop; iY++) {
+    for (std::size_t iX = 0; iX < m_props.nX; iX++) {
+      TimeSignalView sig = signals(iX, iY);
+      const Float3 scanPos = GetVoxelPosition(iX, iY, 0);
+
+      for (const PointAbsorber& absorber : m_absorbers) {
+        const float xRel = absorber.pos[0] - scanPos[0];
+        const float yRel = absorber.pos[1] - scanPos[1];
+        const float deltaZ = absorber.pos[2] - m_props.origin[2] - geom.fd;
+        const float absDeltaZ = std::fabs(deltaZ);
+        const float rDist = std::sqrt(xRel * xRel + yRel * yRel);
+        const float distTot = std::sqrt(rDist * rDist + deltaZ * deltaZ);
+
+        // the ray through the focal point needs to hit the active surface
+        const bool inCone = (rDist <= geom.critRatio * absDeltaZ) &&
+                            (geom.fd * rDist >= rHole * distTot);
+        if (!inCone && rDist >= geom.rMin)
+          continue;
+
+        const int signMultip = (deltaZ >= 0.0f) ? 1 : -1;
+        if (m_pulseShape == PulseShape::Delta) {
+          const int deltaT =
+              static_cast<int>(distTot / geom.c0 / geom.dt + 0.5f);
+          const int tIdx = geom.idxFoc + deltaT * signMultip;
+          if (tIdx >= 0 && tIdx < nT)
+            sig[tIdx] += absorber.amplitude;
+          continue;
+        }
+
+        const float tArrival =
+            (geom.fd + static_cast<float>(signMultip) * distTot) / geom.c0 -
+            geom.t0;
+        const int tFirst = std::max(
+            static_cast<int>(std::ceil((tArrival - m_pulseSupport) / geom.dt)),
+            0);
+        const int tLast = std::min(
+            static_cast<int>(std::floor((tArrival + m_pulseSupport) / geom.dt)),
+            nT - 1);
+        for (int tIdx = tFirst; tIdx <= tLast; tIdx++)
+          sig[tIdx] += absorber.amplitude *
+                       EvaluatePulse(geom.dt * static_cast<float>(tIdx) -
+                                     tArrival);
+      }
+
+      if (m_noiseStd > 0.0f) {
+        // box muller on a counter based generator, one pair per 2 samples
+        const uint64_t offset =
+            (m_noiseSeed * 0x2545F4914F6CDD1DULL) ^
+            (static_cast<uint64_t>(iX + m_props.nX * iY) * m_nT);
+        for (std::size_t tIdx = 0; tIdx < m_nT; tIdx += 2) {
+          const float u1 = ToUnitInterval(SplitMix64(offset + tIdx));
+          const float u2 = ToUnitInterval(SplitMix64(offset + tIdx + 1));
+          const float radius = m_noiseStd * std::sqrt(-2.0f * std::log(u1));
+          const float phi = 2.0f * std::numbers::pi_v<float> * u2;
+          sig[tIdx] += radius * std::cos(phi);
+          if (tIdx + 1 < m_nT)
+            sig[tIdx + 1] += radius * std::sin(phi);
+        }
+      }
+    }
+  }
+}
+
+} // namespace opensaft
@@ -0,0 +1,106 @@
+#include "Memory/UltrasoundSignals.h"
+#include "ReconSettings.h"
+#include "Transducer.h"
+#include "Util/Logger.h"
+#include "VectorN.h"
+#include <cstdint>
+#include <vector>
+
+#pragma once
+
+namespace opensaft {
+
+/// a single point shaped absorber (or scatterer in pulse echo mode)
+struct PointAbsorber {
+  Float3 pos{0.0f};       //!< position in the frame of the volume [m]
+  float amplitude = 1.0f; //!< peak amplitude of its signal
+};
+
+/// temporal shape of the signal emitted by an absorber
+enum class PulseShape {
+  Delta,        //!< single sample, same rounding as the reconstruction
+  NShape,       //!< bipolar optoacoustic pulse (derivative of a gaussian)
+  GaussianSine, //!< gaussian modulated sine of the transducer bandwidth
+};
+
+/// synthetic forward model of the acquisition: generates the raster of
+/// A-scans a spherically focused transducer records from a set of point
+/// absorbers, following the virtual point detector model used by the
+/// reconstruction. An absorber is only received if the ray from it through
+/// the focal point hits the active area of the transducer (between rHole and
+/// rAperture) or if it lies within rMin of the acoustic axis.
+class PointSourceSimulator : LoggingClass {
+public:
+  /// raster and sampling of the generated dataset
+  void SetAcquisition(const AcquisitionProperties& props,
+                      const std::size_t nT) {
+    m_props = props;
+    m_nT = nT;
+  }
+
+  /// speed of sound, pulse echo mode and rMin are taken from the settings
+  void SetSettings(const ReconSettings& settings) { m_settings = settings; }
+  void SetTransducer(const Transducer& transducer) {
+    m_transducer = transducer;
+  }
+
+  /// \param centerFrequency center frequency of the pulse [Hz]
+  /// \param bandwidth -6 dB bandwidth relative to centerFrequency, only used
+  /// by PulseShape::GaussianSine
+  void SetPulse(const PulseShape shape, const float centerFrequency = 50e6f,
+                const float bandwidth = 0.8f);
+
+  /// adds white gaussian noise of standard deviation stdDev, the noise only
+  /// depends on seed and not on the number of threads
+  void SetNoise(const float stdDev, const uint64_t seed = 0) {
+    m_noiseStd = stdDev;
+    m_noiseSeed = seed;
+  }
+
+  /// overwrites the number of worker threads (0 uses all processor units)
+  void SetThreadCount(const unsigned int threadCount) {
+    m_threadCount = threadCount;
+  }
+
+  void AddAbsorber(const PointAbsorber& absorber) {
+    m_absorbers.push_back(absorber);
+  }
+  void ClearAbsorbers() { m_absorbers.clear(); }
+
+  /// \returns the position of the voxel the reconstruction of the generated
+  /// dataset assigns to sample tIdx of A-scan (iX, iY) [m]
+  [[nodiscard]] Float3 GetVoxelPosition(const std::size_t iX,
+                                        const std::size_t iY,
+                                        const std::size_t tIdx) const;
+
+  /// runs the forward model on all absorbers
+  [[nodiscard]] UltrasoundSignals Simulate() const;
+
+  [[nodiscard]] const std::vector<PointAbsorber>& get_absorbers() const {
+    return m_absorbers;
+  }
+
+private:
+  /// \returns the pulse at time t relative to the arrival of the wave
+  [[nodiscard]] float EvaluatePulse(const float t) const;
+
+  /// simulates the A-scans of all rows in [yStart, yStop)
+  void SimulateRows(UltrasoundSignals& signals, const std::size_t yStart,
+                    const std::size_t yStop) const;
+
+  AcquisitionProperties m_props;
+  std::size_t m_nT = 0;
+  ReconSettings m_settings;
+  Transducer m_transducer;
+  std::vector<PointAbsorber> m_absorbers;
+
+  PulseShape m_pulseShape = PulseShape::Delta;
+  float m_centerFrequency = 50e6f; //!< [Hz]
+  float m_pulseSigma = 0.0f;       //!< width of the gaussian envelope [s]
+  float m_pulseSupport = 0.0f;     //!< pulse is evaluated within +- this [s]
+  float m_noiseStd = 0.0f;
+  uint64_t m_noiseSeed = 0;
+  unsigned int m_threadCount = 0;
+};
+
+} // namespace opensaft
@@ -1,9 +1,129 @@
 #include "ColorMapper.h"
 #include "MathUtil.h"
+#include "Recon/SimdKernel.h"
+#include "Util/ParallelFor.h"
+#include <algorithm>
+#include <cstring>
 #include <math.h>
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define OPENSAFT_X86_SIMD
+#include <immintrin.h>
+#endif
+
 namespace opensaft {
 
+namespace {
+
+/// values per task of convert_to_map, smaller images are converted serially
+constexpr uint64_t chunkSize = uint64_t{1} << 16;
+
+/// viridis sampled at 11 equidistant positions, interpolated linearly
+constexpr std::array<uint32_t, 11> viridisStops = {
+    0x440154, 0x482576, 0x414487, 0x35608D, 0x2A788E, 0x21908C,
+    0x22A884, 0x43BF71, 0x7AD151, 0xBBDF27, 0xFDE725};
+
+/// converts a color channel in [0, 1] to a byte the way convert_to_rgba does
+uint8_t ToByte(const float val) {
+  return static_cast<uint8_t>(Clamp(val, 0.0f, 1.0f) * 255.0f);
+}
+
+/// packs the channels so that the bytes end up in RGBA order in memory
+uint32_t Pack(const std::array<uint8_t, 4>& rgba) {
+  uint32_t packed;
+  std::memcpy(&packed, rgba.data(), sizeof(packed));
+  return packed;
+}
+
+uint8_t ViridisChannel(const uint32_t stop, const int shift) {
+  return static_cast<uint8_t>((stop >> shift) & 0xFF);
+}
+
+/// maps the table index of a value, NaN goes to the first entry
+uint32_t LutIndex(const float val, const float lo, const float scale) {
+  float pos = (val - lo) * scale + 0.5f;
+  pos = (pos > 0.0f) ? pos : 0.0f;
+  pos = (pos < ColorMapper::lutSize - 1) ? pos : ColorMapper::lutSize - 1;
+  return static_cast<uint32_t>(pos);
+}
+
+void MapScalar(const float* dataIn, const uint64_t nElem,
+               unsigned char* dataOut, const uint32_t* lut, const float lo,
+               const float scale) {
+  for (uint64_t iElem = 0; iElem < nElem; iElem++)
+    std::memcpy(dataOut + 4 * iElem, lut + LutIndex(dataIn[iElem], lo, scale),
+                4);
+}
+
+#ifdef OPENSAFT_X86_SIMD
+
+__attribute__((target("avx2"))) void
+MapAvx2(const float* dataIn, const uint64_t nElem, unsigned char* dataOut,
+        const uint32_t* lut, const float lo, const float scale) {
+  const __m256 loVec = _mm256_set1_ps(lo);
+  const __m256 scaleVec = _mm256_set1_ps(scale);
+  const __m256 half = _mm256_set1_ps(0.5f);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 last = _mm256_set1_ps(ColorMapper::lutSize - 1);
+  const auto* base = reinterpret_cast<const int*>(lut);
+  const uint64_t nVec = nElem - nElem % 8;
+  for (uint64_t iElem = 0; iElem < nVec; iElem += 8) {
+    __m256 pos = _mm256_sub_ps(_mm256_loadu_ps(dataIn + iElem), loVec);
+    pos = _mm256_add_ps(_mm256_mul_ps(pos, scaleVec), half);
+    // max returns its second operand for NaN
+    pos = _mm256_min_ps(_mm256_max_ps(pos, zero), last);
+    const __m256i rgba =
+        _mm256_i32gather_epi32(base, _mm256_cvttps_epi32(pos), 4);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dataOut + 4 * iElem),
+                        rgba);
+  }
+  MapScalar(dataIn + nVec, nElem - nVec, dataOut + 4 * nVec, lut, lo,
+            scale);
+}
+
+__attribute__((target("avx512f"))) void
+MapAvx512(const float* dataIn, const uint64_t nElem, unsigned char* dataOut,
+          const uint32_t* lut, const float lo, const float scale) {
+  const __m512 loVec = _mm512_set1_ps(lo);
+  const __m512 scaleVec = _mm512_set1_ps(scale);
+  const __m512 half = _mm512_set1_ps(0.5f);
+  const __m512 zero = _mm512_setzero_ps();
+  const __m512 last = _mm512_set1_ps(ColorMapper::lutSize - 1);
+  const uint64_t nVec = nElem - nElem % 16;
+  for (uint64_t iElem = 0; iElem < nVec; iElem += 16) {
+    __m512 pos = _mm512_sub_ps(_mm512_loadu_ps(dataIn + iElem), loVec);
+    pos = _mm512_add_ps(_mm512_mul_ps(pos, scaleVec), half);
+    pos = _mm512_min_ps(_mm512_max_ps(pos, zero), last);
+    const __m512i rgba =
+        _mm512_i32gather_epi32(_mm512_cvttps_epi32(pos), lut, 4);
+    _mm512_storeu_si512(dataOut + 4 * iElem, rgba);
+  }
+  MapScalar(dataIn + nVec, nElem - nVec, dataOut + 4 * nVec, lut, lo,
+            scale);
+}
+
+#endif
+
+void Map(const float* dataIn, const uint64_t nElem, unsigned char* dataOut,
+         const uint32_t* lut, const float lo, const float scale) {
+  static const SimdLevel level = DetectSimdLevel();
+#ifdef OPENSAFT_X86_SIMD
+  switch (level) {
+  case SimdLevel::Avx512:
+    MapAvx512(dataIn, nElem, dataOut, lut, lo, scale);
+    return;
+  case SimdLevel::Avx2:
+    MapAvx2(dataIn, nElem, dataOut, lut, lo, scale);
+    return;
+  case SimdLevel::Scalar:
+    break;
+  }
+#endif
+  MapScalar(dataIn, nElem, dataOut, lut, lo, scale);
+}
+
+} // namespace
+
 void ColorMapper::set_maxVal(const float _maxVal) {
   maxVal = _maxVal;
   calc_max_abs();
@@ -14,14 +134,22 @@ void ColorMapper::set_minVal(const float _minVal) {
   calc_max_abs();
 }
 
+void ColorMapper::set_range(const VolumeStats& stats) {
+  minVal = stats.minVal;
+  maxVal = stats.maxVal;
+  maxAbsVal = stats.absMax;
+}
+
 void ColorMapper::set_minCol(const Float4& _minCol) {
   minCol = _minCol;
   calc_span_col();
+  update_lut();
 }
 
 void ColorMapper::set_maxCol(const Float4& _maxCol) {
   maxCol = _maxCol;
   calc_span_col();
+  update_lut();
 }
 
 void ColorMapper::calc_span_col() { spanCol = maxCol - minCol; }
@@ -30,6 +158,59 @@ void ColorMapper::calc_max_abs() {
   maxAbsVal = (fabsf(maxVal) > fabsf(minVal)) ? fabsf(maxVal) : fabsf(minVal);
 }
 
+bool ColorMapper::is_lut_current() const {
+  return (lut != nullptr) && (lutType == mapType) && (lutMinCol == minCol) &&
+         (lutMaxCol == maxCol);
+}
+
+void ColorMapper::update_lut() {
+  auto newLut = std::make_shared<Lut>();
+  build_lut(*newLut);
+  lut = std::move(newLut);
+  lutType = mapType;
+  lutMinCol = minCol;
+  lutMaxCol = maxCol;
+}
+
+void ColorMapper::build_lut(Lut& out) const {
+  for (std::size_t iEntry = 0; iEntry < lutSize; iEntry++) {
+    // position of the entry in [0 ... 1]
+    const float pos = static_cast<float>(iEntry) / (lutSize - 1);
+    std::array<uint8_t, 4> rgba;
+    switch (mapType) {
+    case ColorMapType::Linear:
+      for (unsigned char iCol = 0; iCol < 4; iCol++)
+        rgba[iCol] = ToByte(minCol[iCol] + pos * (maxCol[iCol] - minCol[iCol]));
+      break;
+    case ColorMapType::Diverging: {
+      // entries span [-maxAbsVal ... maxAbsVal]
+      const float signedPos = 2.0f * pos - 1.0f;
+      const Float4& col = (signedPos < 0.0f) ? minCol : maxCol;
+      for (unsigned char iCol = 0; iCol < 3; iCol++)
+        rgba[iCol] = ToByte(1.0f - fabsf(signedPos) * col[iCol]);
+      rgba[3] = 255;
+      break;
+    }
+    case ColorMapType::Viridis: {
+      const float stopPos = pos * (viridisStops.size() - 1);
+      const std::size_t iStop =
+          std::min(static_cast<std::size_t>(stopPos), viridisStops.size() - 2);
+      const float frac = stopPos - static_cast<float>(iStop);
+      for (unsigned char iCol = 0; iCol < 3; iCol++) {
+        const int shift = 16 - 8 * iCol;
+        const float lower = ViridisChannel(viridisStops[iStop], shift);
+        const float upper = ViridisChannel(viridisStops[iStop + 1], shift);
+        rgba[iCol] =
+            static_cast<uint8_t>(lower + frac * (upper - lower) + 0.5f);
+      }
+      rgba[3] = 255;
+      break;
+    }
+    }
+    out[iEntry] = Pack(rgba);
+  }
+}
+
 void ColorMapper::convert_to_rgba(const float* dataIn, const uint64_t nElem,
                                   unsigned char* dataOut) const {
   float spanTemp = maxVal - minVal;
@@ -53,45 +234,67 @@ void ColorMapper::convert_to_divmap(const float* dataIn, const uint64_t nElem,
   // scale whole array to range from to 0 to 1
   float temp;
   for (uint64_t iElem = 0; iElem < nElem; iElem++) {
-    temp = abs(dataIn[iElem]) / maxAbsVal; // scale to [0 ... 1]
+    temp = fabsf(dataIn[iElem]) / maxAbsVal; // scale to [0 ... 1]
     if (temp > 1.0f)
       temp = 1.0f;
 
     if (dataIn[iElem] < 0) {
 #pragma unroll
-      for (unsigned char iCol = 0; iCol < 4; iCol++) {
+      for (unsigned char iCol = 0; iCol < 3; iCol++) {
         dataOut[iCol + iElem * 4] = (1 - temp * minCol[iCol]) * 255;
       }
 
     } else {
 #pragma unroll
-      for (unsigned char iCol = 0; iCol < 4; iCol++)
+      for (unsigned char iCol = 0; iCol < 3; iCol++)
         dataOut[iCol + iElem * 4] = (1 - temp * maxCol[iCol]) * 255;
     }
-    dataOut[4] = 255;
+    dataOut[3 + iElem * 4] = 255;
   }
 }
 
 void ColorMapper::convert_to_map(const float* dataIn, const uint64_t nElem,
                                  unsigned char* dataOut) const {
-  if (mapType == 0)
-    convert_to_rgba(dataIn, nElem, dataOut);
-  else if (mapType == 1) {
-    convert_to_divmap(dataIn, nElem, dataOut);
-    // set default colors for diverging map
+  // colors edited through the pointers since the last setter call
+  Lut localLut;
+  const uint32_t* table = localLut.data();
+  if (is_lut_current())
+    table = lut->data();
+  else
+    build_lut(localLut);
+
+  float lo = minVal;
+  float hi = maxVal;
+  if (mapType == ColorMapType::Diverging) {
+    hi = std::max(fabsf(minVal), fabsf(maxVal));
+    lo = -hi;
   }
+  const float scale = (hi != lo) ? (lutSize - 1) / (hi - lo) : 0.0f;
+
+  const uint64_t nChunks = (nElem + chunkSize - 1) / chunkSize;
+  if (nChunks <= 1) {
+    Map(dataIn, nElem, dataOut, table, lo, scale);
+    return;
+  }
+  ParallelFor(nChunks, 0, [&](const std::size_t iChunk) {
+    const uint64_t start = iChunk * chunkSize;
+    const uint64_t n = std::min(chunkSize, nElem - start);
+    Map(dataIn + start, n, dataOut + 4 * start, table, lo, scale);
+  });
 }
 
-void ColorMapper::set_mapType(const uint8_t _mapType) {
+void ColorMapper::set_mapType(const ColorMapType _mapType) {
   mapType = _mapType;
-  if (mapType == 0) {
+  if (mapType == ColorMapType::Linear) {
     minCol = 0.0f;
     maxCol = 1.0f;
   }
-  if (mapType == 1) {
+  if (mapType == ColorMapType::Diverging) {
     minCol = {1.0f, 1.0f, 0.0f, 1.0f}; // set minVal to bright blue
     maxCol = {0.0f, 1.0f, 1.0f, 1.0f}; // set maxVal to bright red
   }
+  calc_span_col();
+  update_lut();
 }
 
-} // namespace opensaft
\ No newline at end of file
+} // namespace opensaft
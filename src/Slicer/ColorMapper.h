@@ -7,13 +7,29 @@
 
 #pragma once
 
+#include "Memory/VolumeStats.h"
 #include "VectorN.h"
+#include <array>
 #include <cstdint>
 #include <cstdio>
+#include <memory>
 
 namespace opensaft {
 
+/// transfer functions of ColorMapper
+enum class ColorMapType : uint8_t {
+  Linear = 0,    //!< blends minCol into maxCol over [minVal, maxVal]
+  Diverging = 1, //!< white at 0 fading to minCol / maxCol at -+max abs value
+  Viridis = 2,   //!< perceptually uniform map of matplotlib
+};
+
 class ColorMapper {
+public:
+  /// values are quantized into this many colors, enough to resolve every
+  /// step of the 8 bit channels along any of the maps
+  static constexpr std::size_t lutSize = 4096;
+  using Lut = std::array<uint32_t, lutSize>; //!< RGBA bytes in memory order
+
 private:
   float minVal = -1.0f; //!< minimum value in colormap
   float maxVal = 1.0f;  //!< maximum value in colormap
@@ -26,17 +42,34 @@ private:
   void calc_span_col();
   void calc_max_abs();
 
-  uint8_t mapType = 0; // todo make this an enum class
-                       // 0: linear rgb
-                       // 1: diverging linear rgb (crossing 0 at 0)
-                       //
+  ColorMapType mapType = ColorMapType::Linear;
+
+  // the lookup table is shared between copies and rebuilt by the setters,
+  // colors changed through the pointers are detected by comparing the key
+  std::shared_ptr<const Lut> lut;
+  Float4 lutMinCol{0.0f};
+  Float4 lutMaxCol{0.0f};
+  ColorMapType lutType = ColorMapType::Linear;
+
+  void update_lut();
+  [[nodiscard]] bool is_lut_current() const;
+  void build_lut(Lut& out) const;
+
 public:
+  ColorMapper() { update_lut(); }
+
   // set function
   void set_maxVal(const float _maxVal);
   void set_minVal(const float _minVal);
   void set_minCol(const Float4& _minCol); // 4 element vector passed
   void set_maxCol(const Float4& _maxVal); // 4 element vector passed
-  void set_mapType(const uint8_t _mapType);
+  void set_mapType(const ColorMapType _mapType);
+  void set_mapType(const uint8_t _mapType) {
+    set_mapType(static_cast<ColorMapType>(_mapType));
+  }
+
+  /// maps the value range of stats, e.g. of the cached Volume::GetStats
+  void set_range(const VolumeStats& stats);
 
   // get pointer to min and max value
   [[nodiscard]] float* get_pmaxVal() { return &maxVal; };
@@ -45,11 +78,15 @@ public:
   [[nodiscard]] float get_minVal() const noexcept { return minVal; };
   [[nodiscard]] float* get_pminCol() { return &minCol[0]; };
   [[nodiscard]] float* get_pmaxCol() { return &maxCol[0]; };
+  [[nodiscard]] ColorMapType get_mapType() const noexcept { return mapType; };
 
-  // transfer function
+  /// transfer function of the selected map type: quantizes the values into
+  /// the lookup table with AVX2 / AVX-512 gathers, images of more than 64k
+  /// values are split across all processor units. Writes 4 bytes per value.
   void convert_to_map(const float* dataIn, const uint64_t nElem,
                       unsigned char* dataOut) const;
 
+  // direct evaluation of the linear and diverging maps without quantization
   void convert_to_rgba(const float* dataIn, const uint64_t nElem,
                        unsigned char* dataOut) const;
 
@@ -57,4 +94,4 @@ public:
                          unsigned char* dataOut) const;
 };
 
-} // namespace opensaft
\ No newline at end of file
+} // namespace opensaft
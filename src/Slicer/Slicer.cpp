@@ -1,3 +1,140 @@
 #include "Slicer/Slicer.h"
+#include "Util/ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 
-namespace opensaft {}
\ No newline at end of file
+namespace opensaft {
+
+namespace {
+
+/// rows of an oblique slice per task
+constexpr std::size_t obliqueRows = 16;
+
+/// trilinear interpolation between the voxel centers at integer indices
+float SampleTrilinear(const Volume& vol, const Float3& pos) {
+  const Size3 dims = vol.get_dims();
+  const float* voxels = vol.data();
+  std::size_t base[3];
+  float frac[3];
+  for (uint8_t iDim = 0; iDim < 3; iDim++) {
+    const float maxIdx = static_cast<float>(dims[iDim] - 1);
+    if (!(pos[iDim] >= 0.0f && pos[iDim] <= maxIdx))
+      return 0.0f;
+    const float lower = std::min(std::floor(pos[iDim]),
+                                 std::max(maxIdx - 1.0f, 0.0f));
+    base[iDim] = static_cast<std::size_t>(lower);
+    frac[iDim] = pos[iDim] - lower;
+  }
+
+  // neighbours beyond a single voxel thick dimension get a weight of 0
+  const std::size_t dx = (dims[0] > 1) ? 1 : 0;
+  const std::size_t dy = (dims[1] > 1) ? dims[0] : 0;
+  const std::size_t dz = (dims[2] > 1) ? dims[0] * dims[1] : 0;
+  const float* v = voxels + base[0] + dims[0] * (base[1] + dims[1] * base[2]);
+  const float c00 = v[0] + (v[dx] - v[0]) * frac[0];
+  const float c10 = v[dy] + (v[dy + dx] - v[dy]) * frac[0];
+  const float c01 = v[dz] + (v[dz + dx] - v[dz]) * frac[0];
+  const float c11 = v[dz + dy] + (v[dz + dy + dx] - v[dz + dy]) * frac[0];
+  const float c0 = c00 + (c10 - c00) * frac[1];
+  const float c1 = c01 + (c11 - c01) * frac[1];
+  return c0 + (c1 - c0) * frac[2];
+}
+
+} // namespace
+
+SliceView Slicer::GetStridedSlice(const Dimension dim,
+                                  const std::size_t index) const {
+  const std::size_t nX = m_vol.get_dim(0);
+  const std::size_t nY = m_vol.get_dim(1);
+  const std::size_t nZ = m_vol.get_dim(2);
+  const float* voxels = m_vol.data();
+  switch (dim) {
+  case Dimension::X:
+    if (index >= nX)
+      break;
+    return {voxels + index, nY, nZ, nX, nX * nY};
+  case Dimension::Y:
+    if (index >= nY)
+      break;
+    return {voxels + nX * index, nX, nZ, 1, nX * nY};
+  case Dimension::Z:
+    if (index >= nZ)
+      break;
+    return {voxels + nX * nY * index, nX, nY, 1, nX};
+  }
+  throw std::invalid_argument("slice index exceeds volume");
+}
+
+SliceView Slicer::GetSlice(const Dimension dim, const std::size_t index) {
+  const SliceView strided = GetStridedSlice(dim, index);
+  if (strided.IsContiguous())
+    return strided;
+
+  if (dim == Dimension::Y) {
+    // rows along x are contiguous, copy them one by one
+    m_yBuffer.resize(strided.size());
+    for (std::size_t z = 0; z < strided.nRows; z++)
+      std::copy_n(strided.data + z * strided.rowStride, strided.nCols,
+                  m_yBuffer.begin() + z * strided.nCols);
+    return {m_yBuffer.data(), strided.nCols, strided.nRows, 1,
+            strided.nCols};
+  }
+
+  const std::size_t xStart = index - index % BlockWidth;
+  const bool isStale = m_vol.get_version() != m_xVersion ||
+                       m_vol.get_dims() != m_xDims ||
+                       m_vol.data() != m_xVoxels;
+  if (xStart != m_xBlockStart || isStale)
+    TransposeBlock(xStart);
+  return {m_xBuffer.data() + (index - xStart) * strided.size(),
+          strided.nCols, strided.nRows, 1, strided.nCols};
+}
+
+void Slicer::TransposeBlock(const std::size_t xStart) {
+  const std::size_t nX = m_vol.get_dim(0);
+  const std::size_t nY = m_vol.get_dim(1);
+  const std::size_t nZ = m_vol.get_dim(2);
+  const std::size_t width = std::min(BlockWidth, nX - xStart);
+  const float* voxels = m_vol.data();
+  m_xBuffer.resize(BlockWidth * nY * nZ);
+
+  // tiles of BlockWidth x BlockWidth voxels: each row segment of the volume
+  // is a single cache line, each written run along y as well
+  ParallelFor(nZ, 0, [&](const std::size_t z) {
+    for (std::size_t yTile = 0; yTile < nY; yTile += BlockWidth) {
+      const std::size_t yStop = std::min(yTile + BlockWidth, nY);
+      for (std::size_t iX = 0; iX < width; iX++) {
+        float* out = m_xBuffer.data() + nY * (z + nZ * iX);
+        const float* in = voxels + xStart + iX + nX * nY * z;
+        for (std::size_t y = yTile; y < yStop; y++)
+          out[y] = in[nX * y];
+      }
+    }
+  });
+  m_xBlockStart = xStart;
+  m_xVersion = m_vol.get_version();
+  m_xDims = m_vol.get_dims();
+  m_xVoxels = voxels;
+}
+
+SliceView Slicer::GetObliqueSlice(const Float3& origin, const Float3& colAxis,
+                                  const Float3& rowAxis,
+                                  const std::size_t nCols,
+                                  const std::size_t nRows) {
+  m_obliqueBuffer.resize(nCols * nRows);
+  const std::size_t nTasks = (nRows + obliqueRows - 1) / obliqueRows;
+  ParallelFor(nTasks, 0, [&](const std::size_t iTask) {
+    const std::size_t rowStop = std::min((iTask + 1) * obliqueRows, nRows);
+    for (std::size_t iRow = iTask * obliqueRows; iRow < rowStop; iRow++) {
+      const Float3 rowStart = origin + rowAxis * static_cast<float>(iRow);
+      float* out = m_obliqueBuffer.data() + nCols * iRow;
+      for (std::size_t iCol = 0; iCol < nCols; iCol++)
+        out[iCol] = SampleTrilinear(
+            m_vol, rowStart + colAxis * static_cast<float>(iCol));
+    }
+  });
+  return {m_obliqueBuffer.data(), nCols, nRows, 1, nCols};
+}
+
+} // namespace opensaft
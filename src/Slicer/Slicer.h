@@ -1,11 +1,88 @@
+#include "Memory/Volume.h"
+#include "VectorN.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
+#pragma once
 
 namespace opensaft {
 
-/// converts a volume to a set of slices with a set of specified
-/// options
+/// non owning view of a 2D image with strides like std::mdspan with
+/// layout_stride, pixel (iCol, iRow) lies at data[iCol * colStride + iRow *
+/// rowStride]
+struct SliceView {
+  const float* data = nullptr;
+  std::size_t nCols = 0; //!< extent along the fast image axis
+  std::size_t nRows = 0;
+  std::size_t colStride = 1;
+  std::size_t rowStride = 0;
+
+  [[nodiscard]] float operator()(const std::size_t iCol,
+                                 const std::size_t iRow) const {
+    return data[iCol * colStride + iRow * rowStride];
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept { return nCols * nRows; }
+
+  /// \returns true if the pixels are stored row by row without gaps, so
+  /// data can be passed on as an image of nCols x nRows
+  [[nodiscard]] bool IsContiguous() const noexcept {
+    return colStride == 1 && (rowStride == nCols || nRows <= 1);
+  }
+};
+
+/// extracts slices of a volume for display. Slices normal to z are views of
+/// the volume, the others are copied into buffers which are reused, so
+/// scrolling does not allocate once the buffers have grown. Slices normal to
+/// x are transposed in blocks of neighbouring slices which share their cache
+/// lines, scrolling along x reads the volume only once per block.
+/// The volume needs to outlive the slicer. The blocks are transposed again
+/// once the version, the dims or the storage of the volume changed.
 class Slicer {
 public:
+  /// slices normal to x transposed at once, a cache line of floats
+  static constexpr std::size_t BlockWidth = 16;
+
+  explicit Slicer(const Volume& vol) : m_vol(vol) {}
+
+  /// \returns view of the voxels of the slice at index normal to dim without
+  /// copying, the image axes are the remaining dimensions in xyz order
+  [[nodiscard]] SliceView GetStridedSlice(const Dimension dim,
+                                          const std::size_t index) const;
+
+  /// \returns the same slice as GetStridedSlice, but contiguous. The view
+  /// stays valid until the next call for a slice normal to the same dim.
+  [[nodiscard]] SliceView GetSlice(const Dimension dim,
+                                   const std::size_t index);
+
+  /// samples nCols x nRows pixels of an oblique plane by trilinear
+  /// interpolation, pixel (iCol, iRow) lies at origin + iCol * colAxis +
+  /// iRow * rowAxis in voxel indices. Pixels outside of the volume are 0.
+  /// The view stays valid until the next oblique slice.
+  [[nodiscard]] SliceView GetObliqueSlice(const Float3& origin,
+                                          const Float3& colAxis,
+                                          const Float3& rowAxis,
+                                          const std::size_t nCols,
+                                          const std::size_t nRows);
+
+  /// drops the transposed blocks, needed only after writing through a
+  /// pointer or iterator obtained before the last slice normal to x
+  void Invalidate() noexcept { m_xBlockStart = noBlock; }
+
 private:
+  static constexpr std::size_t noBlock = static_cast<std::size_t>(-1);
+
+  void TransposeBlock(const std::size_t xStart);
+
+  const Volume& m_vol;
+  std::vector<float> m_yBuffer;       //!< slice normal to y
+  std::vector<float> m_xBuffer;       //!< BlockWidth slices normal to x
+  std::size_t m_xBlockStart = noBlock; //!< first slice in m_xBuffer
+  uint64_t m_xVersion = 0;             //!< volume version of m_xBuffer
+  Size3 m_xDims{0ul, 0ul, 0ul};        //!< volume dims of m_xBuffer
+  const float* m_xVoxels = nullptr;    //!< volume storage of m_xBuffer
+  std::vector<float> m_obliqueBuffer;
 };
-} // namespace opensaft
\ No newline at end of file
+
+} // namespace opensaft
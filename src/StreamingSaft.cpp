@@ -0,0 +1,123 @@
+#include "StreamingSaft.h"
+#include "Memory/BrickVolumeFile.h"
+#include "Memory/VolumeFile.h"
+#include "Processing/Preprocessor.h"
+#include "Recon/DelayTable.h"
+#include "Recon/SaftGeometry.h"
+#include "Saft.h"
+#include "Util/Timer.h"
+#include <algorithm>
+#include <format>
+#include <optional>
+
+namespace opensaft {
+
+void StreamingSaft::Run(const UltrasoundSignals& source,
+                        const std::string& outputPath) {
+  if (!source.IsRaster())
+    throw std::invalid_argument("input data is not a complete raster");
+
+  Timer T;
+  // the slabs are preprocessed straight from the source rows, so each one is
+  // held in memory only once and already cropped
+  Preprocessor preprocessor;
+  preprocessor.SetSettings(m_settings);
+  preprocessor.SetThreadCount(m_threadCount);
+  const auto [cropStart, cropStop] =
+      preprocessor.GetCropRange(source.get_properties(), source.get_nT());
+  const std::size_t nX = source.get_nX();
+  const std::size_t nY = source.get_nY();
+  const std::size_t nT = cropStop - cropStart;
+  const SaftGeometry geom = SaftGeometry::Create(
+      preprocessor.GetOutputProperties(source.get_properties(),
+                                       source.get_nT()),
+      nT, m_settings, m_transducer);
+
+  // every output row needs the input rows within the largest aperture, one
+  // additional row on each side as safety margin
+  m_haloRows = static_cast<std::size_t>(
+                   DelayTable::Get(geom)->get_maxOffsetY()) + 1;
+
+  // slab height such that its input rows incl. halo and output rows fit
+  const std::size_t bytesInRow =
+      nX * UltrasoundSignals::GetStride(nT) * sizeof(float);
+  const std::size_t bytesOutRow = nX * nT * sizeof(float);
+  // a slab never reads more than the full raster, even for huge apertures
+  const std::size_t bytesHalo = std::min(2 * m_haloRows, nY) * bytesInRow;
+  m_slabHeight = (m_memoryBudget > bytesHalo)
+                     ? (m_memoryBudget - bytesHalo) / (bytesInRow + bytesOutRow)
+                     : 0;
+  if (m_slabHeight == 0) {
+    Log(LogLevel::Warning, "Memory budget too small, using single row slabs");
+    m_slabHeight = 1;
+  }
+  if (m_outputFormat == VolumeFileFormat::Bricked && m_slabHeight < nY) {
+    if (m_slabHeight < m_brickSize)
+      Log(LogLevel::Warning, "Memory budget smaller than a row of bricks");
+    m_slabHeight = std::max(m_slabHeight / m_brickSize, std::size_t{1}) *
+                   m_brickSize;
+  }
+  m_slabHeight = std::min(m_slabHeight, nY);
+  m_peakBytes = std::min(m_slabHeight + 2 * m_haloRows, nY) * bytesInRow +
+                m_slabHeight * bytesOutRow;
+
+  const std::size_t nSlabs = (nY + m_slabHeight - 1) / m_slabHeight;
+  Log(std::format("Streaming {} slabs of {} rows (+{} halo rows), peak {} MB",
+                  nSlabs, m_slabHeight, m_haloRows, m_peakBytes >> 20));
+
+  const Float3 res = geom.GetVoxelSize();
+  m_outputDims = {nX, nY, nT};
+  const Float3 center = geom.GetCenter(Size3(), m_outputDims);
+  std::optional<VolumeFileWriter> rawWriter;
+  std::optional<BrickVolumeWriter> brickWriter;
+  if (m_outputFormat == VolumeFileFormat::Bricked)
+    brickWriter.emplace(outputPath, Size3{nX, nY, nT}, res, center,
+                        m_brickSize);
+  else
+    rawWriter.emplace(outputPath, Size3{nX, nY, nT}, res, center);
+
+  std::size_t nDropped = 0; //!< source rows released so far
+  for (std::size_t yStart = 0; yStart < nY; yStart += m_slabHeight) {
+    const std::size_t yStop = std::min(yStart + m_slabHeight, nY);
+    const std::size_t inStart = (yStart > m_haloRows) ? yStart - m_haloRows : 0;
+    const std::size_t inStop = std::min(yStop + m_haloRows, nY);
+
+    Saft saft;
+    saft.SetSettings(m_settings);
+    saft.SetTransducer(m_transducer);
+    saft.SetThreadCount(m_threadCount);
+    saft.SetSimdLevel(m_simdLevel);
+    saft.SetPreprocessedInput(preprocessor.Process(source, inStart, inStop));
+    Size3 regionStart;
+    regionStart[1] = yStart - inStart;
+    saft.SetRegion(regionStart, {nX, yStop - inStart, nT});
+    saft.Launch();
+    saft.Wait();
+    const Volume slab = saft.TakeVolume().value();
+    if (brickWriter.has_value())
+      brickWriter->WriteSlab(slab, yStart, m_threadCount);
+    else
+      rawWriter->WriteSlab(slab, yStart);
+
+    // rows in front of the next slab's halo are not needed anymore
+    const std::size_t nextInStart =
+        (yStop > m_haloRows) ? yStop - m_haloRows : 0;
+    source.DropCachedRows(nDropped, nextInStart);
+    nDropped = std::max(nDropped, nextInStart);
+    Log(std::format("Finished slab up to row {} of {}", yStop, nY));
+  }
+
+  if (brickWriter.has_value()) {
+    brickWriter->Finalize();
+    Log(std::format("Compressed volume to {:.1f} % of its raw size",
+                    100.0 * brickWriter->get_compressedBytes() /
+                        (nX * nY * nT * sizeof(float))));
+  }
+
+  T.Stop();
+  m_reconTime = T.GetElapsedTime();
+  Log(std::format("Streaming reconstruction finished after {} seconds",
+                  m_reconTime));
+}
+
+} // namespace opensaft
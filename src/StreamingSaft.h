@@ -0,0 +1,87 @@
+#include "Memory/UltrasoundSignals.h"
+#include "Recon/SimdKernel.h"
+#include "ReconSettings.h"
+#include "Transducer.h"
+#include "Util/Logger.h"
+#include "VectorN.h"
+#include <cstddef>
+#include <string>
+
+#pragma once
+
+namespace opensaft {
+
+/// on disk layout of the reconstructed volume, see docs/data_format.md
+enum class VolumeFileFormat {
+  Raw,     //!< uncompressed voxels, Volume::ReadFromFile
+  Bricked, //!< compressed bricks, BrickVolumeReader
+};
+
+/// out of core reconstruction for datasets larger than the available memory:
+/// the output is processed in slabs along y, each slab only copies the input
+/// rows within reach of the aperture and is written to disk when finished
+class StreamingSaft : LoggingClass {
+public:
+  void SetSettings(const ReconSettings& settings) { m_settings = settings; }
+  void SetTransducer(const Transducer& transducer) {
+    m_transducer = transducer;
+  }
+  void SetThreadCount(const unsigned int threadCount) {
+    m_threadCount = threadCount;
+  }
+  void SetSimdLevel(const SimdLevel level) { m_simdLevel = level; }
+
+  /// upper bound for the input and output samples held in memory [bytes]
+  void SetMemoryBudget(const std::size_t nBytes) { m_memoryBudget = nBytes; }
+
+  /// selects the output file format, bricked files round the slab height to
+  /// a multiple of brickSize so that every slab completes whole bricks
+  void SetOutputFormat(const VolumeFileFormat format,
+                       const std::size_t brickSize = 64) {
+    m_outputFormat = format;
+    m_brickSize = brickSize;
+  }
+
+  /// reconstructs source slab by slab and writes the volume to outputPath in
+  /// the selected output format. If source is memory mapped (see
+  /// UltrasoundSignals::ReadFromFile), rows which are not needed anymore are
+  /// released again, so source must not have been modified in memory.
+  void Run(const UltrasoundSignals& source, const std::string& outputPath);
+
+  /// \returns number of output rows along y reconstructed per slab
+  [[nodiscard]] std::size_t get_slabHeight() const noexcept {
+    return m_slabHeight;
+  }
+
+  /// \returns number of input rows added on each side of a slab
+  [[nodiscard]] std::size_t get_haloRows() const noexcept {
+    return m_haloRows;
+  }
+
+  /// \returns estimated peak memory of input and output samples [bytes]
+  [[nodiscard]] std::size_t get_peakBytes() const noexcept {
+    return m_peakBytes;
+  }
+
+  /// \returns dimensions of the volume written by the last Run
+  [[nodiscard]] Size3 get_outputDims() const noexcept { return m_outputDims; }
+
+  [[nodiscard]] double get_reconTime() const noexcept { return m_reconTime; }
+
+private:
+  ReconSettings m_settings;
+  Transducer m_transducer;
+  unsigned int m_threadCount = 0; //!< 0 uses all processor units
+  SimdLevel m_simdLevel = DetectSimdLevel();
+  std::size_t m_memoryBudget = std::size_t{4} << 30; //!< default 4 GiB
+  VolumeFileFormat m_outputFormat = VolumeFileFormat::Raw;
+  std::size_t m_brickSize = 64;
+
+  std::size_t m_slabHeight = 0;
+  std::size_t m_haloRows = 0;
+  std::size_t m_peakBytes = 0;
+  Size3 m_outputDims;
+  double m_reconTime = 0.0;
+};
+
+} // namespace opensaft
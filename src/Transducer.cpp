@@ -24,4 +24,4 @@ void Transducer::set_rHole(const float _rHole) {
   rHole = _rHole;
 }
 
-}
\ No newline at end of file
+} // namespace opensaft
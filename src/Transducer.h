@@ -32,6 +32,8 @@ public:
     return asin(rAperture / focalDistance);
   };
 
+  bool operator==(const Transducer& other) const = default;
+
 private:
   float focalDistance = 7.0f; //!< focal distance of transducer [mm]
   float rAperture = 3.2f;     //!< radius of aperture of transducer [mm]
@@ -1,10 +1,19 @@
 #include "Util/Logger.h"
 #include <chrono>
+#include <cstdint>
 #include <cxxabi.h>
+#include <ctime>
 #include <iostream>
+#include <memory>
+#include <thread>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
 
 namespace opensaft {
 
+namespace {
+
 std::string demangle(const char* name) {
 
   int status = -4; // some arbitrary value to eliminate the compiler warning
@@ -16,30 +25,204 @@ std::string demangle(const char* name) {
   return (status == 0) ? res.get() : name;
 }
 
-std::string Logger::GetTimestamp() {
-  // get current time
-  auto now = std::chrono::system_clock::now();
-  // convert to time_t
-  auto now_c = std::chrono::system_clock::to_time_t(now);
-  // convert to string
-  std::stringstream ss;
-  ss << std::put_time(std::localtime(&now_c), "%F %T");
-  return ss.str();
+/// \returns the local time as "%F %T", formatted once per second and thread
+const std::string&
+GetTimestamp(const std::chrono::system_clock::time_point now) {
+  thread_local std::time_t lastTime = -1;
+  thread_local std::string timestamp;
+  const std::time_t nowTime = std::chrono::system_clock::to_time_t(now);
+  if (nowTime != lastTime) {
+    std::tm local;
+    localtime_r(&nowTime, &local);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%F %T", &local);
+    timestamp = buffer;
+    lastTime = nowTime;
+  }
+  return timestamp;
+}
+
+struct LogRecord {
+  std::atomic<LogRecord*> next = nullptr;
+  std::chrono::system_clock::time_point time;
+  LogLevel level = LogLevel::Info;
+  std::string origin;
+  std::string message;
+};
+
+/// writes the record as one line, so lines of several threads do not mix
+void Write(const LogRecord& record) {
+  std::string line = GetTimestamp(record.time);
+  line += " (";
+  line += LogLevelNames[static_cast<std::size_t>(record.level)];
+  line += ")";
+  if (!record.origin.empty()) {
+    line += " [";
+    line += record.origin;
+    line += "] ";
+  }
+  line += record.message;
+  line += '\n';
+  std::cout << line;
+}
+
+/// intrusive multi producer single consumer queue after Dmitry Vyukov:
+/// producers exchange the head in one atomic operation and never wait,
+/// the single consumer pops from the tail
+class LogQueue {
+public:
+  LogQueue() : m_head(&m_stub), m_tail(&m_stub) {}
+
+  void Push(LogRecord* record) {
+    record->next.store(nullptr, std::memory_order_relaxed);
+    LogRecord* prev = m_head.exchange(record, std::memory_order_acq_rel);
+    prev->next.store(record, std::memory_order_release);
+  }
+
+  /// \returns the oldest record, nullptr if the queue is empty or the oldest
+  /// record is still being linked by its producer
+  LogRecord* Pop() {
+    LogRecord* tail = m_tail;
+    LogRecord* next = tail->next.load(std::memory_order_acquire);
+    if (tail == &m_stub) {
+      if (next == nullptr)
+        return nullptr;
+      m_tail = next;
+      tail = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+    if (next != nullptr) {
+      m_tail = next;
+      return tail;
+    }
+    if (tail != m_head.load(std::memory_order_acquire))
+      return nullptr;
+    // tail is the last record, the stub takes its place
+    Push(&m_stub);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next == nullptr)
+      return nullptr;
+    m_tail = next;
+    return tail;
+  }
+
+private:
+  LogRecord m_stub;
+  std::atomic<LogRecord*> m_head;
+  LogRecord* m_tail; //!< only accessed by the consumer
+};
+
+/// background thread draining the queue, started on first use and stopped
+/// after writing all pending messages at exit
+class AsyncWriter {
+public:
+  AsyncWriter() : m_thread([this] { Run(); }) {}
+
+  ~AsyncWriter() {
+    m_isStopping.store(true, std::memory_order_release);
+    Signal();
+    m_thread.join();
+  }
+
+  void Push(std::unique_ptr<LogRecord> record) {
+    m_queue.Push(record.release());
+    m_nPushed.fetch_add(1, std::memory_order_release);
+    Signal();
+  }
+
+  void Flush() {
+    const uint64_t nPushed = m_nPushed.load(std::memory_order_acquire);
+    uint64_t nWritten = m_nWritten.load(std::memory_order_acquire);
+    while (nWritten < nPushed) {
+      m_nWritten.wait(nWritten, std::memory_order_acquire);
+      nWritten = m_nWritten.load(std::memory_order_acquire);
+    }
+  }
+
+private:
+  void Signal() {
+    m_signal.fetch_add(1, std::memory_order_release);
+    m_signal.notify_one();
+  }
+
+  void Run() {
+    while (true) {
+      const uint32_t signal = m_signal.load(std::memory_order_acquire);
+      uint64_t nWritten = 0;
+      while (LogRecord* record = m_queue.Pop()) {
+        const std::unique_ptr<LogRecord> owner(record);
+        Write(*record);
+        nWritten++;
+      }
+      if (nWritten > 0) {
+        std::cout.flush();
+        m_nWritten.fetch_add(nWritten, std::memory_order_release);
+        m_nWritten.notify_all();
+        continue;
+      }
+      if (m_isStopping.load(std::memory_order_acquire) &&
+          m_nWritten.load() == m_nPushed.load())
+        return;
+      m_signal.wait(signal, std::memory_order_acquire);
+    }
+  }
+
+  LogQueue m_queue;
+  std::atomic<uint64_t> m_nPushed = 0;
+  std::atomic<uint64_t> m_nWritten = 0;
+  std::atomic<uint32_t> m_signal = 0; //!< changed on every push and at exit
+  std::atomic<bool> m_isStopping = false;
+  std::thread m_thread; //!< last member, starts after the others exist
+};
+
+AsyncWriter& GetAsyncWriter() {
+  static AsyncWriter writer;
+  return writer;
 }
 
+} // namespace
+
 void Logger::Log(LogHeader header, const std::string& message) {
+  if (!IsEnabled(header.level))
+    return;
+
+  auto record = std::make_unique<LogRecord>();
+  record->time = std::chrono::system_clock::now();
+  record->level = header.level;
+  record->origin = std::move(header.origin);
+  record->message = message;
+  if (IsAsync()) {
+    GetAsyncWriter().Push(std::move(record));
+    return;
+  }
+
   // log message to console
-  std::cout << GetTimestamp() << " ("
-            << LogLevelNames[static_cast<std::size_t>(header.level)] << ")";
-  if (!header.origin.empty())
-    std::cout << " [" << header.origin << "] ";
-  std::cout << message << std::endl;
+  Write(*record);
+  std::cout.flush();
 }
 
 void Logger::Log(const std::string& message) { Log(LogLevel::Info, message); }
 
-std::string LoggingClass::GetName() const {
-  return demangle(typeid(*this).name());
+void Logger::SetAsync(const bool isAsync) {
+  if (isAsync)
+    GetAsyncWriter();
+  if (s_isAsync.exchange(isAsync) && !isAsync)
+    GetAsyncWriter().Flush();
+}
+
+void Logger::Flush() {
+  if (IsAsync())
+    GetAsyncWriter().Flush();
+}
+
+const std::string& LoggingClass::GetName() const {
+  // demangling allocates, so each thread keeps the names it has seen
+  thread_local std::unordered_map<std::type_index, std::string> names;
+  const std::type_index type(typeid(*this));
+  auto iName = names.find(type);
+  if (iName == names.end())
+    iName = names.emplace(type, demangle(type.name())).first;
+  return iName->second;
 }
 
-} // namespace opensaft
\ No newline at end of file
+} // namespace opensaft
@@ -1,9 +1,15 @@
-
 #include <array>
+#include <atomic>
 #include <string>
 
 #pragma once
 
+/// messages below this level are compiled out, set by the cmake cache
+/// variable of the same name (0: Debug ... 4: Critical)
+#ifndef OPENSAFT_LOG_LEVEL
+#define OPENSAFT_LOG_LEVEL 0
+#endif
+
 namespace opensaft {
 
 enum class LogLevel : int {
@@ -15,6 +21,9 @@ enum class LogLevel : int {
   _Count //!< number of log types
 };
 
+/// lowest level that is compiled in
+constexpr LogLevel CompiledLogLevel = static_cast<LogLevel>(OPENSAFT_LOG_LEVEL);
+
 struct LogHeader {
   LogLevel level;
   std::string origin = "";
@@ -35,22 +44,47 @@ public:
   /// will default to LogLevel::Info
   static void Log(const std::string& message);
 
+  /// messages below level are dropped (default LogLevel::Debug)
+  static void SetLevel(const LogLevel level) { s_level = level; }
+  [[nodiscard]] static LogLevel GetLevel() { return s_level; }
+
+  /// \returns if messages of level are written, hot paths check this before
+  /// formatting a message. Constant false below CompiledLogLevel.
+  [[nodiscard]] static bool IsEnabled(const LogLevel level) {
+    return (level >= CompiledLogLevel) &&
+           (level >= s_level.load(std::memory_order_relaxed));
+  }
+
+  /// in asynchronous mode Log only enqueues the message into a lock free
+  /// queue, a background thread formats and writes it (default off).
+  /// Switching it off flushes the queue.
+  static void SetAsync(const bool isAsync);
+  [[nodiscard]] static bool IsAsync() {
+    return s_isAsync.load(std::memory_order_relaxed);
+  }
+
+  /// blocks until all messages logged before are written
+  static void Flush();
+
 private:
-  static std::string GetTimestamp();
+  static inline std::atomic<LogLevel> s_level = LogLevel::Debug;
+  static inline std::atomic<bool> s_isAsync = false;
 };
 
 /// this class is used to inherit from and automatically populate the name tag
 class LoggingClass {
 public:
   void Log(LogLevel level, const std::string& message) const {
-    Logger::Log({level, GetName()}, message);
+    if (Logger::IsEnabled(level))
+      Logger::Log({level, GetName()}, message);
   }
 
   void Log(const std::string& message) const {
-    Logger::Log({LogLevel::Info, GetName()}, message);
+    Log(LogLevel::Info, message);
   }
 
 private:
-  virtual std::string GetName() const;
+  /// demangled name of the dynamic type, cached per thread
+  virtual const std::string& GetName() const;
 };
-} // namespace opensaft
\ No newline at end of file
+} // namespace opensaft
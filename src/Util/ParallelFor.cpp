@@ -0,0 +1,78 @@
+#include "Util/ParallelFor.h"
+#include "Util/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace opensaft {
+
+namespace {
+
+/// state shared between the caller of ParallelFor and its helper tasks,
+/// helpers may start only after the caller returned
+struct ParallelForState {
+  std::atomic<std::size_t> next = 0;
+  std::mutex mutex;                //!< guards the members below
+  std::condition_variable idle;    //!< signaled when a helper finishes
+  std::size_t nActive = 0;         //!< helpers currently calling body
+  bool isClosed = false;           //!< late helpers return immediately
+  std::exception_ptr error;        //!< first exception thrown by body
+};
+
+} // namespace
+
+unsigned int ResolveThreadCount(const unsigned int threadCount) {
+  if (threadCount > 0)
+    return threadCount;
+  return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+void ParallelFor(const std::size_t n, const unsigned int threadCount,
+                 const std::function<void(std::size_t)>& body) {
+  const auto state = std::make_shared<ParallelForState>();
+  const auto work = [&body, n](ParallelForState& shared) {
+    try {
+      for (std::size_t i = shared.next++; i < n; i = shared.next++)
+        body(i);
+    } catch (...) {
+      std::scoped_lock lock(shared.mutex);
+      if (!shared.error)
+        shared.error = std::current_exception();
+      shared.next = n;
+    }
+  };
+
+  // the helpers run on the shared pool, if it is busy the calling thread
+  // simply processes more indices itself
+  const std::size_t nThreads =
+      std::min<std::size_t>(ResolveThreadCount(threadCount), n);
+  for (std::size_t iThread = 1; iThread < nThreads; iThread++) {
+    ThreadPool::GetShared().Submit([state, work]() {
+      {
+        std::scoped_lock lock(state->mutex);
+        if (state->isClosed)
+          return;
+        state->nActive++;
+      }
+      work(*state);
+      {
+        std::scoped_lock lock(state->mutex);
+        state->nActive--;
+      }
+      state->idle.notify_all();
+    });
+  }
+  work(*state);
+
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->isClosed = true;
+  state->idle.wait(lock, [&state] { return state->nActive == 0; });
+  if (state->error)
+    std::rethrow_exception(state->error);
+}
+
+} // namespace opensaft
@@ -0,0 +1,20 @@
+#include <cstddef>
+#include <functional>
+
+#pragma once
+
+namespace opensaft {
+
+/// \returns threadCount or the number of processor units if it is 0
+[[nodiscard]] unsigned int ResolveThreadCount(const unsigned int threadCount);
+
+/// calls body(i) for all i in [0, n) on up to threadCount threads (0 uses all
+/// processor units), the calling thread takes part and the others are taken
+/// from the shared ThreadPool as they become free. Indices are handed out
+/// one at a time in increasing order, so each should carry a reasonable
+/// amount of work. The first exception thrown by body stops the remaining
+/// indices and is rethrown.
+void ParallelFor(const std::size_t n, const unsigned int threadCount,
+                 const std::function<void(std::size_t)>& body);
+
+} // namespace opensaft
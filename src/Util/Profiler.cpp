@@ -0,0 +1,195 @@
+#include "Util/Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace opensaft {
+
+namespace {
+
+struct ProfileEvent {
+  const char* name;
+  int64_t start; //!< [ns]
+  int64_t stop;  //!< [ns]
+};
+
+/// running sums of one zone name within a thread
+struct ZoneTotal {
+  const char* name;
+  std::size_t count = 0;
+  int64_t duration = 0; //!< [ns]
+};
+
+struct ThreadBuffer {
+  std::size_t threadIndex = 0; //!< in order of the first recorded zone
+  std::vector<ProfileEvent> events =
+      std::vector<ProfileEvent>(Profiler::Capacity);
+  std::atomic<uint64_t> nWritten = 0;
+  std::vector<ZoneTotal> totals; //!< few names, searched linearly
+};
+
+struct ProfileRegistry {
+  std::mutex mutex;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  std::chrono::steady_clock::time_point epoch =
+      std::chrono::steady_clock::now();
+};
+
+ProfileRegistry& GetRegistry() {
+  static ProfileRegistry registry;
+  return registry;
+}
+
+/// the registry shares ownership, so events of finished threads survive
+ThreadBuffer& GetThreadBuffer() {
+  thread_local const std::shared_ptr<ThreadBuffer> buffer = [] {
+    ProfileRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto newBuffer = std::make_shared<ThreadBuffer>();
+    newBuffer->threadIndex = registry.buffers.size();
+    registry.buffers.push_back(newBuffer);
+    return newBuffer;
+  }();
+  return *buffer;
+}
+
+/// zone names are literals, but escape them in case of quotes
+std::string EscapeJson(const char* text) {
+  std::string escaped;
+  for (const char* c = text; *c != '\0'; c++) {
+    if (*c == '"' || *c == '\\')
+      escaped.push_back('\\');
+    escaped.push_back(*c);
+  }
+  return escaped;
+}
+
+} // namespace
+
+int64_t Profiler::Now() noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - GetRegistry().epoch)
+      .count();
+}
+
+void Profiler::Record(const char* name, const int64_t start,
+                      const int64_t stop) {
+  ThreadBuffer& buffer = GetThreadBuffer();
+  const uint64_t iEvent = buffer.nWritten.load(std::memory_order_relaxed);
+  buffer.events[iEvent % Capacity] = {name, start, stop};
+  buffer.nWritten.store(iEvent + 1, std::memory_order_release);
+
+  auto total = std::find_if(
+      buffer.totals.begin(), buffer.totals.end(), [name](const ZoneTotal& t) {
+        return t.name == name || std::strcmp(t.name, name) == 0;
+      });
+  if (total == buffer.totals.end())
+    total = buffer.totals.insert(total, {name});
+  total->count++;
+  total->duration += stop - start;
+}
+
+void Profiler::Clear() {
+  ProfileRegistry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (auto& buffer : registry.buffers) {
+    buffer->nWritten.store(0, std::memory_order_relaxed);
+    buffer->totals.clear();
+  }
+}
+
+std::string Profiler::ToChromeTrace() {
+  ProfileRegistry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+
+  std::string trace = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool isFirst = true;
+  const auto append = [&trace, &isFirst](const std::string& event) {
+    if (!isFirst)
+      trace += ",\n";
+    trace += event;
+    isFirst = false;
+  };
+
+  for (const auto& buffer : registry.buffers) {
+    const uint64_t nWritten =
+        buffer->nWritten.load(std::memory_order_acquire);
+    if (nWritten == 0)
+      continue;
+    const std::size_t tid = buffer->threadIndex;
+    append(std::format("{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                       "\"tid\":{},\"args\":{{\"name\":\"thread {}\"}}}}",
+                       tid, tid));
+    const uint64_t first = nWritten > Capacity ? nWritten - Capacity : 0;
+    for (uint64_t iEvent = first; iEvent < nWritten; iEvent++) {
+      const ProfileEvent& event = buffer->events[iEvent % Capacity];
+      // complete events, timestamps in microseconds
+      append(std::format("{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,"
+                         "\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+                         EscapeJson(event.name), tid, event.start * 1e-3,
+                         (event.stop - event.start) * 1e-3));
+    }
+  }
+  trace += "]}\n";
+  return trace;
+}
+
+void Profiler::WriteChromeTrace(const std::string& filePath) {
+  std::ofstream file(filePath);
+  if (!file)
+    throw std::invalid_argument(
+        std::format("cannot open {} for writing", filePath));
+  file << ToChromeTrace();
+}
+
+std::vector<ProfileZoneStats> Profiler::GetZoneStats() {
+  ProfileRegistry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+
+  std::map<std::string, ProfileZoneStats> statsByName;
+  for (const auto& buffer : registry.buffers) {
+    for (const ZoneTotal& total : buffer->totals) {
+      ProfileZoneStats& stats = statsByName[total.name];
+      const double threadTime = total.duration * 1e-9;
+      stats.minThreadTime = stats.nThreads == 0
+                                ? threadTime
+                                : std::min(stats.minThreadTime, threadTime);
+      stats.maxThreadTime = std::max(stats.maxThreadTime, threadTime);
+      stats.totalTime += threadTime;
+      stats.count += total.count;
+      stats.nThreads++;
+    }
+  }
+
+  std::vector<ProfileZoneStats> zoneStats;
+  for (auto& [name, stats] : statsByName) {
+    stats.name = name;
+    zoneStats.push_back(stats);
+  }
+  std::sort(zoneStats.begin(), zoneStats.end(),
+            [](const ProfileZoneStats& a, const ProfileZoneStats& b) {
+              return a.totalTime > b.totalTime;
+            });
+  return zoneStats;
+}
+
+std::size_t Profiler::get_nDropped() {
+  ProfileRegistry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::size_t nDropped = 0;
+  for (const auto& buffer : registry.buffers) {
+    const uint64_t nWritten =
+        buffer->nWritten.load(std::memory_order_relaxed);
+    if (nWritten > Capacity)
+      nDropped += nWritten - Capacity;
+  }
+  return nDropped;
+}
+
+} // namespace opensaft
@@ -0,0 +1,84 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#pragma once
+
+namespace opensaft {
+
+/// durations of one zone summed per thread, see Profiler::GetZoneStats
+struct ProfileZoneStats {
+  std::string name;
+  std::size_t count = 0;      //!< number of times the zone was entered
+  std::size_t nThreads = 0;   //!< threads which entered the zone
+  double totalTime = 0.0;     //!< summed over all threads [s]
+  double minThreadTime = 0.0; //!< least busy of these threads [s]
+  double maxThreadTime = 0.0; //!< most busy of these threads [s]
+};
+
+/// collects the durations of scoped zones (see ProfileZone) of the pipeline
+/// stages. Each thread records into its own ring buffer without locking, the
+/// newest Capacity events per thread are kept for the trace while the zone
+/// statistics cover all events. While disabled (default), a zone costs a
+/// single relaxed atomic load.
+class Profiler {
+public:
+  static constexpr std::size_t Capacity = std::size_t{1} << 15;
+
+  static void Enable(const bool isEnabled) {
+    s_isEnabled.store(isEnabled, std::memory_order_relaxed);
+  }
+  [[nodiscard]] static bool IsEnabled() noexcept {
+    return s_isEnabled.load(std::memory_order_relaxed);
+  }
+
+  /// \returns nanoseconds since the first use of the profiler
+  [[nodiscard]] static int64_t Now() noexcept;
+
+  /// appends a zone to the buffer of the calling thread, name needs to live
+  /// as long as the profiler (string literal)
+  static void Record(const char* name, const int64_t start,
+                     const int64_t stop);
+
+  /// drops all recorded events. The functions below read the buffers of all
+  /// threads, so no zone may be recorded while they run.
+  static void Clear();
+
+  /// \returns the events as Chrome trace event JSON, viewable in
+  /// chrome://tracing or Perfetto, one track per thread
+  [[nodiscard]] static std::string ToChromeTrace();
+  static void WriteChromeTrace(const std::string& filePath);
+
+  /// \returns the statistics of each zone name, sorted by total time
+  [[nodiscard]] static std::vector<ProfileZoneStats> GetZoneStats();
+
+  /// \returns number of events which were overwritten in the ring buffers
+  [[nodiscard]] static std::size_t get_nDropped();
+
+private:
+  static inline std::atomic<bool> s_isEnabled = false;
+};
+
+/// measures the time from its construction to its destruction if the
+/// profiler is enabled, e.g. ProfileZone zone("RemoveDC");
+class ProfileZone {
+public:
+  explicit ProfileZone(const char* name) noexcept
+      : m_name(name), m_start(Profiler::IsEnabled() ? Profiler::Now() : -1) {}
+
+  ~ProfileZone() {
+    if (m_start >= 0)
+      Profiler::Record(m_name, m_start, Profiler::Now());
+  }
+
+  ProfileZone(const ProfileZone&) = delete;
+  ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+  const char* m_name;
+  int64_t m_start; //!< -1 if the profiler was disabled
+};
+
+} // namespace opensaft
@@ -0,0 +1,52 @@
+#include "Util/ThreadPool.h"
+#include "Util/ParallelFor.h"
+
+namespace opensaft {
+
+ThreadPool::ThreadPool(const unsigned int nThreads) {
+  const unsigned int nWorkers = ResolveThreadCount(nThreads);
+  m_workers.reserve(nWorkers);
+  for (unsigned int iWorker = 0; iWorker < nWorkers; iWorker++)
+    m_workers.emplace_back(&ThreadPool::Work, this);
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_isStopping = true;
+  }
+  m_taskAdded.notify_all();
+  for (auto& worker : m_workers)
+    worker.join();
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tasks.push_back(std::move(task));
+  }
+  m_taskAdded.notify_one();
+}
+
+ThreadPool& ThreadPool::GetShared() {
+  static ThreadPool pool(0);
+  return pool;
+}
+
+void ThreadPool::Work() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_taskAdded.wait(lock,
+                       [this] { return m_isStopping || !m_tasks.empty(); });
+      if (m_tasks.empty())
+        return;
+      task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+    }
+    task();
+  }
+}
+
+} // namespace opensaft
@@ -0,0 +1,48 @@
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#pragma once
+
+namespace opensaft {
+
+/// fixed set of worker threads executing tasks in submission order. The
+/// shared instance is used by ParallelFor, so that everything running in
+/// the process at the same time competes for the same threads instead of
+/// spawning its own.
+class ThreadPool {
+public:
+  /// starts nThreads workers (0 uses all processor units)
+  explicit ThreadPool(const unsigned int nThreads);
+
+  /// runs the tasks still queued, then joins the workers
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /// queues a task, tasks must not throw
+  void Submit(std::function<void()> task);
+
+  [[nodiscard]] unsigned int get_nThreads() const noexcept {
+    return static_cast<unsigned int>(m_workers.size());
+  }
+
+  /// \returns the process wide pool with one worker per processor unit
+  [[nodiscard]] static ThreadPool& GetShared();
+
+private:
+  /// executes tasks until the pool is destroyed and the queue is empty
+  void Work();
+
+  std::mutex m_mutex;                        //!< guards queue and flag
+  std::condition_variable m_taskAdded;       //!< wakes idle workers
+  std::deque<std::function<void()>> m_tasks; //!< tasks not started yet
+  bool m_isStopping = false;                 //!< set by the destructor
+  std::vector<std::thread> m_workers;
+};
+
+} // namespace opensaft
@@ -0,0 +1,91 @@
+#include "Util/TileScheduler.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace opensaft {
+
+TileScheduler::TileScheduler(std::vector<Tile> tiles,
+                             const std::size_t nWorkers) {
+  if (nWorkers == 0)
+    throw std::invalid_argument("scheduler needs at least one worker");
+
+  for (std::size_t iWorker = 0; iWorker < nWorkers; iWorker++)
+    m_queues.push_back(std::make_unique<WorkerQueue>());
+
+  // longest processing time first: dealing sorted tiles round robin keeps
+  // every queue sorted by descending cost
+  std::stable_sort(
+      tiles.begin(), tiles.end(),
+      [](const Tile& a, const Tile& b) { return a.cost > b.cost; });
+  for (std::size_t iTile = 0; iTile < tiles.size(); iTile++)
+    m_queues[iTile % nWorkers]->tiles.push_back(tiles[iTile]);
+}
+
+std::optional<Tile> TileScheduler::Pop(const std::size_t workerId) {
+  if (auto tile = PopOwn(*m_queues[workerId % m_queues.size()]))
+    return tile;
+
+  // own queue is empty, try all other workers in turn
+  for (std::size_t iOffset = 1; iOffset < m_queues.size(); iOffset++) {
+    const std::size_t iVictim = (workerId + iOffset) % m_queues.size();
+    if (auto tile = Steal(*m_queues[iVictim]))
+      return tile;
+  }
+  return std::nullopt;
+}
+
+std::optional<Tile> TileScheduler::PopOwn(WorkerQueue& queue) {
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.tiles.empty())
+    return std::nullopt;
+
+  Tile tile = queue.tiles.front();
+  queue.tiles.pop_front();
+  return tile;
+}
+
+std::optional<Tile> TileScheduler::Steal(WorkerQueue& queue) {
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.tiles.empty())
+    return std::nullopt;
+
+  Tile tile = queue.tiles.back();
+  queue.tiles.pop_back();
+  queue.nStolen++;
+  return tile;
+}
+
+std::size_t TileScheduler::get_nStolen() const {
+  std::size_t nStolen = 0;
+  for (const auto& queue : m_queues) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    nStolen += queue->nStolen;
+  }
+  return nStolen;
+}
+
+std::vector<Tile> TileScheduler::Partition(const Size3& dims,
+                                           const Size3& tileSize) {
+  for (std::size_t iDim = 0; iDim < 3; iDim++) {
+    if (tileSize[iDim] == 0)
+      throw std::invalid_argument("tile size must be positive");
+  }
+
+  std::vector<Tile> tiles;
+  for (std::size_t z = 0; z < dims[2]; z += tileSize[2]) {
+    for (std::size_t y = 0; y < dims[1]; y += tileSize[1]) {
+      for (std::size_t x = 0; x < dims[0]; x += tileSize[0]) {
+        Tile tile;
+        tile.start = Size3{x, y, z};
+        tile.stop = Size3{std::min(x + tileSize[0], dims[0]),
+                          std::min(y + tileSize[1], dims[1]),
+                          std::min(z + tileSize[2], dims[2])};
+        tile.cost = static_cast<double>(tile.get_nVoxels());
+        tiles.push_back(tile);
+      }
+    }
+  }
+  return tiles;
+}
+
+} // namespace opensaft
@@ -0,0 +1,60 @@
+#include "VectorN.h"
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#pragma once
+
+namespace opensaft {
+
+/// a box shaped block of voxels [start, stop) processed as one work item
+struct Tile {
+  Size3 start;       //!< first voxel of the tile along xyz
+  Size3 stop;        //!< one past the last voxel of the tile along xyz
+  double cost = 0.0; //!< estimated cost, expensive tiles are handed out first
+
+  [[nodiscard]] std::size_t get_nVoxels() const {
+    return (stop[0] - start[0]) * (stop[1] - start[1]) * (stop[2] - start[2]);
+  }
+};
+
+/// distributes tiles over a fixed number of workers, each worker owns a deque
+/// and steals from the others once it runs dry
+class TileScheduler {
+public:
+  /// sorts the tiles by descending cost and deals them out to the workers
+  TileScheduler(std::vector<Tile> tiles, const std::size_t nWorkers);
+
+  /// \returns the next tile for a worker or nullopt if all tiles are taken
+  [[nodiscard]] std::optional<Tile> Pop(const std::size_t workerId);
+
+  [[nodiscard]] std::size_t get_nWorkers() const noexcept {
+    return m_queues.size();
+  }
+
+  /// \returns number of tiles handed out by stealing so far
+  [[nodiscard]] std::size_t get_nStolen() const;
+
+  /// splits a volume of size dims into tiles of (at most) size tileSize
+  [[nodiscard]] static std::vector<Tile> Partition(const Size3& dims,
+                                                   const Size3& tileSize);
+
+private:
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<Tile> tiles;
+    std::size_t nStolen = 0; //!< tiles other workers took from this queue
+  };
+
+  /// pops the most expensive tile of the workers own queue
+  std::optional<Tile> PopOwn(WorkerQueue& queue);
+
+  /// takes the cheapest tile from the back of a victims queue
+  std::optional<Tile> Steal(WorkerQueue& queue);
+
+  std::vector<std::unique_ptr<WorkerQueue>> m_queues; //!< one per worker
+};
+
+} // namespace opensaft
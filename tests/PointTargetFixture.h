@@ -0,0 +1,73 @@
+#include "Memory/UltrasoundSignals.h"
+#include "Memory/Volume.h"
+#include "ReconSettings.h"
+#include "Saft.h"
+#include "Simulation/PointSourceSimulator.h"
+#include "Transducer.h"
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#pragma once
+
+namespace opensaft {
+
+/// simulated acquisition of point absorbers shared by the tests and the
+/// benchmarks: a raster with 20 um pitch sampled at 100 MHz, starting
+/// 6.5 mm in front of the focus. Absorbers are placed at voxels of the
+/// reconstructed volume.
+struct PointTargetFixture {
+  std::size_t nX = 31;
+  std::size_t nY = 27;
+  std::size_t nT = 200;
+  ReconSettings settings;
+  Transducer transducer;
+  PulseShape pulse = PulseShape::NShape;
+  float noise = 0.0f; //!< standard deviation of the added noise
+
+  /// adds an absorber reconstructed at the voxel (iX, iY, iZ)
+  void AddTarget(const Size3& voxel, const float amplitude = 1.0f) {
+    m_targets.emplace_back(voxel, amplitude);
+  }
+
+  [[nodiscard]] AcquisitionProperties GetProperties() const {
+    AcquisitionProperties props;
+    props.nX = nX;
+    props.nY = nY;
+    props.dx = 20e-6f;
+    props.dy = 20e-6f;
+    props.sampleRate = 100e6f;
+    props.t0 = 6.5e-3f / settings.get_sos();
+    return props;
+  }
+
+  [[nodiscard]] UltrasoundSignals Simulate() const {
+    PointSourceSimulator sim;
+    sim.SetAcquisition(GetProperties(), nT);
+    sim.SetSettings(settings);
+    sim.SetTransducer(transducer);
+    sim.SetPulse(pulse, 30e6f);
+    sim.SetNoise(noise);
+    for (const auto& [voxel, amplitude] : m_targets)
+      sim.AddAbsorber(
+          {sim.GetVoxelPosition(voxel[0], voxel[1], voxel[2]), amplitude});
+    return sim.Simulate();
+  }
+
+  /// reconstructs sigs in memory with the settings of the fixture
+  [[nodiscard]] Volume Reconstruct(const UltrasoundSignals& sigs,
+                                   const unsigned int threadCount = 2) const {
+    Saft S;
+    S.SetSettings(settings);
+    S.SetTransducer(transducer);
+    S.SetThreadCount(threadCount);
+    S.SetInput(UltrasoundSignals(sigs));
+    S.Run();
+    return S.TakeVolume().value();
+  }
+
+private:
+  std::vector<std::pair<Size3, float>> m_targets;
+};
+
+} // namespace opensaft
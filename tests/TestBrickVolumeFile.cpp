@@ -0,0 +1,140 @@
+#include "Memory/BrickVolumeFile.h"
+#include "catch2/catch_test_macros.hpp"
+#include <catch2/catch_all.hpp>
+#include <cmath>
+#include <filesystem>
+#include <random>
+
+using namespace opensaft;
+
+namespace {
+
+/// smooth signal with a sparse region of zeros and a bit of noise
+Volume CreateVolume(const Size3& dims) {
+  std::mt19937 gen(11);
+  std::normal_distribution<float> noise(0.0f, 1e-3f);
+  Volume vol(dims);
+  for (std::size_t z = 0; z < dims[2]; z++) {
+    for (std::size_t y = 0; y < dims[1]; y++) {
+      for (std::size_t x = 0; x < dims[0]; x++) {
+        if (z < dims[2] / 2)
+          continue;
+        vol(x, y, z) = std::sin(0.3f * x) * std::cos(0.2f * z) + noise(gen);
+      }
+    }
+  }
+  vol.set_res({1e-5f, 2e-5f, 3e-5f});
+  vol.set_center({1e-3f, -2e-3f, 5e-3f});
+  return vol;
+}
+
+std::string GetTempPath() {
+  return (std::filesystem::temp_directory_path() / "opensaft_bricks.bvol")
+      .string();
+}
+
+} // namespace
+
+TEST_CASE("BrickCodec: lossless round trip") {
+  const Volume vol = CreateVolume({17ul, 9ul, 12ul});
+  BrickCodec codec;
+  const std::vector<uint8_t> data = CompressBrick(vol, codec);
+  REQUIRE(codec == BrickCodec::XorRle);
+  REQUIRE(data.size() < vol.size() * sizeof(float));
+
+  std::vector<float> decoded(vol.size());
+  DecompressBrick(data, codec, decoded);
+  for (std::size_t idx = 0; idx < vol.size(); idx++)
+    REQUIRE(std::bit_cast<uint32_t>(decoded[idx]) ==
+            std::bit_cast<uint32_t>(vol[idx]));
+
+  // incompressible data is stored raw
+  std::mt19937 gen(3);
+  std::vector<float> noise(256);
+  for (auto& val : noise)
+    val = std::bit_cast<float>(static_cast<uint32_t>(gen()) & 0x7F7FFFFF);
+  REQUIRE(CompressBrick(noise, codec).size() == noise.size() * sizeof(float));
+  REQUIRE(codec == BrickCodec::Raw);
+
+  REQUIRE_THROWS(DecompressBrick(data, BrickCodec::XorRle,
+                                 std::span(decoded).first(vol.size() - 1)));
+}
+
+TEST_CASE("BrickVolumeFile: parallel slab writes read back exactly") {
+  const Size3 dims{37ul, 25ul, 30ul};
+  const std::size_t brickSize = 8;
+  const Volume vol = CreateVolume(dims);
+  const std::string path = GetTempPath();
+
+  {
+    BrickVolumeWriter writer(path, dims, vol.get_res(), vol.get_center(),
+                             brickSize);
+    // two slabs, the second one ends at the volume border
+    Volume first({dims[0], 16ul, dims[2]});
+    Volume second({dims[0], dims[1] - 16, dims[2]});
+    for (std::size_t z = 0; z < dims[2]; z++) {
+      for (std::size_t y = 0; y < dims[1]; y++) {
+        for (std::size_t x = 0; x < dims[0]; x++) {
+          if (y < 16)
+            first(x, y, z) = vol(x, y, z);
+          else
+            second(x, y - 16, z) = vol(x, y, z);
+        }
+      }
+    }
+    REQUIRE_THROWS(writer.WriteSlab(second, 12, 3));
+    writer.WriteSlab(second, 16, 3);
+    writer.WriteSlab(first, 0, 4);
+    REQUIRE(writer.get_compressedBytes() < vol.size() * sizeof(float));
+  }
+
+  const BrickVolumeReader reader(path);
+  REQUIRE(reader.get_dims() == dims);
+  REQUIRE(reader.get_layout().get_nBricks() == Size3{5ul, 4ul, 4ul});
+  Volume loaded = reader.ReadVolume();
+  REQUIRE(loaded == vol);
+
+  SECTION("single brick") {
+    const Volume brick = reader.ReadBrick({4ul, 1ul, 2ul});
+    REQUIRE(brick.get_dims() == Size3{5ul, 8ul, 8ul});
+    REQUIRE(brick(2, 3, 4) == vol(34, 11, 20));
+    // voxel positions agree with the full volume
+    REQUIRE(std::fabs(brick.get_pos(0, Dimension::X) -
+                      vol.get_pos(32, Dimension::X)) < 1e-9f);
+    REQUIRE(std::fabs(brick.get_pos(0, Dimension::Z) -
+                      vol.get_pos(16, Dimension::Z)) < 1e-9f);
+  }
+
+  SECTION("slices") {
+    const Volume sliceZ = reader.ReadSlice(Dimension::Z, 21);
+    REQUIRE(sliceZ.get_dims() == Size3{dims[0], dims[1], 1ul});
+    const Volume sliceX = reader.ReadSlice(Dimension::X, 36);
+    REQUIRE(sliceX.get_dims() == Size3{1ul, dims[1], dims[2]});
+    for (std::size_t y = 0; y < dims[1]; y++) {
+      for (std::size_t x = 0; x < dims[0]; x++)
+        REQUIRE(sliceZ(x, y, 0) == vol(x, y, 21));
+      for (std::size_t z = 0; z < dims[2]; z++)
+        REQUIRE(sliceX(0, y, z) == vol(36, y, z));
+    }
+    REQUIRE_THROWS(reader.ReadSlice(Dimension::Y, dims[1]));
+  }
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("BrickVolumeFile: missing bricks read as zero") {
+  const std::string path = GetTempPath();
+  {
+    BrickVolumeWriter writer(path, {4ul, 4ul, 4ul}, {1.0f, 1.0f, 1.0f},
+                             {0.0f, 0.0f, 0.0f}, 2);
+    std::vector<float> ones(8, 1.0f);
+    writer.WriteBrick({1ul, 0ul, 1ul}, ones);
+    REQUIRE_THROWS(writer.WriteBrick({1ul, 0ul, 1ul}, ones));
+    REQUIRE_THROWS(writer.WriteBrick({2ul, 0ul, 0ul}, ones));
+  }
+  const BrickVolumeReader reader(path);
+  const Volume vol = reader.ReadVolume();
+  REQUIRE(vol(3, 1, 2) == 1.0f);
+  REQUIRE(vol(0, 0, 0) == 0.0f);
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,76 @@
+#include "CliOptions.h"
+#include "catch2/catch_test_macros.hpp"
+#include <catch2/catch_all.hpp>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+using namespace opensaft;
+
+TEST_CASE("cli options parse flags", "[CliOptions]") {
+  const CliOptions options = ParseCliOptions(
+      {"--input", "scan.raw", "--output=vol.bvol", "--threads", "3", "--mode",
+       "separable", "--simd", "scalar", "--format", "bricked", "--region",
+       "1,2,3,10,20,30", "--sos", "1500", "--no-coherence", "--bandpass",
+       "1e6,40e6", "--aperture", "2.5", "--quiet"});
+
+  REQUIRE(options.inputPath == "scan.raw");
+  REQUIRE(options.outputPath == "vol.bvol");
+  REQUIRE(options.threadCount == 3);
+  REQUIRE(options.settings.get_mode() == ReconMode::Separable);
+  REQUIRE(options.simdLevel == SimdLevel::Scalar);
+  REQUIRE(options.format == VolumeFileFormat::Bricked);
+  REQUIRE(options.region.has_value());
+  REQUIRE(options.region->first == Size3{1ul, 2ul, 3ul});
+  REQUIRE(options.region->second == Size3{10ul, 20ul, 30ul});
+  REQUIRE(fabs(options.settings.get_sos() - 1500.0f) < 1e-3f);
+  REQUIRE(!options.settings.get_flagCoherenceW());
+  REQUIRE(options.settings.get_flagBandpass());
+  REQUIRE(fabs(options.settings.get_bandpassMax() - 40e6f) < 1.0f);
+  REQUIRE(fabs(options.transducer.get_rAperture() - 2.5f) < 1e-6f);
+  REQUIRE(options.isQuiet);
+}
+
+TEST_CASE("cli flags override the config file", "[CliOptions]") {
+  const auto path =
+      (std::filesystem::temp_directory_path() / "opensaft_cli.cfg").string();
+  {
+    std::ofstream file(path);
+    file << "# acquisition of the phantom\n"
+         << "input = phantom.raw\n"
+         << "output = phantom_vol.raw\n"
+         << "\n"
+         << "sos = 1480\n"
+         << "threads = 2\n";
+  }
+
+  const CliOptions options =
+      ParseCliOptions({"--threads", "8", "--config", path});
+  REQUIRE(options.inputPath == "phantom.raw");
+  REQUIRE(options.outputPath == "phantom_vol.raw");
+  REQUIRE(fabs(options.settings.get_sos() - 1480.0f) < 1e-3f);
+  REQUIRE(options.threadCount == 8);
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("cli options reject invalid input", "[CliOptions]") {
+  const std::vector<std::string> required = {"--input", "a", "--output", "b"};
+  const auto parse = [&required](std::vector<std::string> args) {
+    args.insert(args.end(), required.begin(), required.end());
+    return ParseCliOptions(args);
+  };
+
+  REQUIRE_THROWS_AS(parse({"--unknown", "1"}), std::invalid_argument);
+  REQUIRE_THROWS_AS(parse({"--mode", "fast"}), std::invalid_argument);
+  REQUIRE_THROWS_AS(parse({"--threads", "-1"}), std::invalid_argument);
+  REQUIRE_THROWS_AS(parse({"--sos", "15OO"}), std::invalid_argument);
+  REQUIRE_THROWS_AS(parse({"--region", "0,0,0,1,1"}), std::invalid_argument);
+  REQUIRE_THROWS_AS(parse({"--region", "5,0,0,1,1,1"}),
+                    std::invalid_argument);
+  REQUIRE_THROWS_AS(parse({"--config", "/nonexistent/opensaft.cfg"}),
+                    std::invalid_argument);
+  REQUIRE_THROWS_AS(ParseCliOptions({"--input", "a"}), std::invalid_argument);
+  REQUIRE_THROWS_AS(ParseCliOptions({"--input"}), std::invalid_argument);
+  REQUIRE(ParseCliOptions({"--help"}).showHelp);
+}
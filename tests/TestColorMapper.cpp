@@ -0,0 +1,111 @@
+#include "Slicer/ColorMapper.h"
+#include "catch2/catch_test_macros.hpp"
+#include <catch2/catch_all.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+using namespace opensaft;
+
+namespace {
+
+/// values sweeping beyond [-2, 2] in uneven steps
+std::vector<float> CreateValues(const std::size_t n) {
+  std::vector<float> values(n);
+  for (std::size_t iVal = 0; iVal < n; iVal++)
+    values[iVal] = 2.5f * std::sin(0.37f * static_cast<float>(iVal));
+  return values;
+}
+
+/// largest per channel difference of two RGBA images
+int MaxDiff(const std::vector<unsigned char>& a,
+            const std::vector<unsigned char>& b) {
+  int maxDiff = 0;
+  for (std::size_t iByte = 0; iByte < a.size(); iByte++)
+    maxDiff = std::max(maxDiff, std::abs(int{a[iByte]} - int{b[iByte]}));
+  return maxDiff;
+}
+
+} // namespace
+
+TEST_CASE("ColorMapper: lookup table matches the linear map") {
+  ColorMapper mapper;
+  mapper.set_minVal(-2.0f);
+  mapper.set_maxVal(1.5f);
+  mapper.set_minCol({0.1f, 0.9f, 0.0f, 1.0f});
+  mapper.set_maxCol({0.8f, 0.2f, 1.0f, 0.5f});
+  // odd size covers the scalar tail of the vector path
+  const std::vector<float> values = CreateValues(1001);
+  std::vector<unsigned char> fast(values.size() * 4);
+  std::vector<unsigned char> reference(values.size() * 4);
+  mapper.convert_to_map(values.data(), values.size(), fast.data());
+  mapper.convert_to_rgba(values.data(), values.size(), reference.data());
+  REQUIRE(MaxDiff(fast, reference) <= 1);
+}
+
+TEST_CASE("ColorMapper: lookup table matches the diverging map") {
+  ColorMapper mapper;
+  mapper.set_mapType(ColorMapType::Diverging);
+  mapper.set_minVal(-1.0f);
+  mapper.set_maxVal(2.0f);
+  const std::vector<float> values = CreateValues(1001);
+  std::vector<unsigned char> fast(values.size() * 4);
+  std::vector<unsigned char> reference(values.size() * 4, 0);
+  mapper.convert_to_map(values.data(), values.size(), fast.data());
+  mapper.convert_to_divmap(values.data(), values.size(), reference.data());
+  REQUIRE(MaxDiff(fast, reference) <= 1);
+  for (std::size_t iVal = 0; iVal < values.size(); iVal++)
+    REQUIRE(fast[iVal * 4 + 3] == 255);
+}
+
+TEST_CASE("ColorMapper: viridis endpoints and NaN") {
+  ColorMapper mapper;
+  mapper.set_mapType(ColorMapType::Viridis);
+  mapper.set_minVal(0.0f);
+  mapper.set_maxVal(1.0f);
+  const std::vector<float> values = {
+      0.0f, 1.0f, -5.0f, 7.0f, std::numeric_limits<float>::quiet_NaN()};
+  std::vector<unsigned char> rgba(values.size() * 4);
+  mapper.convert_to_map(values.data(), values.size(), rgba.data());
+  const std::vector<unsigned char> low = {0x44, 0x01, 0x54, 0xFF};
+  const std::vector<unsigned char> high = {0xFD, 0xE7, 0x25, 0xFF};
+  for (std::size_t iVal = 0; iVal < values.size(); iVal++) {
+    const bool isHigh = (values[iVal] >= 1.0f);
+    for (std::size_t iCol = 0; iCol < 4; iCol++)
+      REQUIRE(rgba[iVal * 4 + iCol] == (isHigh ? high : low)[iCol]);
+  }
+}
+
+TEST_CASE("ColorMapper: colors edited through pointers") {
+  ColorMapper mapper;
+  mapper.set_minVal(0.0f);
+  mapper.set_maxVal(1.0f);
+  mapper.get_pmaxCol()[0] = 0.0f;
+  const float value = 1.0f;
+  unsigned char rgba[4];
+  mapper.convert_to_map(&value, 1, rgba);
+  REQUIRE(rgba[0] == 0);
+  REQUIRE(rgba[1] == 255);
+
+  // copies share the table until either changes its colors
+  ColorMapper copy = mapper;
+  copy.set_maxCol({1.0f, 0.0f, 1.0f, 1.0f});
+  mapper.convert_to_map(&value, 1, rgba);
+  REQUIRE(rgba[0] == 0);
+  copy.convert_to_map(&value, 1, rgba);
+  REQUIRE(rgba[0] == 255);
+  REQUIRE(rgba[1] == 0);
+}
+
+TEST_CASE("ColorMapper: parallel conversion of large images") {
+  ColorMapper mapper;
+  mapper.set_minVal(-2.5f);
+  mapper.set_maxVal(2.5f);
+  const std::vector<float> values = CreateValues(3 * 65536 + 123);
+  std::vector<unsigned char> fast(values.size() * 4);
+  std::vector<unsigned char> reference(values.size() * 4);
+  mapper.convert_to_map(values.data(), values.size(), fast.data());
+  mapper.convert_to_rgba(values.data(), values.size(), reference.data());
+  REQUIRE(MaxDiff(fast, reference) <= 1);
+}
@@ -0,0 +1,96 @@
+#include "Recon/DelayTable.h"
+#include "Recon/SaftKernel.h"
+#include "Recon/SimdKernel.h"
+#include "catch2/catch_test_macros.hpp"
+#include <catch2/catch_all.hpp>
+#include <random>
+
+using namespace opensaft;
+
+namespace {
+
+UltrasoundSignals CreateNoise(const std::size_t nX, const std::size_t nY,
+                              const std::size_t nT) {
+  AcquisitionProperties props;
+  props.nX = nX;
+  props.nY = nY;
+  props.dx = 15e-6f;
+  props.dy = 25e-6f;
+  props.sampleRate = 125e6f;
+  props.t0 = 6.2e-3f / 1495.0f;
+  UltrasoundSignals sigs(props, nT);
+
+  std::mt19937 gen(42);
+  std::normal_distribution<float> dist(0.0f, 1.0f);
+  for (auto sig : sigs) {
+    for (auto& value : sig)
+      value = dist(gen);
+  }
+  return sigs;
+}
+
+} // namespace
+
+TEST_CASE("DelayTable: table kernel matches direct kernel bitwise") {
+  const bool flagUs = GENERATE(false, true);
+  ReconSettings sett;
+  sett.set_flagUs(flagUs);
+  const UltrasoundSignals sigs = CreateNoise(13, 9, 160);
+  const SaftGeometry geom = SaftGeometry::Create(sigs, sett, Transducer());
+  const DelayTable table(geom);
+  REQUIRE(table.get_nEntries() > 0);
+
+  for (std::size_t iz = 0; iz < 160; iz++) {
+    for (std::size_t iy = 0; iy < 9; iy++) {
+      for (std::size_t ix = 0; ix < 13; ix++) {
+        const Size3 idx{ix, iy, iz};
+        REQUIRE(CalculateVoxel(geom, table, sigs, idx) ==
+                CalculateVoxelDirect(geom, sigs, idx));
+      }
+    }
+  }
+}
+
+TEST_CASE("DelayTable: tables are reused for matching geometries") {
+  const UltrasoundSignals sigs = CreateNoise(4, 4, 32);
+  ReconSettings sett;
+  const SaftGeometry geom = SaftGeometry::Create(sigs, sett, Transducer());
+
+  const auto table1 = DelayTable::Get(geom);
+  const auto table2 = DelayTable::Get(geom);
+  REQUIRE(table1 == table2);
+
+  sett.set_sos(1520.0f);
+  const auto table3 =
+      DelayTable::Get(SaftGeometry::Create(sigs, sett, Transducer()));
+  REQUIRE(table3 != table1);
+  REQUIRE(DelayTable::Get(geom) == table1);
+}
+
+TEST_CASE("SimdKernel: vectorized kernels match the scalar kernel bitwise") {
+  const SimdLevel level = GENERATE(SimdLevel::Avx2, SimdLevel::Avx512);
+  if (level > DetectSimdLevel())
+    SKIP("instruction set not supported by this cpu");
+
+  const bool flagCoherenceW = GENERATE(false, true);
+  ReconSettings sett;
+  *sett.get_pflagCoherenceW() = flagCoherenceW;
+  const UltrasoundSignals sigs = CreateNoise(11, 7, 150);
+  const SaftGeometry geom = SaftGeometry::Create(sigs, sett, Transducer());
+  const DelayTable table(geom);
+  REQUIRE(table.get_nBlocks() == 10);
+
+  float block[DelayBlockWidth];
+  float reference[DelayBlockWidth];
+  for (int iBlock = 0; iBlock < table.get_nBlocks(); iBlock++) {
+    for (int iy = 0; iy < 7; iy++) {
+      for (int ix = 0; ix < 11; ix++) {
+        CalculateVoxelBlock(level, geom, table, sigs, ix, iy, iBlock, block);
+        CalculateVoxelBlock(SimdLevel::Scalar, geom, table, sigs, ix, iy,
+                            iBlock, reference);
+        for (int iLane = 0; iLane < DelayBlockWidth; iLane++)
+          REQUIRE(block[iLane] == reference[iLane]);
+      }
+    }
+  }
+}
@@ -0,0 +1,155 @@
+#include "Processing/Envelope.h"
+#include "Processing/Fft.h"
+#include "Processing/FftBandpass.h"
+#include "catch2/catch_test_macros.hpp"
+#include <catch2/catch_all.hpp>
+#include <cmath>
+#include <complex>
+#include <numbers>
+#include <random>
+#include <vector>
+
+using namespace opensaft;
+
+namespace {
+
+/// reference O(n^2) discrete fourier transform
+std::vector<std::complex<double>>
+NaiveDft(const std::vector<std::complex<float>>& in) {
+  const std::size_t n = in.size();
+  std::vector<std::complex<double>> out(n);
+  for (std::size_t k = 0; k < n; k++)
+    for (std::size_t j = 0; j < n; j++)
+      out[k] += std::complex<double>(in[j]) *
+                std::polar(1.0, -2.0 * std::numbers::pi *
+                                    static_cast<double>(j * k % n) /
+                                    static_cast<double>(n));
+  return out;
+}
+
+/// gaussian windowed sine of carrier frequency f [cycles per sample]
+std::vector<float> CreatePulse(const std::size_t n, const float f,
+                               const float center, const float sigma) {
+  std::vector<float> pulse(n);
+  for (std::size_t i = 0; i < n; i++) {
+    const float t = static_cast<float>(i) - center;
+    pulse[i] = std::exp(-0.5f * t * t / (sigma * sigma)) *
+               std::sin(2.0f * std::numbers::pi_v<float> * f * t);
+  }
+  return pulse;
+}
+
+} // namespace
+
+TEST_CASE("Fft: next power of two") {
+  REQUIRE(NextPowerOfTwo(0) == 1);
+  REQUIRE(NextPowerOfTwo(1) == 1);
+  REQUIRE(NextPowerOfTwo(5) == 8);
+  REQUIRE(NextPowerOfTwo(64) == 64);
+  REQUIRE(NextPowerOfTwo(65) == 128);
+}
+
+TEST_CASE("Fft: complex and real transforms") {
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+  for (const std::size_t n : {2, 8, 64, 256}) {
+    std::vector<std::complex<float>> data(n);
+    for (auto& value : data)
+      value = {dist(gen), dist(gen)};
+    const auto reference = NaiveDft(data);
+    const std::vector<std::complex<float>> original = data;
+
+    const auto plan = FftPlan::Get(n);
+    plan->Forward(data);
+    for (std::size_t k = 0; k < n; k++)
+      REQUIRE(std::abs(std::complex<double>(data[k]) - reference[k]) < 1e-3);
+    plan->Inverse(data);
+    for (std::size_t k = 0; k < n; k++)
+      REQUIRE(std::abs(data[k] - original[k]) < 1e-5f);
+
+    // real input matches the first half of the complex spectrum
+    std::vector<float> real(n);
+    std::vector<std::complex<float>> realAsComplex(n);
+    for (std::size_t i = 0; i < n; i++) {
+      real[i] = dist(gen);
+      realAsComplex[i] = real[i];
+    }
+    const auto realReference = NaiveDft(realAsComplex);
+    const auto realPlan = RealFftPlan::Get(n);
+    std::vector<std::complex<float>> spectrum(n / 2 + 1);
+    realPlan->Forward(real, spectrum);
+    for (std::size_t k = 0; k <= n / 2; k++)
+      REQUIRE(std::abs(std::complex<double>(spectrum[k]) - realReference[k]) <
+              1e-3);
+
+    std::vector<float> restored(n);
+    realPlan->Inverse(spectrum, restored);
+    for (std::size_t i = 0; i < n; i++)
+      REQUIRE(std::fabs(restored[i] - real[i]) < 1e-5f);
+  }
+
+  // plans are created once and shared afterwards
+  REQUIRE(FftPlan::Get(128) == FftPlan::Get(128));
+  REQUIRE(RealFftPlan::Get(128) == RealFftPlan::Get(128));
+  REQUIRE_THROWS_AS(FftPlan(12), std::invalid_argument);
+}
+
+TEST_CASE("Fft: bandpass") {
+  constexpr float sampleRate = 100e6f;
+  constexpr std::size_t nT = 1000;
+  const FftBandpass filter(2e6f, 10e6f, sampleRate, nT);
+  REQUIRE(filter.get_nFft() == 2048);
+
+  const auto filtered = [&](const float freq) {
+    std::vector<float> signal(nT);
+    for (std::size_t i = 0; i < nT; i++)
+      signal[i] = std::sin(2.0f * std::numbers::pi_v<float> * freq *
+                           static_cast<float>(i) / sampleRate);
+    filter.Apply(signal);
+    // amplitude in the center, away from the edges of the window
+    float maxAbs = 0.0f;
+    for (std::size_t i = 300; i < 700; i++)
+      maxAbs = std::max(maxAbs, std::fabs(signal[i]));
+    return maxAbs;
+  };
+
+  REQUIRE(std::fabs(filtered(5e6f) - 1.0f) < 0.02f);
+  REQUIRE(filtered(30e6f) < 0.01f);
+  REQUIRE(filtered(0.3e6f) < 0.05f);
+
+  std::vector<float> wrongLength(nT + 1);
+  REQUIRE_THROWS_AS(filter.Apply(wrongLength), std::invalid_argument);
+}
+
+TEST_CASE("Fft: envelope of a modulated pulse") {
+  constexpr std::size_t n = 300;
+  constexpr float sigma = 15.0f;
+  std::vector<float> signal = CreatePulse(n, 0.1f, 150.0f, sigma);
+  CalculateEnvelope(signal);
+  for (std::size_t i = 50; i < 250; i++) {
+    const float t = static_cast<float>(i) - 150.0f;
+    REQUIRE(std::fabs(signal[i] - std::exp(-0.5f * t * t / (sigma * sigma))) <
+            0.02f);
+  }
+
+  // the volume variant applies the same transform to each column along z
+  Volume vol({19ul, 3ul, n});
+  for (std::size_t iY = 0; iY < 3; iY++)
+    for (std::size_t iX = 0; iX < 19; iX++) {
+      const float center = 100.0f + static_cast<float>(iX);
+      const auto column = CreatePulse(n, 0.1f, center, sigma);
+      for (std::size_t iZ = 0; iZ < n; iZ++)
+        vol(iX, iY, iZ) = column[iZ] * static_cast<float>(iY + 1);
+    }
+  CalculateEnvelope(vol, 2);
+  for (std::size_t iY = 0; iY < 3; iY++)
+    for (std::size_t iX = 0; iX < 19; iX++) {
+      const float center = 100.0f + static_cast<float>(iX);
+      std::vector<float> column = CreatePulse(n, 0.1f, center, sigma);
+      CalculateEnvelope(column);
+      for (std::size_t iZ = 0; iZ < n; iZ++)
+        REQUIRE(std::fabs(vol(iX, iY, iZ) -
+                          column[iZ] * static_cast<float>(iY + 1)) < 1e-4f);
+    }
+}
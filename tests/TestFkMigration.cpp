@@ -0,0 +1,112 @@
+#include "PointTargetFixture.h"
+#include "Processing/Envelope.h"
+#include "Recon/Accuracy.h"
+#include "Recon/FkMigration.h"
+#include "catch2/catch_test_macros.hpp"
+#include <catch2/catch_all.hpp>
+#include <cmath>
+
+using namespace opensaft;
+
+namespace {
+
+/// single absorber at the given voxel
+UltrasoundSignals CreateTarget(const std::size_t iX, const std::size_t iY,
+                               const std::size_t iZ) {
+  PointTargetFixture fixture;
+  fixture.AddTarget({iX, iY, iZ});
+  return fixture.Simulate();
+}
+
+Volume Reconstruct(const ReconMode mode, const UltrasoundSignals& sigs) {
+  PointTargetFixture fixture;
+  fixture.settings.set_mode(mode);
+  *fixture.settings.get_pflagCoherenceW() = false;
+  return fixture.Reconstruct(sigs);
+}
+
+/// \returns the raster index of the largest absolute value
+Size3 FindPeak(const Volume& vol) {
+  const auto itMax = std::max_element(
+      vol.begin(), vol.end(),
+      [](float a, float b) { return std::fabs(a) < std::fabs(b); });
+  const auto idx = static_cast<std::size_t>(std::distance(vol.begin(), itMax));
+  Size3 peak;
+  peak[0] = idx % vol.get_dim(0);
+  peak[1] = idx / vol.get_dim(0) % vol.get_dim(1);
+  peak[2] = idx / (vol.get_dim(0) * vol.get_dim(1));
+  return peak;
+}
+
+} // namespace
+
+TEST_CASE("FkMigration: point targets are focused like delay-and-sum") {
+  // behind and in front of the focal plane
+  const auto [iX, iY, iZ] = GENERATE(std::make_tuple(15, 13, 150),
+                                     std::make_tuple(12, 16, 40));
+  const UltrasoundSignals sigs = CreateTarget(iX, iY, iZ);
+  const Volume exact = Reconstruct(ReconMode::Exact, sigs);
+  const Volume fk = Reconstruct(ReconMode::FrequencyDomain, sigs);
+  REQUIRE(fk.get_dims() == exact.get_dims());
+  REQUIRE(fk.get_res() == exact.get_res());
+  REQUIRE(fk.get_pos(Size3()) == exact.get_pos(Size3()));
+  REQUIRE(fk.get_pos(fk.get_dims() - Size3{1ul, 1ul, 1ul}) ==
+          exact.get_pos(exact.get_dims() - Size3{1ul, 1ul, 1ul}));
+
+  // the migration is scaled to the gain of the delay-and-sum, a point
+  // target reaches a similar peak
+  const AccuracyReport rawReport = CompareVolumes(exact, fk);
+  INFO(ToString(rawReport));
+  REQUIRE(rawReport.peakRatio > 0.4f);
+  REQUIRE(rawReport.peakRatio < 2.5f);
+
+  // the pulses are shaped differently, their envelopes are compared
+  Volume envExact = exact;
+  Volume envFk = fk;
+  CalculateEnvelope(envExact);
+  CalculateEnvelope(envFk);
+  const AccuracyReport report = CompareVolumes(envExact, envFk);
+  INFO(ToString(report));
+  REQUIRE(report.correlation > 0.85f);
+  REQUIRE(report.peakShift <= 1.0f);
+  const Size3 peak = FindPeak(fk);
+  REQUIRE(peak[0] == static_cast<std::size_t>(iX));
+  REQUIRE(peak[1] == static_cast<std::size_t>(iY));
+  REQUIRE(std::abs(static_cast<int>(peak[2]) - iZ) <= 1);
+}
+
+TEST_CASE("FkMigration: region matches the full raster") {
+  const UltrasoundSignals sigs = CreateTarget(15, 13, 150);
+  const SaftGeometry geom =
+      SaftGeometry::Create(sigs, ReconSettings(), Transducer());
+  const FkMigration migration(geom);
+  const Size3 padded = migration.get_paddedDims();
+  REQUIRE(padded[0] >= sigs.get_nX());
+  REQUIRE(padded[1] >= sigs.get_nY());
+  REQUIRE(migration.get_bufferBytes() >= padded[0] * padded[1] *
+                                             (padded[2] / 2 + 1) *
+                                             sizeof(std::complex<float>));
+
+  Volume full({sigs.get_nX(), sigs.get_nY(), sigs.get_nT()});
+  migration.Reconstruct(sigs, Size3(), full.get_dims(), full, 2);
+
+  Size3 start;
+  start[0] = 3;
+  start[1] = 5;
+  start[2] = 20;
+  Size3 stop;
+  stop[0] = 20;
+  stop[1] = 27;
+  stop[2] = 190;
+  Volume region(stop - start);
+  uint64_t nDone = 0;
+  migration.Reconstruct(sigs, start, stop, region, 1,
+                        [&nDone](const uint64_t n) { nDone += n; });
+  REQUIRE(nDone == region.size());
+  for (std::size_t iZ = 0; iZ < region.get_dim(2); iZ++)
+    for (std::size_t iY = 0; iY < region.get_dim(1); iY++)
+      for (std::size_t iX = 0; iX < region.get_dim(0); iX++)
+        REQUIRE(std::fabs(region(iX, iY, iZ) -
+                          full(iX + start[0], iY + start[1], iZ + start[2])) <
+                1e-6f);
+}
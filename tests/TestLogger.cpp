@@ -0,0 +1,97 @@
+#include "Util/Logger.h"
+#include "catch2/catch_test_macros.hpp"
+#include <catch2/catch_all.hpp>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace opensaft;
+
+namespace {
+
+class NamedClass : public LoggingClass {
+public:
+  void Report(const std::string& message) const { Log(message); }
+};
+
+/// redirects std::cout into a string while in scope
+class CaptureOutput {
+public:
+  CaptureOutput() : m_previous(std::cout.rdbuf(m_stream.rdbuf())) {}
+  ~CaptureOutput() { std::cout.rdbuf(m_previous); }
+
+  [[nodiscard]] std::vector<std::string> GetLines() const {
+    std::vector<std::string> lines;
+    std::istringstream stream(m_stream.str());
+    for (std::string line; std::getline(stream, line);)
+      lines.push_back(line);
+    return lines;
+  }
+
+private:
+  std::ostringstream m_stream;
+  std::streambuf* m_previous;
+};
+
+} // namespace
+
+TEST_CASE("Logger: level filtering", "[Logger]") {
+  Logger::SetLevel(LogLevel::Warning);
+  REQUIRE_FALSE(Logger::IsEnabled(LogLevel::Info));
+  REQUIRE(Logger::IsEnabled(LogLevel::Error));
+  {
+    CaptureOutput output;
+    Logger::Log({LogLevel::Info, "Test"}, "dropped");
+    Logger::Log({LogLevel::Error, "Test"}, "written");
+    const auto lines = output.GetLines();
+    REQUIRE(lines.size() == 1);
+    REQUIRE(lines[0].find("(Error) [Test] written") != std::string::npos);
+  }
+  Logger::SetLevel(LogLevel::Debug);
+}
+
+TEST_CASE("Logger: asynchronous messages of several threads", "[Logger]") {
+  constexpr std::size_t nThreads = 4;
+  constexpr std::size_t nMessages = 500;
+  CaptureOutput output;
+  Logger::SetAsync(true);
+  REQUIRE(Logger::IsAsync());
+  std::vector<std::thread> threads;
+  for (std::size_t iThread = 0; iThread < nThreads; iThread++)
+    threads.emplace_back([iThread] {
+      for (std::size_t iMessage = 0; iMessage < nMessages; iMessage++)
+        Logger::Log({LogLevel::Info, std::to_string(iThread)},
+                    std::to_string(iMessage));
+    });
+  for (auto& thread : threads)
+    thread.join();
+  Logger::SetAsync(false);
+
+  // every message is written once as a whole line, in order per thread
+  const auto lines = output.GetLines();
+  REQUIRE(lines.size() == nThreads * nMessages);
+  std::vector<std::size_t> nextMessage(nThreads, 0);
+  for (const std::string& line : lines) {
+    const auto originStart = line.find('[');
+    const auto originStop = line.find("] ");
+    REQUIRE(originStart != std::string::npos);
+    REQUIRE(originStop != std::string::npos);
+    const std::size_t iThread =
+        std::stoul(line.substr(originStart + 1, originStop - originStart - 1));
+    REQUIRE(std::stoul(line.substr(originStop + 2)) == nextMessage[iThread]);
+    nextMessage[iThread]++;
+  }
+}
+
+TEST_CASE("Logger: class names", "[Logger]") {
+  CaptureOutput output;
+  const NamedClass named;
+  named.Report("first");
+  named.Report("second");
+  const auto lines = output.GetLines();
+  REQUIRE(lines.size() == 2);
+  for (const std::string& line : lines)
+    REQUIRE(line.find("NamedClass] ") != std::string::npos);
+}
@@ -0,0 +1,138 @@
+#include "Saft.h"
+#include "Simulation/PointSourceSimulator.h"
+#include "catch2/catch_test_macros.hpp"
+#include <algorithm>
+#include <catch2/catch_all.hpp>
+#include <cmath>
+
+using namespace opensaft;
+
+namespace {
+
+constexpr std::size_t nX = 25;
+constexpr std::size_t nY = 23;
+constexpr std::size_t nT = 128;
+
+PointSourceSimulator CreateSimulator() {
+  AcquisitionProperties props;
+  props.nX = nX;
+  props.nY = nY;
+  props.dx = 20e-6f;
+  props.dy = 20e-6f;
+  props.sampleRate = 100e6f;
+  props.t0 = 6.5e-3f / ReconSettings().get_sos();
+  props.origin = {1e-3f, -2e-3f, 0.0f};
+
+  PointSourceSimulator sim;
+  sim.SetAcquisition(props, nT);
+  return sim;
+}
+
+std::size_t ArgAbsMax(std::span<const float> values) {
+  const auto itMax = std::max_element(
+      values.begin(), values.end(),
+      [](float a, float b) { return std::fabs(a) < std::fabs(b); });
+  return std::distance(values.begin(), itMax);
+}
+
+} // namespace
+
+TEST_CASE("PointSourceSimulator: reconstruction focuses absorbers back") {
+  PointSourceSimulator sim = CreateSimulator();
+  const Size3 target{8ul, 14ul, 70ul};
+  sim.AddAbsorber({sim.GetVoxelPosition(target[0], target[1], target[2])});
+
+  Saft S;
+  S.SetThreadCount(2);
+  S.SetInput(sim.Simulate());
+  S.Launch();
+  S.Wait();
+  const Volume vol = S.GetVolume().value();
+
+  const std::size_t idxMax = ArgAbsMax(vol);
+  REQUIRE(idxMax % nX == target[0]);
+  REQUIRE((idxMax / nX) % nY == target[1]);
+  REQUIRE(idxMax / (nX * nY) == target[2]);
+}
+
+TEST_CASE("PointSourceSimulator: result does not depend on thread count") {
+  PointSourceSimulator sim = CreateSimulator();
+  sim.SetPulse(PulseShape::GaussianSine, 20e6f, 0.6f);
+  sim.SetNoise(0.1f, 42);
+  sim.AddAbsorber({sim.GetVoxelPosition(3, 4, 90), 2.0f});
+  sim.AddAbsorber({sim.GetVoxelPosition(20, 12, 20), -1.0f});
+
+  sim.SetThreadCount(1);
+  const UltrasoundSignals reference = sim.Simulate();
+  sim.SetThreadCount(4);
+  const UltrasoundSignals sigs = sim.Simulate();
+  for (std::size_t iSig = 0; iSig < sigs.size(); iSig++) {
+    for (std::size_t tIdx = 0; tIdx < nT; tIdx++)
+      REQUIRE(sigs[iSig][tIdx] == reference[iSig][tIdx]);
+  }
+
+  // a different seed gives different noise
+  sim.SetNoise(0.1f, 43);
+  REQUIRE(sim.Simulate()[0][0] != reference[0][0]);
+}
+
+TEST_CASE("PointSourceSimulator: noise statistics") {
+  PointSourceSimulator sim = CreateSimulator();
+  sim.SetNoise(0.5f, 7);
+  const UltrasoundSignals sigs = sim.Simulate();
+
+  double sum = 0.0;
+  double sumSq = 0.0;
+  for (auto sig : sigs) {
+    for (const float sample : sig) {
+      sum += sample;
+      sumSq += sample * sample;
+    }
+  }
+  const double n = static_cast<double>(nX * nY * nT);
+  REQUIRE(std::fabs(sum / n) < 0.01);
+  REQUIRE(std::fabs(std::sqrt(sumSq / n) - 0.5) < 0.01);
+}
+
+TEST_CASE("PointSourceSimulator: pulse is centered on the time of flight") {
+  PointSourceSimulator sim = CreateSimulator();
+  const std::size_t tTarget = 60;
+  sim.AddAbsorber({sim.GetVoxelPosition(nX / 2, nY / 2, tTarget)});
+
+  // the central A-scan sees the absorber at its depth
+  sim.SetPulse(PulseShape::GaussianSine, 10e6f, 0.5f);
+  UltrasoundSignals sigs = sim.Simulate();
+  REQUIRE(ArgAbsMax(sigs(nX / 2, nY / 2)) == tTarget);
+
+  // optoacoustic pulses are bipolar around the arrival time
+  sim.SetPulse(PulseShape::NShape, 10e6f);
+  sigs = sim.Simulate();
+  ConstTimeSignalView sig = std::as_const(sigs)(nX / 2, nY / 2);
+  REQUIRE(sig[tTarget - 2] > 0.5f);
+  REQUIRE(sig[tTarget + 2] < -0.5f);
+  REQUIRE(std::fabs(sig[tTarget]) < 1e-5f);
+}
+
+TEST_CASE("PointSourceSimulator: central hole shadows the acoustic axis") {
+  PointSourceSimulator sim = CreateSimulator();
+  // far below the focus so the cone covers many A-scans
+  sim.AddAbsorber({sim.GetVoxelPosition(nX / 2, nY / 2, 120)});
+
+  Transducer trans;
+  trans.set_rHole(0.0f);
+  sim.SetTransducer(trans);
+  const UltrasoundSignals full = sim.Simulate();
+
+  trans.set_rHole(1.5f);
+  sim.SetTransducer(trans);
+  const UltrasoundSignals holed = sim.Simulate();
+
+  // directly above the absorber the focal zone (rMin) is still received,
+  // close to it the ray passes through the hole
+  REQUIRE(ArgAbsMax(holed(nX / 2, nY / 2)) == 120);
+  const std::size_t iXNear = nX / 2 + 4;
+  REQUIRE(*std::max_element(full(iXNear, nY / 2).begin(),
+                            full(iXNear, nY / 2).end()) == 1.0f);
+  REQUIRE(*std::max_element(holed(iXNear, nY / 2).begin(),
+                            holed(iXNear, nY / 2).end()) == 0.0f);
+}
@@ -0,0 +1,185 @@
+#include "Processing/Preprocessor.h"
+#include "Saft.h"
+#include "Simulation/PointSourceSimulator.h"
+#include "catch2/catch_test_macros.hpp"
+#include <catch2/catch_all.hpp>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+using namespace opensaft;
+
+namespace {
+
+constexpr float sampleRate = 100e6f;
+
+/// raster of sines of frequency freq [Hz] with a DC offset of dc
+UltrasoundSignals CreateSines(const float freq, const float dc,
+                              const std::size_t nT = 1000) {
+  AcquisitionProperties props;
+  props.nX = 3;
+  props.nY = 4;
+  props.sampleRate = sampleRate;
+  props.t0 = 2e-6f;
+  UltrasoundSignals sigs(props, nT);
+  for (std::size_t iSig = 0; iSig < sigs.size(); iSig++) {
+    for (std::size_t tIdx = 0; tIdx < nT; tIdx++) {
+      const float t = static_cast<float>(tIdx) / sampleRate;
+      sigs[iSig][tIdx] =
+          dc + static_cast<float>(iSig) +
+          std::sin(2.0f * std::numbers::pi_v<float> * freq * t);
+    }
+    sigs.set_signalProperties(iSig, {sampleRate, props.t0, {0.0f}});
+  }
+  return sigs;
+}
+
+float MaxAbs(std::span<const float> values) {
+  float maxAbs = 0.0f;
+  for (const float value : values)
+    maxAbs = std::max(maxAbs, std::fabs(value));
+  return maxAbs;
+}
+
+} // namespace
+
+TEST_CASE("Preprocessor: removes DC like TimeSignal") {
+  const UltrasoundSignals input = CreateSines(5e6f, 3.0f);
+  const UltrasoundSignals output = Preprocessor().Process(input);
+  REQUIRE(output.get_nT() == input.get_nT());
+
+  for (std::size_t iSig = 0; iSig < input.size(); iSig++) {
+    TimeSignal reference(input.get_nT());
+    std::copy(input[iSig].begin(), input[iSig].end(), reference.begin());
+    reference.RemoveDC();
+    for (std::size_t tIdx = 0; tIdx < input.get_nT(); tIdx++)
+      REQUIRE(std::fabs(output[iSig][tIdx] - reference[tIdx]) < 1e-5f);
+  }
+}
+
+TEST_CASE("Preprocessor: crops to the requested time window") {
+  const UltrasoundSignals input = CreateSines(5e6f, 0.0f);
+  ReconSettings sett;
+  // window in ms, first sample of the input at 2 us
+  sett.set_cropT(3e-3f, 4e-3f);
+  Preprocessor preprocessor;
+  preprocessor.SetSettings(sett);
+
+  const auto [start, stop] =
+      preprocessor.GetCropRange(input.get_properties(), input.get_nT());
+  REQUIRE(start == 100);
+  REQUIRE(stop == 201);
+
+  UltrasoundSignals output = input;
+  preprocessor.SetThreadCount(3);
+  preprocessor.Process(output);
+  REQUIRE(output.get_nT() == 101);
+  REQUIRE(std::fabs(output.get_properties().t0 - 3e-6f) < 1e-12f);
+  REQUIRE(std::fabs(output.get_signalProperties(5).deltaT - 3e-6f) < 1e-12f);
+
+  // 5 MHz over 101 samples at 100 MHz are 5 full periods plus one sample
+  double mean = 0.0;
+  for (std::size_t tIdx = start; tIdx < stop; tIdx++)
+    mean += input[5][tIdx];
+  mean /= static_cast<double>(stop - start);
+  for (std::size_t tIdx = 0; tIdx < output.get_nT(); tIdx++)
+    REQUIRE(std::fabs(output[5][tIdx] - (input[5][tIdx + start] - mean)) <
+            1e-5);
+
+  // disabled or out of range windows
+  sett.set_cropT(0.0f, 0.0f);
+  preprocessor.SetSettings(sett);
+  REQUIRE(preprocessor.GetCropRange(input.get_properties(), 1000).second ==
+          1000);
+  sett.set_cropT(1.0f, 2.0f);
+  preprocessor.SetSettings(sett);
+  const auto [emptyStart, emptyStop] =
+      preprocessor.GetCropRange(input.get_properties(), 1000);
+  REQUIRE(emptyStart == emptyStop);
+}
+
+TEST_CASE("Preprocessor: rows are preprocessed without extracting them") {
+  UltrasoundSignals input = CreateSines(5e6f, 2.0f);
+  AcquisitionProperties props = input.get_properties();
+  props.dy = 1e-4f;
+  input.set_properties(props);
+  ReconSettings sett;
+  sett.set_cropT(3e-3f, 4e-3f);
+  sett.set_flagBandpass(true);
+  Preprocessor preprocessor;
+  preprocessor.SetSettings(sett);
+
+  const UltrasoundSignals rows = preprocessor.Process(input, 1, 3);
+  const UltrasoundSignals reference =
+      preprocessor.Process(input.ExtractRows(1, 3));
+  REQUIRE(rows.get_nY() == 2);
+  REQUIRE(rows.get_nT() == reference.get_nT());
+  REQUIRE(rows.get_properties().origin[1] ==
+          reference.get_properties().origin[1]);
+  REQUIRE(rows.get_properties().t0 == reference.get_properties().t0);
+  for (std::size_t iSig = 0; iSig < rows.size(); iSig++) {
+    REQUIRE(rows.get_signalProperties(iSig).deltaT ==
+            reference.get_signalProperties(iSig).deltaT);
+    for (std::size_t tIdx = 0; tIdx < rows.get_nT(); tIdx++)
+      REQUIRE(rows[iSig][tIdx] == reference[iSig][tIdx]);
+  }
+  REQUIRE_THROWS_AS(preprocessor.Process(input, 3, 5), std::out_of_range);
+}
+
+TEST_CASE("Preprocessor: zero phase bandpass") {
+  ReconSettings sett;
+  sett.set_flagBandpass(true);
+  sett.set_bandpass(2e6f, 10e6f);
+  Preprocessor preprocessor;
+  preprocessor.SetSettings(sett);
+
+  // the center of the signal is far away from the filter transients
+  const std::size_t center = 500;
+  const auto core = [&](const UltrasoundSignals& sigs) {
+    return std::span(sigs[0]).subspan(center - 200, 400);
+  };
+
+  const UltrasoundSignals passed =
+      preprocessor.Process(CreateSines(5e6f, 1.0f));
+  // unit gain within the passband
+  REQUIRE(std::fabs(MaxAbs(core(passed)) - 1.0f) < 0.02f);
+  // no phase shift: zero crossing of the sine stays in place
+  REQUIRE(std::fabs(passed[0][center]) < 0.05f);
+
+  REQUIRE(MaxAbs(core(preprocessor.Process(CreateSines(40e6f, 0.0f)))) <
+          0.05f);
+  REQUIRE(MaxAbs(core(preprocessor.Process(CreateSines(0.2e6f, 0.0f)))) <
+          0.05f);
+}
+
+TEST_CASE("Preprocessor: saft reconstructs the cropped window") {
+  AcquisitionProperties props;
+  props.nX = 15;
+  props.nY = 15;
+  props.dx = 20e-6f;
+  props.dy = 20e-6f;
+  props.sampleRate = sampleRate;
+  props.t0 = 6.5e-3f / ReconSettings().get_sos();
+  PointSourceSimulator sim;
+  sim.SetAcquisition(props, 200);
+  sim.AddAbsorber({sim.GetVoxelPosition(7, 7, 120)});
+
+  ReconSettings sett;
+  const float dtMs = 1e3f / sampleRate;
+  sett.set_cropT(props.t0 * 1e3f + 50.0f * dtMs,
+                 props.t0 * 1e3f + 149.5f * dtMs);
+
+  Saft S;
+  S.SetSettings(sett);
+  S.SetInput(sim.Simulate());
+  S.Launch();
+  S.Wait();
+  const Volume vol = S.GetVolume().value();
+  REQUIRE(vol.get_dims() == Size3{15ul, 15ul, 100ul});
+
+  const auto itMax = std::max_element(
+      vol.begin(), vol.end(),
+      [](float a, float b) { return std::fabs(a) < std::fabs(b); });
+  const std::size_t idxMax = std::distance(vol.begin(), itMax);
+  REQUIRE(idxMax / (15 * 15) == 70);
+}
@@ -0,0 +1,80 @@
+#include "Util/ParallelFor.h"
+#include "Util/Profiler.h"
+#include "catch2/catch_test_macros.hpp"
+#include <catch2/catch_all.hpp>
+#include <string>
+
+using namespace opensaft;
+
+namespace {
+
+std::size_t CountOccurrences(const std::string& text,
+                             const std::string& pattern) {
+  std::size_t count = 0;
+  for (auto pos = text.find(pattern); pos != std::string::npos;
+       pos = text.find(pattern, pos + pattern.size()))
+    count++;
+  return count;
+}
+
+const ProfileZoneStats* FindZone(const std::vector<ProfileZoneStats>& stats,
+                                 const std::string& name) {
+  for (const auto& zone : stats)
+    if (zone.name == name)
+      return &zone;
+  return nullptr;
+}
+
+} // namespace
+
+TEST_CASE("Profiler: disabled zones are not recorded", "[Profiler]") {
+  Profiler::Enable(false);
+  Profiler::Clear();
+  {
+    ProfileZone zone("test disabled");
+  }
+  REQUIRE(FindZone(Profiler::GetZoneStats(), "test disabled") == nullptr);
+}
+
+TEST_CASE("Profiler: zones of all threads end up in the trace",
+          "[Profiler]") {
+  Profiler::Clear();
+  Profiler::Enable(true);
+  ParallelFor(64, 4, [](const std::size_t) {
+    ProfileZone outer("test outer");
+    ProfileZone inner("test \"inner\"");
+  });
+  Profiler::Enable(false);
+
+  const auto stats = Profiler::GetZoneStats();
+  const ProfileZoneStats* outer = FindZone(stats, "test outer");
+  REQUIRE(outer != nullptr);
+  REQUIRE(outer->count == 64);
+  REQUIRE(outer->nThreads >= 1);
+  REQUIRE(outer->minThreadTime <= outer->maxThreadTime);
+  REQUIRE(outer->maxThreadTime <= outer->totalTime);
+  REQUIRE(FindZone(stats, "test \"inner\"")->count == 64);
+
+  const std::string trace = Profiler::ToChromeTrace();
+  REQUIRE(trace.starts_with("{\"displayTimeUnit\""));
+  REQUIRE(CountOccurrences(trace, "\"name\":\"test outer\"") == 64);
+  REQUIRE(CountOccurrences(trace, "\"name\":\"test \\\"inner\\\"\"") == 64);
+  REQUIRE(CountOccurrences(trace, "\"ph\":\"M\"") == outer->nThreads);
+  REQUIRE(Profiler::get_nDropped() == 0);
+}
+
+TEST_CASE("Profiler: ring buffer keeps the newest events", "[Profiler]") {
+  Profiler::Clear();
+  Profiler::Enable(true);
+  const std::size_t nZones = Profiler::Capacity + 100;
+  for (std::size_t iZone = 0; iZone < nZones; iZone++) {
+    ProfileZone zone("test ring");
+  }
+  Profiler::Enable(false);
+
+  REQUIRE(Profiler::get_nDropped() == 100);
+  REQUIRE(FindZone(Profiler::GetZoneStats(), "test ring")->count == nZones);
+  REQUIRE(CountOccurrences(Profiler::ToChromeTrace(),
+                           "\"name\":\"test ring\"") == Profiler::Capacity);
+  Profiler::Clear();
+}
@@ -0,0 +1,93 @@
+#include "PointTargetFixture.h"
+#include "ReconQueue.h"
+#include "Saft.h"
+#include "catch2/catch_test_macros.hpp"
+#include <catch2/catch_all.hpp>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+using namespace opensaft;
+
+namespace {
+
+/// small raster with a point absorber whose depth depends on seed
+UltrasoundSignals CreateInput(const std::size_t seed) {
+  PointTargetFixture fixture;
+  fixture.nX = 11;
+  fixture.nY = 9;
+  fixture.nT = 80;
+  fixture.AddTarget({5ul, 4ul, 20 + seed * 10});
+  return fixture.Simulate();
+}
+
+Volume ReconstructDirectly(const std::size_t seed,
+                           const ReconSettings& sett) {
+  Saft S;
+  S.SetSettings(sett);
+  S.SetInput(CreateInput(seed));
+  S.Run();
+  return S.TakeVolume().value();
+}
+
+} // namespace
+
+TEST_CASE("ReconQueue: batch matches individual reconstructions") {
+  const unsigned int concurrency = GENERATE(1u, 2u, 3u);
+  ReconSettings sett;
+  sett.set_flagBandpass(true);
+  const Transducer trans;
+
+  std::mutex resultMutex;
+  std::map<std::size_t, Volume> results;
+  ReconQueue queue;
+  queue.SetConcurrency(concurrency);
+  for (std::size_t seed = 0; seed < 4; seed++)
+    queue.Add(CreateInput(seed), sett, trans, [&, seed](Volume&& volume) {
+      std::lock_guard<std::mutex> lock(resultMutex);
+      results.emplace(seed, std::move(volume));
+    });
+  REQUIRE(queue.get_nJobs() == 4);
+
+  const ReconQueueReport report = queue.Run();
+  REQUIRE(queue.get_nJobs() == 0);
+  REQUIRE(report.jobs.size() == 4);
+  REQUIRE(report.get_nFailed() == 0);
+  REQUIRE(results.size() == 4);
+  for (std::size_t seed = 0; seed < 4; seed++) {
+    REQUIRE(report.jobs[seed].reconTime > 0.0);
+    REQUIRE(results.at(seed) == ReconstructDirectly(seed, sett));
+  }
+  REQUIRE(report.ToString().find("4 jobs (0 failed)") != std::string::npos);
+}
+
+TEST_CASE("ReconQueue: failing jobs do not stop the batch") {
+  const ReconSettings sett;
+  const Transducer trans;
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "opensaft_queue.raw")
+          .string();
+  CreateInput(1).WriteToFile(path);
+
+  std::size_t nStored = 0;
+  const auto store = [&nStored](Volume&&) { nStored++; };
+  ReconQueue queue;
+  queue.SetPrefetchDepth(2);
+  queue.Add(ReconJob{"broken",
+                     []() -> UltrasoundSignals {
+                       throw std::runtime_error("file is corrupt");
+                     },
+                     sett, trans, store});
+  queue.Add(path, sett, trans, store);
+
+  const ReconQueueReport report = queue.Run();
+  REQUIRE(report.get_nFailed() == 1);
+  REQUIRE(report.jobs[0].error == "file is corrupt");
+  REQUIRE(report.jobs[1].name == path);
+  REQUIRE(report.jobs[1].error.empty());
+  REQUIRE(nStored == 1);
+  std::filesystem::remove(path);
+
+  REQUIRE_THROWS_AS(queue.SetConcurrency(0), std::invalid_argument);
+}
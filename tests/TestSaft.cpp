@@ -1,10 +1,171 @@
+#include "Memory/BrickVolumeFile.h"
 #include "Memory/UltrasoundSignals.h"
+#include "PointTargetFixture.h"
 #include "Saft.h"
+#include "StreamingSaft.h"
 #include "catch2/catch_test_macros.hpp"
+#include <algorithm>
+#include <atomic>
 #include <catch2/catch_all.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+/// bytes currently allocated through operator new and their maximum so far,
+/// counted by the replacements below to compare StreamingSaft::get_peakBytes
+/// against the actual allocations
+std::atomic<std::int64_t> allocatedBytes = 0;
+std::atomic<std::int64_t> peakAllocatedBytes = 0;
+
+void* CountedAlloc(const std::size_t n, const std::size_t alignment) {
+  // the size and the offset of the block are stored in front of it
+  const std::size_t header = std::max(alignment, 2 * sizeof(std::size_t));
+  void* block =
+      std::aligned_alloc(header, header + (n + header - 1) / header * header);
+  if (block == nullptr)
+    throw std::bad_alloc();
+  auto* sizes = reinterpret_cast<std::size_t*>(static_cast<char*>(block) +
+                                               header);
+  sizes[-1] = n;
+  sizes[-2] = header;
+
+  const auto bytes = static_cast<std::int64_t>(n);
+  const std::int64_t now = allocatedBytes.fetch_add(bytes) + bytes;
+  std::int64_t peak = peakAllocatedBytes.load();
+  while (now > peak && !peakAllocatedBytes.compare_exchange_weak(peak, now)) {
+  }
+  return sizes;
+}
+
+void CountedFree(void* ptr) noexcept {
+  if (ptr == nullptr)
+    return;
+  const auto* sizes = static_cast<const std::size_t*>(ptr);
+  allocatedBytes.fetch_sub(static_cast<std::int64_t>(sizes[-1]));
+  std::free(static_cast<char*>(ptr) - sizes[-2]);
+}
+
+} // namespace
+
+// all forms are replaced, sanitizer runtimes implement the ones left out
+// with their own allocator instead of forwarding them
+void* operator new(const std::size_t n) {
+  return CountedAlloc(n, alignof(std::max_align_t));
+}
+void* operator new(const std::size_t n, const std::align_val_t alignment) {
+  return CountedAlloc(n, static_cast<std::size_t>(alignment));
+}
+void* operator new(const std::size_t n, const std::nothrow_t&) noexcept {
+  try {
+    return CountedAlloc(n, alignof(std::max_align_t));
+  } catch (const std::bad_alloc&) {
+    return nullptr;
+  }
+}
+void* operator new(const std::size_t n, const std::align_val_t alignment,
+                   const std::nothrow_t&) noexcept {
+  try {
+    return CountedAlloc(n, static_cast<std::size_t>(alignment));
+  } catch (const std::bad_alloc&) {
+    return nullptr;
+  }
+}
+void* operator new[](const std::size_t n) { return operator new(n); }
+void* operator new[](const std::size_t n, const std::align_val_t alignment) {
+  return operator new(n, alignment);
+}
+void* operator new[](const std::size_t n, const std::nothrow_t& tag) noexcept {
+  return operator new(n, tag);
+}
+void* operator new[](const std::size_t n, const std::align_val_t alignment,
+                     const std::nothrow_t& tag) noexcept {
+  return operator new(n, alignment, tag);
+}
+void operator delete(void* ptr) noexcept { CountedFree(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { CountedFree(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept {
+  CountedFree(ptr);
+}
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+  CountedFree(ptr);
+}
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+  CountedFree(ptr);
+}
+void operator delete(void* ptr, std::align_val_t,
+                     const std::nothrow_t&) noexcept {
+  CountedFree(ptr);
+}
+void operator delete[](void* ptr) noexcept { CountedFree(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { CountedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+  CountedFree(ptr);
+}
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+  CountedFree(ptr);
+}
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+  CountedFree(ptr);
+}
+void operator delete[](void* ptr, std::align_val_t,
+                       const std::nothrow_t&) noexcept {
+  CountedFree(ptr);
+}
 
 using namespace opensaft;
 
+namespace {
+
+constexpr std::size_t nX = 21;
+constexpr std::size_t nY = 21;
+constexpr std::size_t nT = 100;
+constexpr std::size_t zTarget = 60;
+
+/// single point absorber below the central A-scan at time index zTarget,
+/// each A-scan receives it as a single sample
+PointTargetFixture CreateFixture(const ReconSettings& sett = ReconSettings()) {
+  PointTargetFixture fixture;
+  fixture.nX = nX;
+  fixture.nY = nY;
+  fixture.nT = nT;
+  fixture.settings = sett;
+  fixture.pulse = PulseShape::Delta;
+  fixture.AddTarget({nX / 2, nY / 2, zTarget});
+  return fixture;
+}
+
+Volume Reconstruct(const unsigned int threadCount) {
+  const PointTargetFixture fixture = CreateFixture();
+  return fixture.Reconstruct(fixture.Simulate(), threadCount);
+}
+
+/// creates a reconstruction of the point target with a bandpass, so that
+/// preprocessing the input twice would change the result
+void Configure(Saft& S, const ReconMode mode) {
+  ReconSettings sett;
+  sett.set_flagBandpass(true);
+  sett.set_bandpass(2e6f, 30e6f);
+  sett.set_mode(mode);
+  S.SetSettings(sett);
+  S.SetThreadCount(2);
+  S.SetInput(CreateFixture(sett).Simulate());
+}
+
+Volume ReconstructRegion(Saft& S, const Size3& start, const Size3& stop) {
+  S.SetRegion(start, stop);
+  S.Launch();
+  S.Wait();
+  return S.GetVolume().value();
+}
+
+} // namespace
+
 TEST_CASE("Saft: simple test recon") {
 
   UltrasoundSignals sig;
@@ -13,4 +174,291 @@ TEST_CASE("Saft: simple test recon") {
   S.SetInput(std::move(sig));
   S.Launch();
   S.Wait();
-}
\ No newline at end of file
+}
+
+TEST_CASE("Saft: point target is focused back to its origin") {
+  const Volume vol = Reconstruct(2);
+  REQUIRE(vol.get_dims() == Size3{nX, nY, nT});
+
+  const auto itMax = std::max_element(
+      vol.begin(), vol.end(),
+      [](float a, float b) { return std::fabs(a) < std::fabs(b); });
+  const std::size_t idxMax = std::distance(vol.begin(), itMax);
+  REQUIRE(idxMax % nX == nX / 2);
+  REQUIRE((idxMax / nX) % nY == nY / 2);
+  REQUIRE(idxMax / (nX * nY) == zTarget);
+}
+
+TEST_CASE("Saft: result does not depend on thread count") {
+  const unsigned int threadCount = GENERATE(3u, 8u);
+  Volume reference = Reconstruct(1);
+  const Volume vol = Reconstruct(threadCount);
+  REQUIRE(reference == vol);
+}
+
+TEST_CASE("StreamingSaft: slab wise result equals in memory reconstruction") {
+  ReconSettings sett;
+  Transducer trans;
+  const UltrasoundSignals sigs = CreateFixture(sett).Simulate();
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "opensaft_streaming.vol")
+          .string();
+
+  StreamingSaft S;
+  S.SetSettings(sett);
+  S.SetTransducer(trans);
+  S.SetThreadCount(2);
+  // room for all input rows but only a few output rows forces several slabs
+  S.SetMemoryBudget(nY * nX * 128 * sizeof(float) +
+                    5 * nX * (128 + nT) * sizeof(float));
+
+  SECTION("raw output") {
+    S.Run(sigs, path);
+    REQUIRE(S.get_slabHeight() > 1);
+    REQUIRE(S.get_slabHeight() < nY);
+    Volume vol = Volume::ReadFromFile(path);
+    REQUIRE(vol == Reconstruct(2));
+  }
+
+  SECTION("bricked output") {
+    S.SetOutputFormat(VolumeFileFormat::Bricked, 4);
+    S.Run(sigs, path);
+    REQUIRE(S.get_slabHeight() == 4);
+    Volume vol = BrickVolumeReader(path).ReadVolume();
+    REQUIRE(vol == Reconstruct(2));
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("StreamingSaft: reported peak covers the allocated samples") {
+  // many short A-scans keep the delay tables small compared to the samples
+  PointTargetFixture fixture;
+  fixture.nX = 64;
+  fixture.nY = 48;
+  fixture.nT = 400;
+  fixture.AddTarget({32ul, 24ul, 300ul});
+  const UltrasoundSignals sigs = fixture.Simulate();
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "opensaft_streaming.vol")
+          .string();
+
+  StreamingSaft S;
+  S.SetSettings(fixture.settings);
+  S.SetTransducer(fixture.transducer);
+  S.SetThreadCount(2);
+  S.SetMemoryBudget(sigs.size() * fixture.nT * sizeof(float) / 2);
+  // the first run fills the cached delay tables and thread local buffers
+  S.Run(sigs, path);
+  REQUIRE(S.get_slabHeight() < fixture.nY);
+
+  const std::int64_t before = allocatedBytes;
+  peakAllocatedBytes = before;
+  S.Run(sigs, path);
+  const auto measured =
+      static_cast<double>(peakAllocatedBytes.load() - before);
+  const auto reported = static_cast<double>(S.get_peakBytes());
+  UNSCOPED_INFO("measured " << measured << " bytes, reported " << reported);
+  REQUIRE(measured <= 1.1 * reported);
+  REQUIRE(measured >= 0.8 * reported);
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Saft: each run preprocesses the unchanged input") {
+  Saft S;
+  Configure(S, ReconMode::Exact);
+  S.Run();
+  const Volume first = S.TakeVolume().value();
+  // the taken volume forces a full reconstruction of the same input
+  S.Run();
+  REQUIRE(S.get_nReusedVoxels() == 0);
+  REQUIRE(S.TakeVolume().value() == first);
+}
+
+TEST_CASE("Saft: changing the region reuses the previous voxels") {
+  const ReconMode mode = GENERATE(ReconMode::Exact, ReconMode::Separable);
+  const Size3 firstStart{2ul, 0ul, 40ul};
+  const Size3 firstStop{14ul, nY, 80ul};
+  const Size3 start{6ul, 3ul, 50ul};
+  const Size3 stop{nX, 18ul, 100ul};
+
+  Saft S;
+  Configure(S, mode);
+  (void)ReconstructRegion(S, firstStart, firstStop);
+  REQUIRE(S.get_nReusedVoxels() == 0);
+  const Volume vol = ReconstructRegion(S, start, stop);
+  // shared part spans x [6, 14), y [3, 18), z [50, 80)
+  REQUIRE(S.get_nReusedVoxels() == 8 * 15 * 30);
+
+  Saft reference;
+  Configure(reference, mode);
+  REQUIRE(vol == ReconstructRegion(reference, start, stop));
+
+  SECTION("unchanged region is copied entirely") {
+    REQUIRE(ReconstructRegion(S, start, stop) == vol);
+    REQUIRE(S.get_nReusedVoxels() == vol.size());
+  }
+
+  SECTION("changed settings reconstruct everything") {
+    ReconSettings sett;
+    sett.set_flagBandpass(true);
+    sett.set_bandpass(2e6f, 30e6f);
+    sett.set_mode(mode);
+    sett.set_sos(1500.0f);
+    S.SetSettings(sett);
+    (void)ReconstructRegion(S, start, stop);
+    REQUIRE(S.get_nReusedVoxels() == 0);
+  }
+
+  SECTION("changed transducer reconstructs everything") {
+    Transducer trans;
+    trans.set_rAperture(trans.get_rAperture() * 0.5f);
+    S.SetTransducer(trans);
+    (void)ReconstructRegion(S, start, stop);
+    REQUIRE(S.get_nReusedVoxels() == 0);
+  }
+
+  SECTION("changed crop or bandpass preprocess the input again") {
+    const float t0Ms = CreateFixture().GetProperties().t0 * 1e3f;
+    ReconSettings sett;
+    sett.set_flagBandpass(true);
+    sett.set_bandpass(1e6f, 20e6f);
+    sett.set_cropT(t0Ms + 0.1e-3f, t0Ms + 0.9e-3f);
+    sett.set_mode(mode);
+    S.SetSettings(sett);
+    const Volume changed = ReconstructRegion(S, start, stop);
+    REQUIRE(S.get_nReusedVoxels() == 0);
+
+    Saft fresh;
+    fresh.SetSettings(sett);
+    fresh.SetThreadCount(2);
+    fresh.SetInput(CreateFixture(sett).Simulate());
+    REQUIRE(changed == ReconstructRegion(fresh, start, stop));
+  }
+
+  SECTION("lateral crop of the settings does not affect reuse") {
+    ReconSettings sett;
+    sett.set_flagBandpass(true);
+    sett.set_bandpass(2e6f, 30e6f);
+    sett.set_mode(mode);
+    sett.set_cropX(1.0f, 2.0f);
+    sett.set_cropY(-2.0f, 3.0f);
+    S.SetSettings(sett);
+    REQUIRE(ReconstructRegion(S, start, stop) == vol);
+    REQUIRE(S.get_nReusedVoxels() == vol.size());
+  }
+
+  SECTION("taken volumes are not reused") {
+    (void)S.TakeVolume();
+    (void)ReconstructRegion(S, start, stop);
+    REQUIRE(S.get_nReusedVoxels() == 0);
+  }
+}
+
+TEST_CASE("Saft: progressive passes converge to the full reconstruction") {
+  const unsigned int stride = GENERATE(2u, 4u);
+  ReconSettings sett;
+  Transducer trans;
+  Saft S;
+  S.SetSettings(sett);
+  S.SetTransducer(trans);
+  S.SetThreadCount(2);
+  S.SetPreviewStride(stride);
+  S.SetInput(CreateFixture(sett).Simulate());
+  REQUIRE(S.GetSnapshot().volume == nullptr);
+  S.Launch();
+  S.Wait();
+
+  const Volume vol = S.GetVolume().value();
+  REQUIRE(vol == Reconstruct(2));
+
+  // the last preview holds the columns of every second A-scan, the other
+  // columns are copies of their neighbour on that lattice
+  const ReconSnapshot snapshot = S.GetSnapshot();
+  REQUIRE(snapshot.stride == 2);
+  REQUIRE(snapshot.volume != nullptr);
+  std::size_t nMismatches = 0;
+  for (std::size_t z = 0; z < nT; z++)
+    for (std::size_t y = 0; y < nY; y++)
+      for (std::size_t x = 0; x < nX; x++)
+        if ((*snapshot.volume)(x, y, z) != vol(x - x % 2, y - y % 2, z))
+          nMismatches++;
+  REQUIRE(nMismatches == 0);
+
+  REQUIRE_THROWS_AS(S.SetPreviewStride(3), std::invalid_argument);
+}
+
+TEST_CASE("Saft: cancelled reconstructions resume where they stopped") {
+  ReconSettings sett;
+  Transducer trans;
+  Saft S;
+  S.SetSettings(sett);
+  S.SetTransducer(trans);
+  S.SetThreadCount(2);
+  S.SetInput(CreateFixture(sett).Simulate());
+  const Volume reference = Reconstruct(2);
+
+  SECTION("paused before the first tile") {
+    S.Pause();
+    S.Launch();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    REQUIRE(S.get_isRunning());
+    REQUIRE(S.get_percDone() == 0.0f);
+    S.Cancel();
+    S.Wait();
+    REQUIRE(S.get_isCancelled());
+    REQUIRE_FALSE(S.get_isRunning());
+  }
+
+  SECTION("cancelled while running") {
+    S.Launch();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    S.Cancel();
+    S.Wait();
+  }
+
+  SECTION("paused and resumed") {
+    S.Pause();
+    S.Launch();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    REQUIRE(S.get_isPaused());
+    S.Resume();
+    S.Wait();
+    REQUIRE_FALSE(S.get_isCancelled());
+    REQUIRE(S.GetVolume().value() == reference);
+  }
+
+  // the voxels of the finished tiles are kept
+  const float percDone = S.get_isCancelled() ? S.get_percDone() : 100.0f;
+  S.Launch();
+  S.Wait();
+  REQUIRE_FALSE(S.get_isCancelled());
+  REQUIRE(S.get_nReusedVoxels() ==
+          static_cast<uint64_t>(percDone / 100.0f * reference.size() + 0.5f));
+  REQUIRE(S.GetVolume().value() == reference);
+}
+
+TEST_CASE("Saft: relaunching after a cancelled pause does not hold") {
+  Saft S;
+  S.SetThreadCount(2);
+  S.SetInput(CreateFixture().Simulate());
+  S.Pause();
+  S.Launch();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  S.Cancel();
+  S.Wait();
+  REQUIRE(S.get_isCancelled());
+
+  S.Launch();
+  REQUIRE_FALSE(S.get_isPaused());
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(30);
+  while (S.get_isRunning() && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  const bool isFinished = !S.get_isRunning();
+  // release a held run so that the test ends either way
+  S.Resume();
+  S.Wait();
+  REQUIRE(isFinished);
+  REQUIRE_FALSE(S.get_isCancelled());
+  REQUIRE(S.GetVolume().value() == Reconstruct(2));
+}
@@ -0,0 +1,128 @@
+#include "PointTargetFixture.h"
+#include "Recon/Accuracy.h"
+#include "Recon/SeparableSaft.h"
+#include "catch2/catch_test_macros.hpp"
+#include <catch2/catch_all.hpp>
+#include <cmath>
+
+using namespace opensaft;
+
+namespace {
+
+/// three absorbers in front of, close to and behind the focal plane
+UltrasoundSignals CreateTargets() {
+  PointTargetFixture fixture;
+  fixture.AddTarget({15ul, 13ul, 40ul});
+  fixture.AddTarget({10ul, 17ul, 100ul}, 0.7f);
+  fixture.AddTarget({20ul, 9ul, 170ul});
+  return fixture.Simulate();
+}
+
+Volume Reconstruct(const ReconMode mode, const UltrasoundSignals& sigs,
+                   const bool flagCoherenceW = true) {
+  PointTargetFixture fixture;
+  fixture.settings.set_mode(mode);
+  *fixture.settings.get_pflagCoherenceW() = flagCoherenceW;
+  return fixture.Reconstruct(sigs);
+}
+
+} // namespace
+
+TEST_CASE("SeparableSaft: tables hold a single line each") {
+  const UltrasoundSignals sigs = CreateTargets();
+  const SaftGeometry geom =
+      SaftGeometry::Create(sigs, ReconSettings(), Transducer());
+  const SeparableSaft separable(geom);
+  REQUIRE(separable.get_tableX().get_maxOffsetY() == 0);
+  REQUIRE(separable.get_tableY().get_maxOffsetX() == 0);
+
+  // the lines are the axes of the full table
+  const auto full = DelayTable::Get(geom);
+  REQUIRE(separable.get_tableX().get_maxOffsetX() == full->get_maxOffsetX());
+  REQUIRE(separable.get_tableY().get_maxOffsetY() == full->get_maxOffsetY());
+  for (int zIm = 0; zIm < geom.nT; zIm++) {
+    for (const DelayEntry& entry : separable.get_tableX().get_entries(zIm)) {
+      const auto entries = full->get_entries(zIm);
+      REQUIRE(std::find_if(entries.begin(), entries.end(),
+                           [&](const DelayEntry& e) {
+                             return e.offsetX == entry.offsetX &&
+                                    e.offsetY == 0 && e.tIdx == entry.tIdx;
+                           }) != entries.end());
+    }
+  }
+}
+
+TEST_CASE("SeparableSaft: close to the exact reconstruction") {
+  const bool flagCoherenceW = GENERATE(true, false);
+  const UltrasoundSignals sigs = CreateTargets();
+  const Volume exact = Reconstruct(ReconMode::Exact, sigs, flagCoherenceW);
+  const Volume approx =
+      Reconstruct(ReconMode::Separable, sigs, flagCoherenceW);
+  REQUIRE(approx.get_dims() == exact.get_dims());
+  REQUIRE(approx.get_res() == exact.get_res());
+
+  const AccuracyReport report = CompareVolumes(exact, approx);
+  INFO(ToString(report));
+  // the coherence factor squares the deviations of the sums
+  REQUIRE(report.correlation > 0.85f);
+  // at most one voxel off along each axis due to the twice rounded delays
+  REQUIRE(report.peakShift < 1.8f);
+  REQUIRE(std::fabs(report.peakRatio - 1.0f) < 0.2f);
+}
+
+TEST_CASE("SeparableSaft: region matches the full reconstruction") {
+  const UltrasoundSignals sigs = CreateTargets();
+  const SaftGeometry geom =
+      SaftGeometry::Create(sigs, ReconSettings(), Transducer());
+  const SeparableSaft separable(geom);
+
+  Volume full({sigs.get_nX(), sigs.get_nY(), sigs.get_nT()});
+  separable.Reconstruct(sigs, Size3(), full.get_dims(), full, 3);
+
+  Size3 start;
+  start[0] = 4;
+  start[1] = 10;
+  start[2] = 30;
+  Size3 stop;
+  stop[0] = 29;
+  stop[1] = 20;
+  stop[2] = 180;
+  Volume region(stop - start);
+  uint64_t nDone = 0;
+  separable.Reconstruct(sigs, start, stop, region, 1,
+                        [&nDone](const uint64_t n) { nDone += n; });
+  REQUIRE(nDone == region.size());
+  for (std::size_t iZ = 0; iZ < region.get_dim(2); iZ++)
+    for (std::size_t iY = 0; iY < region.get_dim(1); iY++)
+      for (std::size_t iX = 0; iX < region.get_dim(0); iX++)
+        REQUIRE(std::fabs(region(iX, iY, iZ) -
+                          full(iX + start[0], iY + start[1], iZ + start[2])) <
+                1e-5f);
+
+  Volume wrongSize({sigs.get_nX(), sigs.get_nY(), 1ul});
+  REQUIRE_THROWS_AS(separable.Reconstruct(sigs, start, stop, wrongSize),
+                    std::invalid_argument);
+}
+
+TEST_CASE("SeparableSaft: accuracy report") {
+  Volume reference({4ul, 3ul, 2ul});
+  for (std::size_t iVox = 0; iVox < reference.size(); iVox++)
+    reference[iVox] = std::sin(static_cast<float>(iVox));
+  const AccuracyReport same = CompareVolumes(reference, reference);
+  REQUIRE(same.maxError == 0.0f);
+  REQUIRE(same.rmsError == 0.0f);
+  REQUIRE(std::fabs(same.correlation - 1.0f) < 1e-6f);
+  REQUIRE(same.peakShift == 0.0f);
+
+  Volume scaled = reference;
+  for (float& voxel : scaled)
+    voxel *= 0.5f;
+  const AccuracyReport half = CompareVolumes(reference, scaled);
+  REQUIRE(std::fabs(half.maxError - 0.5f) < 1e-6f);
+  REQUIRE(std::fabs(half.rmsError - 0.5f) < 1e-6f);
+  REQUIRE(std::fabs(half.peakRatio - 0.5f) < 1e-6f);
+  REQUIRE(std::fabs(half.correlation - 1.0f) < 1e-6f);
+
+  REQUIRE_THROWS_AS(CompareVolumes(reference, Volume({4ul, 3ul, 1ul})),
+                    std::invalid_argument);
+}
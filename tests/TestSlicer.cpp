@@ -0,0 +1,128 @@
+#include "Slicer/Slicer.h"
+#include "catch2/catch_test_macros.hpp"
+#include <catch2/catch_all.hpp>
+#include <optional>
+#include <stdexcept>
+
+using namespace opensaft;
+
+namespace {
+
+/// voxel value encodes its position
+Volume CreateVolume() {
+  Volume vol({37ul, 21ul, 9ul});
+  for (std::size_t z = 0; z < vol.get_dim(2); z++)
+    for (std::size_t y = 0; y < vol.get_dim(1); y++)
+      for (std::size_t x = 0; x < vol.get_dim(0); x++)
+        vol(x, y, z) = static_cast<float>(x + 100 * y + 10000 * z);
+  return vol;
+}
+
+float Expected(const Dimension dim, const std::size_t index,
+               const std::size_t iCol, const std::size_t iRow) {
+  switch (dim) {
+  case Dimension::X:
+    return static_cast<float>(index + 100 * iCol + 10000 * iRow);
+  case Dimension::Y:
+    return static_cast<float>(iCol + 100 * index + 10000 * iRow);
+  case Dimension::Z:
+    break;
+  }
+  return static_cast<float>(iCol + 100 * iRow + 10000 * index);
+}
+
+} // namespace
+
+TEST_CASE("Slicer: slices along all dimensions") {
+  const Volume vol = CreateVolume();
+  Slicer slicer(vol);
+  const Dimension dim = GENERATE(Dimension::X, Dimension::Y, Dimension::Z);
+  const std::size_t nSlices =
+      vol.get_dim(static_cast<uint8_t>(static_cast<int>(dim)));
+
+  // all slices include the last partial block of transposed slices
+  for (std::size_t index = 0; index < nSlices; index++) {
+    const SliceView strided = slicer.GetStridedSlice(dim, index);
+    const SliceView slice = slicer.GetSlice(dim, index);
+    REQUIRE(slice.IsContiguous());
+    REQUIRE(slice.nCols == strided.nCols);
+    REQUIRE(slice.nRows == strided.nRows);
+    for (std::size_t iRow = 0; iRow < slice.nRows; iRow++)
+      for (std::size_t iCol = 0; iCol < slice.nCols; iCol++) {
+        REQUIRE(strided(iCol, iRow) == Expected(dim, index, iCol, iRow));
+        REQUIRE(slice.data[iCol + slice.nCols * iRow] ==
+                Expected(dim, index, iCol, iRow));
+      }
+  }
+  REQUIRE_THROWS_AS(slicer.GetSlice(dim, nSlices), std::invalid_argument);
+}
+
+TEST_CASE("Slicer: slices are views or reuse their buffers") {
+  Volume vol = CreateVolume();
+  Slicer slicer(vol);
+  REQUIRE(slicer.GetSlice(Dimension::Z, 3).data == &vol(0, 0, 3));
+
+  const float* yBuffer = slicer.GetSlice(Dimension::Y, 1).data;
+  REQUIRE(slicer.GetSlice(Dimension::Y, 2).data == yBuffer);
+
+  const SliceView first = slicer.GetSlice(Dimension::X, 0);
+  const SliceView second = slicer.GetSlice(Dimension::X, 1);
+  REQUIRE(second.data == first.data + first.size());
+
+  vol(1, 0, 0) = -1.0f;
+  REQUIRE(slicer.GetSlice(Dimension::X, 1)(0, 0) == -1.0f);
+
+  float* voxels = vol.data();
+  REQUIRE(slicer.GetSlice(Dimension::X, 1)(0, 0) == -1.0f);
+  voxels[1] = -2.0f;
+  slicer.Invalidate();
+  REQUIRE(slicer.GetSlice(Dimension::X, 1)(0, 0) == -2.0f);
+}
+
+TEST_CASE("Slicer: a replaced volume is transposed again") {
+  std::optional<Volume> vol;
+  vol.emplace(CreateVolume());
+  Slicer slicer(*vol);
+  REQUIRE(slicer.GetSlice(Dimension::X, 20).nCols == 21);
+
+  vol.emplace(Volume({23ul, 5ul, 4ul}));
+  *vol = 3.0f;
+  const SliceView slice = slicer.GetSlice(Dimension::X, 20);
+  REQUIRE(slice.nCols == 5);
+  REQUIRE(slice.nRows == 4);
+  for (std::size_t iRow = 0; iRow < slice.nRows; iRow++)
+    for (std::size_t iCol = 0; iCol < slice.nCols; iCol++)
+      REQUIRE(slice(iCol, iRow) == 3.0f);
+}
+
+TEST_CASE("Slicer: oblique slices interpolate trilinearly") {
+  const Volume vol = CreateVolume();
+  Slicer slicer(vol);
+
+  // an axis aligned plane reproduces the slice
+  const SliceView plane = slicer.GetObliqueSlice(
+      {0.0f, 0.0f, 4.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f},
+      vol.get_dim(0), vol.get_dim(1));
+  for (std::size_t iRow = 0; iRow < plane.nRows; iRow++)
+    for (std::size_t iCol = 0; iCol < plane.nCols; iCol++)
+      REQUIRE(plane(iCol, iRow) == Expected(Dimension::Z, 4, iCol, iRow));
+
+  // the voxels are linear in their indices, so is the interpolation
+  const SliceView oblique = slicer.GetObliqueSlice(
+      {2.5f, 1.25f, 0.5f}, {0.5f, 0.5f, 0.25f}, {0.0f, 1.0f, 0.5f}, 8, 10);
+  REQUIRE(oblique.IsContiguous());
+  for (std::size_t iRow = 0; iRow < oblique.nRows; iRow++)
+    for (std::size_t iCol = 0; iCol < oblique.nCols; iCol++) {
+      const float x = 2.5f + 0.5f * iCol;
+      const float y = 1.25f + 0.5f * iCol + iRow;
+      const float z = 0.5f + 0.25f * iCol + 0.5f * iRow;
+      const float expected =
+          (z <= 8.0f) ? x + 100.0f * y + 10000.0f * z : 0.0f;
+      REQUIRE(fabs(oblique(iCol, iRow) - expected) < 1e-2f);
+    }
+
+  const SliceView outside = slicer.GetObliqueSlice(
+      {-1.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, 2, 1);
+  REQUIRE(outside(0, 0) == 0.0f);
+  REQUIRE(outside(1, 0) == Expected(Dimension::Z, 0, 0, 0));
+}
@@ -0,0 +1,49 @@
+#include "Util/ParallelFor.h"
+#include "Util/ThreadPool.h"
+#include "catch2/catch_test_macros.hpp"
+#include <atomic>
+#include <catch2/catch_all.hpp>
+#include <stdexcept>
+#include <vector>
+
+using namespace opensaft;
+
+TEST_CASE("ThreadPool: runs all tasks before it is destroyed") {
+  std::atomic<int> nDone = 0;
+  {
+    ThreadPool pool(3);
+    REQUIRE(pool.get_nThreads() == 3);
+    for (int iTask = 0; iTask < 100; iTask++)
+      pool.Submit([&nDone]() { nDone++; });
+  }
+  REQUIRE(nDone == 100);
+}
+
+TEST_CASE("ParallelFor: visits every index once on the shared pool") {
+  const unsigned int threadCount = GENERATE(1u, 4u, 64u);
+  std::vector<std::atomic<int>> visits(1000);
+  ParallelFor(visits.size(), threadCount,
+              [&visits](const std::size_t i) { visits[i]++; });
+  for (const auto& count : visits)
+    REQUIRE(count == 1);
+}
+
+TEST_CASE("ParallelFor: nested loops do not wait for busy pool threads") {
+  // more outer indices than pool threads, each blocking its thread with an
+  // inner loop which needs helpers of the same pool
+  const unsigned int nOuter = 4 * ThreadPool::GetShared().get_nThreads();
+  std::atomic<std::size_t> sum = 0;
+  ParallelFor(nOuter, nOuter, [&sum](const std::size_t) {
+    ParallelFor(100, 0, [&sum](const std::size_t i) { sum += i; });
+  });
+  REQUIRE(sum == nOuter * 4950);
+}
+
+TEST_CASE("ParallelFor: exceptions are rethrown in the caller") {
+  REQUIRE_THROWS_AS(ParallelFor(100, 4,
+                                [](const std::size_t i) {
+                                  if (i == 42)
+                                    throw std::runtime_error("failed");
+                                }),
+                    std::runtime_error);
+}
@@ -0,0 +1,48 @@
+#include "Util/TileScheduler.h"
+#include "catch2/catch_test_macros.hpp"
+#include <catch2/catch_all.hpp>
+#include <set>
+
+using namespace opensaft;
+
+TEST_CASE("TileScheduler: partition covers the full volume") {
+  const Size3 dims{10ul, 7ul, 33ul};
+  const auto tiles = TileScheduler::Partition(dims, {4ul, 4ul, 8ul});
+  REQUIRE(tiles.size() == 3 * 2 * 5);
+
+  std::size_t nVoxels = 0;
+  for (const auto& tile : tiles) {
+    for (std::size_t iDim = 0; iDim < 3; iDim++)
+      REQUIRE(tile.stop[iDim] <= dims[iDim]);
+    nVoxels += tile.get_nVoxels();
+  }
+  REQUIRE(nVoxels == dims.InnerProduct());
+  REQUIRE_THROWS(TileScheduler::Partition(dims, {0ul, 4ul, 8ul}));
+}
+
+TEST_CASE("TileScheduler: expensive tiles first, every tile exactly once") {
+  std::vector<Tile> tiles(20);
+  for (std::size_t iTile = 0; iTile < tiles.size(); iTile++) {
+    tiles[iTile].start = Size3{iTile, 0ul, 0ul};
+    tiles[iTile].cost = static_cast<double>(iTile);
+  }
+
+  TileScheduler scheduler(tiles, 3);
+  REQUIRE(scheduler.get_nWorkers() == 3);
+
+  // worker 0 receives the most expensive tile and drains its own queue in
+  // order of descending cost before it starts stealing
+  auto first = scheduler.Pop(0);
+  REQUIRE(first.has_value());
+  REQUIRE(first->cost == 19.0);
+  REQUIRE(scheduler.Pop(0)->cost == 16.0);
+
+  std::set<std::size_t> seen{first->start[0], 16};
+  while (auto tile = scheduler.Pop(0))
+    REQUIRE(seen.insert(tile->start[0]).second);
+
+  REQUIRE(seen.size() == tiles.size());
+  REQUIRE(scheduler.get_nStolen() > 0);
+  REQUIRE_FALSE(scheduler.Pop(1).has_value());
+  REQUIRE_THROWS(TileScheduler(tiles, 0));
+}
@@ -1,6 +1,14 @@
 #include "Memory/UltrasoundSignals.h"
 #include "catch2/catch_test_macros.hpp"
 #include <catch2/catch_all.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <utility>
+#include <sys/resource.h>
+
+#ifdef OPENSAFT_HDF5_SUPPORT
+#include <hdf5.h>
+#endif
 
 using namespace opensaft;
 
@@ -28,4 +36,237 @@ TEST_CASE("TimeSignals: remove DC test") {
     avg += elem;
   }
   REQUIRE(std::abs(avg) < 1e-4);
-}
\ No newline at end of file
+}
+TEST_CASE("UltrasoundSignals: contiguous aligned raster") {
+  AcquisitionProperties props;
+  props.nX = 3;
+  props.nY = 2;
+  props.dx = 10e-6f;
+  props.dy = 20e-6f;
+  props.t0 = 1e-6f;
+  const std::size_t nt = GENERATE(1, 16, 37);
+  UltrasoundSignals sigs(props, nt);
+
+  REQUIRE(sigs.size() == 6);
+  REQUIRE(sigs.get_nT() == nt);
+  REQUIRE(sigs.get_stride() >= nt);
+  REQUIRE(sigs.IsRaster());
+
+  // every waveform starts on its own cache line, x is the fast scan axis
+  for (std::size_t iSig = 0; iSig < sigs.size(); iSig++) {
+    const auto address = reinterpret_cast<std::uintptr_t>(sigs[iSig].data());
+    REQUIRE(address % UltrasoundSignals::Alignment == 0);
+    REQUIRE(sigs[iSig].data() == sigs.data() + iSig * sigs.get_stride());
+  }
+  REQUIRE(sigs(2, 1).data() == sigs[5].data());
+
+  // views iterate over all waveforms and write through to the slab
+  std::size_t nSignals = 0;
+  for (auto sig : sigs) {
+    REQUIRE(sig.size() == nt);
+    for (auto& elem : sig)
+      elem = static_cast<float>(nSignals);
+    nSignals++;
+  }
+  REQUIRE(nSignals == sigs.size());
+  REQUIRE(sigs(1, 1)[nt - 1] == 4.0f);
+
+  const auto props11 = sigs.get_signalProperties(1 + 3 * 1);
+  REQUIRE(props11.pos[0] == props.dx);
+  REQUIRE(props11.pos[1] == props.dy);
+  REQUIRE(props11.deltaT == props.t0);
+}
+
+TEST_CASE("UltrasoundSignals: remove DC through views") {
+  AcquisitionProperties props;
+  props.nX = 2;
+  props.nY = 2;
+  UltrasoundSignals sigs(props, 50);
+  for (auto sig : sigs) {
+    for (std::size_t it = 0; it < sig.size(); it++)
+      sig[it] = static_cast<float>(it) + 3.0f;
+    sig.RemoveDC();
+  }
+
+  for (const auto sig : std::as_const(sigs)) {
+    double avg = 0.0;
+    for (const float elem : sig)
+      avg += elem;
+    REQUIRE(std::abs(avg) < 1e-4);
+  }
+}
+
+TEST_CASE("UltrasoundSignals: raw file is mapped without copy") {
+  AcquisitionProperties props;
+  props.nX = 4;
+  props.nY = 3;
+  props.dx = 12e-6f;
+  props.sampleRate = 250e6f;
+  props.origin = {1e-3f, 2e-3f, 0.0f};
+  UltrasoundSignals sigs(props, 21);
+  for (std::size_t iSig = 0; iSig < sigs.size(); iSig++) {
+    for (std::size_t it = 0; it < sigs.get_nT(); it++)
+      sigs[iSig][it] = static_cast<float>(iSig * 100 + it);
+  }
+
+  const auto filePath =
+      (std::filesystem::temp_directory_path() / "opensaft_test.raw").string();
+  sigs.WriteToFile(filePath);
+
+  UltrasoundSignals loaded = UltrasoundSignals::ReadFromFile(filePath);
+  REQUIRE(loaded.IsMapped());
+  REQUIRE(loaded.get_nX() == 4);
+  REQUIRE(loaded.get_nY() == 3);
+  REQUIRE(loaded.get_nT() == 21);
+  REQUIRE(loaded.get_properties().dx == props.dx);
+  REQUIRE(loaded.get_properties().sampleRate == props.sampleRate);
+  REQUIRE(loaded.get_properties().origin == props.origin);
+  REQUIRE(reinterpret_cast<std::uintptr_t>(loaded.data()) %
+              UltrasoundSignals::Alignment ==
+          0);
+  for (std::size_t iSig = 0; iSig < sigs.size(); iSig++) {
+    for (std::size_t it = 0; it < sigs.get_nT(); it++)
+      REQUIRE(loaded[iSig][it] == sigs[iSig][it]);
+  }
+
+  // copies own their samples, modifications never reach the file
+  UltrasoundSignals copy = loaded;
+  REQUIRE_FALSE(copy.IsMapped());
+  REQUIRE(copy(3, 2)[20] == loaded(3, 2)[20]);
+  loaded[0][0] = -1.0f;
+  REQUIRE(UltrasoundSignals::ReadFromFile(filePath)[0][0] == 0.0f);
+  REQUIRE(copy[0][0] == 0.0f);
+
+  std::filesystem::remove(filePath);
+  REQUIRE_THROWS(UltrasoundSignals::ReadFromFile(filePath));
+}
+
+TEST_CASE("UltrasoundSignals: prefetched samples are read without faults") {
+  AcquisitionProperties props;
+  props.nX = 64;
+  props.nY = 64;
+  UltrasoundSignals sigs(props, 1024);
+  for (std::size_t iSig = 0; iSig < sigs.size(); iSig++)
+    sigs[iSig][iSig % 1024] = 1.0f;
+  const auto filePath =
+      (std::filesystem::temp_directory_path() / "opensaft_test.raw").string();
+  sigs.WriteToFile(filePath);
+
+  // page faults of the calling thread while summing all samples
+  const auto countFaults = [](const UltrasoundSignals& loaded) {
+    rusage before;
+    getrusage(RUSAGE_THREAD, &before);
+    float sum = 0.0f;
+    for (std::size_t iSig = 0; iSig < loaded.size(); iSig++)
+      for (const float value : loaded[iSig])
+        sum += value;
+    rusage after;
+    getrusage(RUSAGE_THREAD, &after);
+    REQUIRE(sum == static_cast<float>(loaded.size()));
+    return (after.ru_minflt - before.ru_minflt) +
+           (after.ru_majflt - before.ru_majflt);
+  };
+
+  const UltrasoundSignals lazy = UltrasoundSignals::ReadFromFile(filePath);
+  const long lazyFaults = countFaults(lazy);
+  const UltrasoundSignals prefetched =
+      UltrasoundSignals::ReadFromFile(filePath);
+  prefetched.Prefetch();
+  const long prefetchedFaults = countFaults(prefetched);
+  UNSCOPED_INFO(lazyFaults << " faults without and " << prefetchedFaults
+                           << " with prefetching");
+#ifndef __SANITIZE_THREAD__
+  // the thread sanitizer faults in its shadow memory on every first access
+  REQUIRE(lazyFaults > 4);
+  REQUIRE(prefetchedFaults <= 2);
+#endif
+  std::filesystem::remove(filePath);
+}
+
+#ifdef OPENSAFT_HDF5_SUPPORT
+TEST_CASE("UltrasoundSignals: contiguous HDF5 dataset is mapped") {
+  constexpr hsize_t dims[3] = {2, 3, 5}; // nY, nX, nT
+  std::vector<float> values(2 * 3 * 5);
+  for (std::size_t idx = 0; idx < values.size(); idx++)
+    values[idx] = static_cast<float>(idx) * 0.5f;
+
+  const auto filePath =
+      (std::filesystem::temp_directory_path() / "opensaft_test.h5").string();
+  {
+    const hid_t file =
+        H5Fcreate(filePath.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    const hid_t space = H5Screate_simple(3, dims, nullptr);
+    const hid_t dataset =
+        H5Dcreate2(file, "signals", H5T_NATIVE_FLOAT, space, H5P_DEFAULT,
+                   H5P_DEFAULT, H5P_DEFAULT);
+    H5Dwrite(dataset, H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+             values.data());
+    const hid_t attrSpace = H5Screate(H5S_SCALAR);
+    const hid_t attr = H5Acreate2(dataset, "dx", H5T_NATIVE_FLOAT, attrSpace,
+                                  H5P_DEFAULT, H5P_DEFAULT);
+    const float dx = 7e-6f;
+    H5Awrite(attr, H5T_NATIVE_FLOAT, &dx);
+    H5Aclose(attr);
+    H5Sclose(attrSpace);
+    H5Dclose(dataset);
+    H5Sclose(space);
+    H5Fclose(file);
+  }
+
+  const UltrasoundSignals sigs = UltrasoundSignals::ReadFromFile(filePath);
+  REQUIRE(sigs.IsMapped());
+  REQUIRE(sigs.get_nX() == 3);
+  REQUIRE(sigs.get_nY() == 2);
+  REQUIRE(sigs.get_nT() == 5);
+  REQUIRE(sigs.get_properties().dx == 7e-6f);
+  REQUIRE(sigs(2, 1)[4] == values.back());
+  REQUIRE(sigs(1, 0)[2] == values[1 * 5 + 2]);
+  std::filesystem::remove(filePath);
+}
+
+TEST_CASE("UltrasoundSignals: HDF5 dataset behind a user block is mapped") {
+  // MATLAB v7.3 files start with a 512 byte user block
+  constexpr hsize_t dims[3] = {3, 4, 300}; // nY, nX, nT
+  std::vector<float> values(3 * 4 * 300);
+  for (std::size_t idx = 0; idx < values.size(); idx++)
+    values[idx] = static_cast<float>(idx) * 0.25f;
+
+  const auto filePath =
+      (std::filesystem::temp_directory_path() / "opensaft_test.mat").string();
+  {
+    const hid_t fcpl = H5Pcreate(H5P_FILE_CREATE);
+    H5Pset_userblock(fcpl, 512);
+    const hid_t file =
+        H5Fcreate(filePath.c_str(), H5F_ACC_TRUNC, fcpl, H5P_DEFAULT);
+    const hid_t space = H5Screate_simple(3, dims, nullptr);
+    const hid_t dataset =
+        H5Dcreate2(file, "signals", H5T_NATIVE_FLOAT, space, H5P_DEFAULT,
+                   H5P_DEFAULT, H5P_DEFAULT);
+    H5Dwrite(dataset, H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+             values.data());
+    H5Dclose(dataset);
+    H5Sclose(space);
+    H5Fclose(file);
+    H5Pclose(fcpl);
+  }
+
+  std::vector<float> expected(values.size(), 0.0f);
+  {
+    const hid_t file = H5Fopen(filePath.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    const hid_t dataset = H5Dopen2(file, "signals", H5P_DEFAULT);
+    H5Dread(dataset, H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+            expected.data());
+    H5Dclose(dataset);
+    H5Fclose(file);
+  }
+  REQUIRE(expected == values);
+
+  const UltrasoundSignals sigs = UltrasoundSignals::ReadFromFile(filePath);
+  REQUIRE(sigs.IsMapped());
+  for (std::size_t y = 0; y < dims[0]; y++)
+    for (std::size_t x = 0; x < dims[1]; x++)
+      for (std::size_t t = 0; t < dims[2]; t++)
+        REQUIRE(sigs(x, y)[t] == expected[t + dims[2] * (x + dims[1] * y)]);
+  std::filesystem::remove(filePath);
+}
+#endif
@@ -1,6 +1,11 @@
 #include "Memory/Volume.h"
+#include "Util/ParallelFor.h"
 #include "catch2/catch_test_macros.hpp"
 #include <catch2/catch_all.hpp>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <utility>
 
 using namespace opensaft;
 
@@ -34,4 +39,96 @@ TEST_CASE("Volume: assign to full volume") {
   for (const auto& elem : V) {
     REQUIRE(elem == setPoint);
   }
-}
\ No newline at end of file
+}
+TEST_CASE("Volume: file round trip") {
+  Volume V({3, 4, 5});
+  for (std::size_t idx = 0; idx < V.size(); idx++)
+    V[idx] = static_cast<float>(idx) * 0.5f;
+  V.set_res({1e-5f, 2e-5f, 3e-5f});
+  V.set_center({1e-3f, -2e-3f, 5e-3f});
+
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "opensaft_volume.vol")
+          .string();
+  V.WriteToFile(path);
+  Volume loaded = Volume::ReadFromFile(path);
+  std::filesystem::remove(path);
+  REQUIRE(loaded == V);
+}
+
+TEST_CASE("Volume: statistics match a serial reference") {
+  // odd dimensions leave a remainder after the vector lanes and chunks
+  Volume V({71ul, 53ul, 37ul});
+  for (std::size_t idx = 0; idx < V.size(); idx++)
+    V[idx] = std::sin(static_cast<float>(idx) * 0.01f) * 3.0f - 0.5f;
+
+  double sum = 0.0;
+  double sumSq = 0.0;
+  for (const float value : std::as_const(V)) {
+    sum += value;
+    sumSq += static_cast<double>(value) * value;
+  }
+  const double mean = sum / V.size();
+  const double std = std::sqrt(sumSq / V.size() - mean * mean);
+
+  const std::size_t nBins = 64;
+  const unsigned int threadCount = GENERATE(1u, 3u);
+  const VolumeStats stats = CalculateStats(V, nBins, threadCount);
+  REQUIRE(stats.minVal ==
+          *std::min_element(std::as_const(V).begin(), std::as_const(V).end()));
+  REQUIRE(stats.maxVal ==
+          *std::max_element(std::as_const(V).begin(), std::as_const(V).end()));
+  REQUIRE(stats.absMax == std::max(-stats.minVal, stats.maxVal));
+  REQUIRE(fabs(stats.mean - mean) < 1e-5);
+  REQUIRE(fabs(stats.std - std) < 1e-5);
+  REQUIRE(stats.nValues == V.size());
+
+  REQUIRE(stats.histogram.size() == nBins);
+  uint64_t nCounted = 0;
+  for (const uint64_t count : stats.histogram)
+    nCounted += count;
+  REQUIRE(nCounted == V.size());
+  REQUIRE(stats.histogram.front() > 0);
+  REQUIRE(stats.histogram.back() > 0);
+}
+
+TEST_CASE("Volume: cached statistics follow changes of the voxels") {
+  Volume V({8ul, 8ul, 8ul});
+  V = 1.0f;
+  REQUIRE(V.get_maxVal() == 1.0f);
+  REQUIRE(V.GetStats(4).histogram[0] == V.size());
+
+  V(1, 2, 3) = 5.0f;
+  REQUIRE(V.get_maxVal() == 5.0f);
+  V[7] = -7.0f;
+  REQUIRE(V.get_minVal() == -7.0f);
+  REQUIRE(V.get_absMaxVal() == 7.0f);
+
+  float* voxels = V.data();
+  const float maxBefore = V.get_maxVal();
+  voxels[0] = 9.0f;
+  REQUIRE(V.get_maxVal() == maxBefore);
+  V.InvalidateStats();
+  REQUIRE(V.get_maxVal() == 9.0f);
+
+  const Volume copy = V;
+  REQUIRE(copy.get_maxVal() == 9.0f);
+}
+
+TEST_CASE("Volume: writes from several threads invalidate the caches") {
+  Volume V({16ul, 16ul, 64ul});
+  V = 1.0f;
+  REQUIRE(V.get_maxVal() == 1.0f);
+  REQUIRE(V.get_mip(2)[0] == 1.0f);
+
+  // every thread counts its own modifications through the non const access
+  const uint64_t versionBefore = V.get_version();
+  ParallelFor(V.get_dim(2), 4, [&](const std::size_t z) {
+    for (std::size_t y = 0; y < V.get_dim(1); y++)
+      for (std::size_t x = 0; x < V.get_dim(0); x++)
+        V(x, y, z) = static_cast<float>(z);
+  });
+  REQUIRE(V.get_version() >= versionBefore + V.size());
+  REQUIRE(V.get_maxVal() == 63.0f);
+  REQUIRE(V.get_mip(2)[0] == 63.0f);
+}
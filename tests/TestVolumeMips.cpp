@@ -0,0 +1,119 @@
+#include "Memory/Volume.h"
+#include "catch2/catch_test_macros.hpp"
+#include <catch2/catch_all.hpp>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace opensaft;
+
+namespace {
+
+/// dimensions which are no multiples of the block size
+Volume CreateVolume() {
+  Volume vol({45ul, 70ul, 37ul});
+  for (std::size_t idx = 0; idx < vol.size(); idx++)
+    vol[idx] = std::sin(static_cast<float>(idx) * 0.37f) *
+               static_cast<float>(idx % 101);
+  return vol;
+}
+
+/// projection along iDim of the voxels [start, stop) by brute force
+std::vector<float> ReferenceMip(const Volume& vol, const uint8_t iDim,
+                                const Size3& start, const Size3& stop) {
+  const Size3 dims = vol.get_dims();
+  const std::size_t rowLength = (iDim == 0) ? dims[1] : dims[0];
+  const std::size_t nRows = (iDim == 2) ? dims[1] : dims[2];
+  std::vector<float> image(rowLength * nRows,
+                           std::numeric_limits<float>::lowest());
+  for (std::size_t z = 0; z < dims[2]; z++)
+    for (std::size_t y = 0; y < dims[1]; y++)
+      for (std::size_t x = 0; x < dims[0]; x++) {
+        const Size3 pos{x, y, z};
+        if (pos[iDim] < start[iDim] || pos[iDim] >= stop[iDim])
+          continue;
+        const std::size_t pixel = (iDim == 0)   ? y + dims[1] * z
+                                  : (iDim == 1) ? x + dims[0] * z
+                                                : x + dims[0] * y;
+        image[pixel] = std::max(image[pixel], vol(x, y, z));
+      }
+  return image;
+}
+
+bool Equals(std::span<const float> image, std::span<const float> ref) {
+  return std::equal(image.begin(), image.end(), ref.begin(), ref.end());
+}
+
+} // namespace
+
+TEST_CASE("Volume: projections along all axes") {
+  Volume vol = CreateVolume();
+  const Size3 dims = vol.get_dims();
+  REQUIRE(Equals(vol.get_mipX(), ReferenceMip(vol, 0, {}, dims)));
+  REQUIRE(Equals(vol.get_mipY(), ReferenceMip(vol, 1, {}, dims)));
+  REQUIRE(Equals(vol.get_mipZ(), ReferenceMip(vol, 2, {}, dims)));
+}
+
+TEST_CASE("Volume: cropped projections") {
+  Volume vol = CreateVolume();
+  // within one block, across blocks, ending at the volume border
+  const auto [start, stop] = GENERATE(
+      std::pair<Size3, Size3>{{3ul, 5ul, 7ul}, {20ul, 30ul, 9ul}},
+      std::pair<Size3, Size3>{{31ul, 2ul, 0ul}, {45ul, 68ul, 37ul}},
+      std::pair<Size3, Size3>{{0ul, 32ul, 1ul}, {33ul, 64ul, 36ul}});
+  vol.set_cropRange(start, stop);
+  REQUIRE(vol.get_updatedCropRange());
+  for (uint8_t iDim = 0; iDim < 3; iDim++)
+    REQUIRE(Equals(vol.get_croppedMip(iDim),
+                   ReferenceMip(vol, iDim, start, stop)));
+  REQUIRE(!vol.get_updatedCropRange());
+
+  // range of the cropped projection along z within the crop window
+  const auto ref = ReferenceMip(vol, 2, start, stop);
+  float maxVal = std::numeric_limits<float>::lowest();
+  float minVal = std::numeric_limits<float>::max();
+  for (std::size_t y = start[1]; y < stop[1]; y++)
+    for (std::size_t x = start[0]; x < stop[0]; x++) {
+      maxVal = std::max(maxVal, ref[x + vol.get_dim(0) * y]);
+      minVal = std::min(minVal, ref[x + vol.get_dim(0) * y]);
+    }
+  REQUIRE(vol.get_maxValCrop() == maxVal);
+  REQUIRE(vol.get_minValCrop() == minVal);
+}
+
+TEST_CASE("VolumeMips: scanning the crop range matches the block projection") {
+  const Volume vol = CreateVolume();
+  VolumeMips mips(vol.get_dims());
+  const Size3 start{4ul, 31ul, 2ul};
+  const Size3 stop{40ul, 66ul, 35ul};
+  mips.SetCropRange(start, stop);
+  std::vector<float> image;
+  for (uint8_t iDim = 0; iDim < 3; iDim++) {
+    mips.ScanCropped(vol, iDim, image);
+    REQUIRE(Equals(image, ReferenceMip(vol, iDim, start, stop)));
+  }
+}
+
+TEST_CASE("Volume: projections follow crop and voxel changes") {
+  Volume vol = CreateVolume();
+  vol.set_res({1.0f, 1.0f, 1.0f});
+  vol.calcCroppedMips();
+
+  // positions of voxel edges, the center lies at 0
+  vol.set_cropRange(2, -10.0f, 4.5f);
+  REQUIRE(vol.get_cropStart()[2] == 8);
+  REQUIRE(vol.get_cropStop()[2] == 23);
+  const Size3 start = vol.get_cropStart();
+  const Size3 stop = vol.get_cropStop();
+  REQUIRE(Equals(vol.get_croppedMipZ(), ReferenceMip(vol, 2, start, stop)));
+  REQUIRE(Equals(vol.get_croppedMipX(), vol.get_mipX()));
+
+  vol(4, 5, 10) = 1e6f;
+  REQUIRE(vol.get_updatedCropRange());
+  REQUIRE(vol.get_mipZ()[4 + vol.get_dim(0) * 5] == 1e6f);
+  REQUIRE(vol.get_croppedMipY()[4 + vol.get_dim(0) * 10] == 1e6f);
+  REQUIRE(vol.get_maxValCrop() == 1e6f);
+
+  REQUIRE_THROWS_AS(vol.set_cropRange({0ul, 0ul, 5ul}, {1ul, 1ul, 5ul}),
+                    std::invalid_argument);
+}